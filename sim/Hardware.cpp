@@ -0,0 +1,58 @@
+#include <chrono>
+#include <cstdlib>
+#include <hal/nrf_gpio.h>
+#include <hal/nrf_rtc.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "nrf.h"
+#include "Simulator.h"
+
+// Emulation of the few nRF52 peripherals accessed directly by the application code.
+
+namespace {
+  constexpr uint32_t nbPins = 32;
+  uint8_t gpioLevels[nbPins];
+  NRF_RTC_Type rtc1;
+  DWT_Type dwt;
+  CoreDebug_Type coreDebug;
+#ifndef HEAP_TRACKING
+  size_t freeHeapSize = configTOTAL_HEAP_SIZE;
+#endif
+}
+
+NRF_RTC_Type* const NRF_RTC1 = &rtc1;
+DWT_Type* const DWT = &dwt;
+CoreDebug_Type* const CoreDebug = &coreDebug;
+
+SimulatorCycleCounter::operator uint32_t() const {
+  auto elapsed = std::chrono::steady_clock::now().time_since_epoch();
+  return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() * 64 / 1000);
+}
+
+#ifdef HEAP_TRACKING
+// xPortGetFreeHeapSize() is implemented by heap_4_infinitime.c
+void Pinetime::Simulator::SetFreeHeapSize(size_t /*size*/) {
+}
+#else
+// heap_3.c allocates with malloc() and does not know the free heap: the value is set by the script
+extern "C" size_t xPortGetFreeHeapSize(void) {
+  return freeHeapSize;
+}
+
+void Pinetime::Simulator::SetFreeHeapSize(size_t size) {
+  freeHeapSize = size;
+}
+#endif
+
+uint8_t& Pinetime::Simulator::GpioLevel(uint32_t pin) {
+  return gpioLevels[pin % nbPins];
+}
+
+uint32_t nrf_rtc_counter_get(NRF_RTC_Type const* /*rtc*/) {
+  // RTC1 is a 24 bits counter running at 1024Hz, the same rate as the FreeRTOS tick
+  return xTaskGetTickCount() & 0x00ffffffu;
+}
+
+extern "C" void NVIC_SystemReset(void) {
+  std::exit(0);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "drivers/Cst816s.h"
+
+namespace Pinetime {
+  namespace Simulator {
+    // Counters maintained by the stub St7789 driver. "bytes" is what would have been sent over SPI
+    // for pixel data, commands excluded.
+    struct LcdStatistics {
+      uint32_t drawBufferCalls = 0;
+      uint32_t pixels = 0;
+      uint32_t bytes = 0;
+      uint32_t verticalScrollCommands = 0;
+      uint32_t sleepCount = 0;
+      uint32_t wakeupCount = 0;
+    };
+
+    const LcdStatistics& GetLcdStatistics();
+    void ResetLcdStatistics();
+
+    // Line of the frame memory currently displayed on the first visible line of the panel.
+    uint16_t GetVerticalScrollStart();
+
+    // RGB565 content of the panel as seen by the user (vertical scrolling applied), 240x240 pixels.
+    void ReadVisibleFrame(uint16_t* pixels);
+
+    // Writes the visible frame as a binary PPM image.
+    bool DumpVisibleFrame(const char* path);
+
+    // Write of the frame memory by St7789::DrawBuffer(), modeled as an 8MHz SPI transfer (times in DWT->CYCCNT cycles).
+    // firstLine is the line of the panel (vertical scrolling applied) where the write starts.
+    struct TearingRecord {
+      uint32_t start = 0;
+      uint32_t cycles = 0;
+      uint32_t phase = 0;
+      uint16_t firstLine = 0;
+      uint16_t nbLines = 0;
+      bool torn = false;
+    };
+
+    struct TearingStatistics {
+      uint32_t writes = 0;
+      uint32_t tornWrites = 0;
+    };
+
+    const TearingStatistics& GetTearingStatistics();
+    void ResetTearingStatistics();
+
+    // Writes the last writes of the frame memory as a binary PPM timeline: one column per line period, one row per line
+    // of the panel, the position of the scan in white, the clean writes in green and the torn ones in red.
+    bool DumpTearingTrace(const char* path);
+
+    // Queues a sample that will be returned by the next Cst816S::GetTouchInfo() call and raises the
+    // touch interrupt.
+    void PushTouch(const Drivers::Cst816S::TouchInfos& info);
+
+    // Simulates a click on the side button.
+    void PushButton();
+
+    // Values returned by Bma421::Process() (and each sample of Bma421::ProcessFifo()) and Hrs3300::ReadSample().
+    void SetMotion(int16_t x, int16_t y, int16_t z, uint32_t steps);
+    void SetHeartRateSample(uint32_t hrs, uint32_t als);
+
+    // Value returned by xPortGetFreeHeapSize() (configTOTAL_HEAP_SIZE by default). Ignored with HEAP_TRACKING, the heap
+    // of the firmware reporting its actual free size.
+    void SetFreeHeapSize(size_t size);
+
+    // Equivalent of the Cst816sIrq GPIOTE event, implemented in main.cpp.
+    void OnTouchInterrupt();
+  }
+}
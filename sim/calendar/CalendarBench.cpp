@@ -0,0 +1,200 @@
+// Comparison of the incremental calendar of DateTime::UpdateTime() with a full conversion of the time, run on the host.
+//
+// Replays the systick deltas seen by UpdateTime() (100ms steps while awake, up to a minute while sleeping and a few
+// 24 bits systick wrap-arounds) over the given periods, advances the broken-down time with BrokenDownTime::Advance()
+// and compares it after each step with the conversion done before, gmtime() being what newlib's localtime() returns
+// on the watch (TZ is not set). The companion app follows the DST rules of a European time zone: at each DST change,
+// it sets the new local time, which converts the time again as DateTime::SetCurrentTime() does. The changes reported
+// by Advance() are checked against the minute, hour and day of the time.
+//
+//   pinetime-calendar-bench [<seed>]
+//
+// The durations are measured on the host and are only useful to compare both paths with each other.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include "components/datetime/BrokenDownTime.h"
+
+using Pinetime::Controllers::BrokenDownTime;
+
+namespace {
+  struct Period {
+    const char* name;
+    int year;
+    int month;
+    int day;
+    int days;
+  };
+
+  // 2024 is a leap year, 2100 is not
+  constexpr Period periods[] = {
+    {"2023-12-30 + 370 days (leap day, DST, new year)", 2023, 12, 30, 370},
+    {"2100-02-20 + 20 days (no leap day)", 2100, 2, 20, 20},
+  };
+
+  // Systick of the RTC: 24 bits at 1024Hz
+  constexpr uint32_t systickMask = 0xffffff;
+
+  uint32_t randomState = 1;
+
+  uint32_t NextRandom() {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+  }
+
+  // Ticks elapsed between two calls of UpdateTime()
+  uint32_t NextTicks() {
+    const uint32_t draw = NextRandom() % 1000;
+    if (draw < 700) {
+      return 102;
+    }
+    if (draw < 998) {
+      return 1 + NextRandom() % (60 * 1024);
+    }
+    return 1 + NextRandom() % systickMask;
+  }
+
+  // UTC offset of Central European Time, in seconds: the rules are those of the zone set in main()
+  long UtcOffset(std::time_t utc) {
+    std::tm local;
+    localtime_r(&utc, &local);
+    return local.tm_gmtoff;
+  }
+
+  bool SameFields(const std::tm& a, const std::tm& b) {
+    return a.tm_sec == b.tm_sec && a.tm_min == b.tm_min && a.tm_hour == b.tm_hour && a.tm_mday == b.tm_mday &&
+           a.tm_mon == b.tm_mon && a.tm_year == b.tm_year && a.tm_wday == b.tm_wday && a.tm_yday == b.tm_yday;
+  }
+
+  uint8_t ExpectedChanges(std::time_t before, std::time_t after) {
+    if (before == after) {
+      return BrokenDownTime::None;
+    }
+    uint8_t changes = BrokenDownTime::Second;
+    if (before / 60 != after / 60) {
+      changes |= BrokenDownTime::Minute;
+    }
+    if (before / 3600 != after / 3600) {
+      changes |= BrokenDownTime::Hour;
+    }
+    if (before / 86400 != after / 86400) {
+      changes |= BrokenDownTime::Day;
+    }
+    return changes;
+  }
+
+  struct Result {
+    unsigned long updates = 0;
+    unsigned long conversions = 0;
+    unsigned long fieldErrors = 0;
+    unsigned long changeErrors = 0;
+    double incrementalNs = 0;
+    double fullNs = 0;
+  };
+
+  void Run(const Period& period, Result& result) {
+    std::tm start {};
+    start.tm_year = period.year - 1900;
+    start.tm_mon = period.month - 1;
+    start.tm_mday = period.day;
+    std::time_t utc = timegm(&start);
+    const std::time_t end = utc + static_cast<std::time_t>(period.days) * 86400;
+
+    // State of DateTime: the local time (currentDateTime), its broken-down time and the systick counters
+    long offset = UtcOffset(utc);
+    std::time_t local = utc + offset;
+    std::tm localTime;
+    gmtime_r(&local, &localTime);
+    result.conversions++;
+    uint32_t systick = NextRandom() & systickMask;
+    uint32_t previousSystick = systick;
+
+    while (utc < end) {
+      systick = (systick + NextTicks()) & systickMask;
+      const uint32_t delta = (systick - previousSystick) & systickMask;
+      const uint32_t seconds = delta / 1024;
+      previousSystick = (systick - delta % 1024) & systickMask;
+      utc += seconds;
+
+      const std::time_t before = local;
+      local += seconds;
+
+      auto t0 = std::chrono::steady_clock::now();
+      const uint8_t changes = BrokenDownTime::Advance(localTime, seconds);
+      auto t1 = std::chrono::steady_clock::now();
+      std::tm reference;
+      gmtime_r(&local, &reference);
+      auto t2 = std::chrono::steady_clock::now();
+      result.incrementalNs += std::chrono::duration<double, std::nano>(t1 - t0).count();
+      result.fullNs += std::chrono::duration<double, std::nano>(t2 - t1).count();
+      result.updates++;
+
+      if (!SameFields(localTime, reference)) {
+        if (result.fieldErrors++ < 10) {
+          char expected[32];
+          char actual[32];
+          std::strftime(expected, sizeof(expected), "%F %T", &reference);
+          std::strftime(actual, sizeof(actual), "%F %T", &localTime);
+          std::printf("  mismatch after +%us: %s (wday %d yday %d) instead of %s (wday %d yday %d)\n",
+                      seconds,
+                      actual,
+                      localTime.tm_wday,
+                      localTime.tm_yday,
+                      expected,
+                      reference.tm_wday,
+                      reference.tm_yday);
+        }
+        localTime = reference;
+      }
+      if (changes != ExpectedChanges(before, local)) {
+        result.changeErrors++;
+      }
+
+      // DST change: the companion app sets the new local time (SetCurrentTime())
+      const long newOffset = UtcOffset(utc);
+      if (newOffset != offset) {
+        offset = newOffset;
+        local = utc + offset;
+        gmtime_r(&local, &localTime);
+        result.conversions++;
+        char text[32];
+        std::strftime(text, sizeof(text), "%F %T", &localTime);
+        std::printf("  DST change, local time set to %s\n", text);
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1) {
+    randomState = static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 0));
+    if (randomState == 0) {
+      randomState = 1;
+    }
+  }
+  setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+  tzset();
+
+  bool allOk = true;
+  for (const Period& period : periods) {
+    std::printf("%s\n", period.name);
+    Result result;
+    Run(period, result);
+    std::printf("  %lu updates, %lu full conversions, %lu field mismatches, %lu change flag mismatches\n",
+                result.updates,
+                result.conversions,
+                result.fieldErrors,
+                result.changeErrors);
+    std::printf("# incremental %.1f ns/update, full conversion %.1f ns/update\n",
+                result.incrementalNs / result.updates,
+                result.fullNs / result.updates);
+    allOk = allOk && result.fieldErrors == 0 && result.changeErrors == 0;
+  }
+  return allOk ? 0 : 1;
+}
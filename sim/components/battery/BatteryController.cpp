@@ -0,0 +1,31 @@
+#include "components/battery/BatteryController.h"
+
+using namespace Pinetime::Controllers;
+
+// The battery is simulated as a fully charged one, unplugged.
+
+Battery* Battery::instance = nullptr;
+
+Battery::Battery() {
+  instance = this;
+}
+
+void Battery::ReadPowerState() {
+  isCharging = false;
+  isPowerPresent = false;
+  isFull = false;
+}
+
+void Battery::MeasureVoltage() {
+  ReadPowerState();
+  voltage = 4100;
+  percentRemaining = 100;
+  firstMeasurement = false;
+  if (systemTask != nullptr) {
+    systemTask->PushMessage(System::Messages::BatteryPercentageUpdated);
+  }
+}
+
+void Battery::Register(Pinetime::System::SystemTask* systemTask) {
+  this->systemTask = systemTask;
+}
@@ -0,0 +1,23 @@
+#include "components/firmwarevalidator/FirmwareValidator.h"
+
+#include <nrf.h>
+
+using namespace Pinetime::Controllers;
+
+// The valid bit lives in the internal flash of the nRF52 on the watch; the simulator keeps it in RAM.
+
+namespace {
+  uint32_t imageOk = 1;
+}
+
+bool FirmwareValidator::IsValidated() const {
+  return imageOk == validBitValue;
+}
+
+void FirmwareValidator::Validate() {
+  imageOk = validBitValue;
+}
+
+void FirmwareValidator::Reset() {
+  NVIC_SystemReset();
+}
@@ -0,0 +1,68 @@
+#include "drivers/Bma421.h"
+#include <algorithm>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "Simulator.h"
+
+using namespace Pinetime::Drivers;
+
+namespace {
+  Bma421::Values values {0, 0, 0, -1024};
+  // The FIFO holds the samples taken since it was last drained, all equal to the values set by the script
+  TickType_t lastFifoRead = 0;
+}
+
+Bma421::Bma421(TwiMaster& twiMaster, uint8_t twiAddress) : twiMaster {twiMaster}, deviceAddress {twiAddress} {
+}
+
+void Bma421::Init() {
+  isOk = isResetOk;
+  deviceType = DeviceTypes::BMA421;
+}
+
+void Bma421::Reset() {
+}
+
+void Bma421::Read(uint8_t /*registerAddress*/, uint8_t* /*buffer*/, size_t /*size*/) {
+}
+
+void Bma421::Write(uint8_t /*registerAddress*/, const uint8_t* /*data*/, size_t /*size*/) {
+}
+
+Bma421::Values Bma421::Process() {
+  return values;
+}
+
+bool Bma421::ProcessFifo(FifoValues& fifoValues) {
+  const TickType_t now = xTaskGetTickCount();
+  const size_t nbSamples = (now - lastFifoRead) / pdMS_TO_TICKS(fifoSamplePeriodMs);
+  lastFifoRead = now;
+
+  fifoValues.steps = values.steps;
+  // Like the driver, a FIFO that overflowed only returns the current acceleration
+  fifoValues.nbSamples = (nbSamples > maxFifoSamples) ? 1 : std::max<size_t>(nbSamples, 1);
+  for (size_t i = 0; i < fifoValues.nbSamples; i++) {
+    fifoValues.samples[i] = {values.x, values.y, values.z};
+  }
+  return true;
+}
+
+bool Bma421::IsOk() const {
+  return isOk;
+}
+
+void Bma421::ResetStepCounter() {
+  values.steps = 0;
+}
+
+void Bma421::SoftReset() {
+  isResetOk = true;
+}
+
+Bma421::DeviceTypes Bma421::DeviceType() const {
+  return deviceType;
+}
+
+void Pinetime::Simulator::SetMotion(int16_t x, int16_t y, int16_t z, uint32_t steps) {
+  values = {steps, x, y, z};
+}
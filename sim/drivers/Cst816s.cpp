@@ -0,0 +1,57 @@
+#include "drivers/Cst816s.h"
+#include "Simulator.h"
+
+using namespace Pinetime::Drivers;
+
+// Touch samples are queued by the simulator script (Simulator::PushTouch) and returned one by one,
+// each of them raising the touch interrupt like the CST816S does when a gesture or a touch is detected.
+
+namespace {
+  constexpr size_t queueSize = 16;
+  Cst816S::TouchInfos queue[queueSize];
+  size_t readIndex = 0;
+  size_t writeIndex = 0;
+  Cst816S::TouchInfos lastInfo;
+}
+
+Cst816S::Cst816S(TwiMaster& twiMaster, uint8_t twiAddress) : twiMaster {twiMaster}, twiAddress {twiAddress} {
+}
+
+bool Cst816S::Init() {
+  return CheckDeviceIds();
+}
+
+Cst816S::TouchInfos Cst816S::GetTouchInfo() {
+  if (readIndex != writeIndex) {
+    lastInfo = queue[readIndex];
+    readIndex = (readIndex + 1) % queueSize;
+  } else {
+    lastInfo.gesture = Gestures::None;
+    lastInfo.touching = false;
+  }
+  lastInfo.isValid = true;
+  return lastInfo;
+}
+
+void Cst816S::Sleep() {
+}
+
+void Cst816S::Wakeup() {
+}
+
+bool Cst816S::CheckDeviceIds() {
+  chipId = 0xb4;
+  vendorId = 0;
+  fwVersion = 1;
+  return true;
+}
+
+void Pinetime::Simulator::PushTouch(const Drivers::Cst816S::TouchInfos& info) {
+  size_t next = (writeIndex + 1) % queueSize;
+  if (next == readIndex) {
+    return;
+  }
+  queue[writeIndex] = info;
+  writeIndex = next;
+  OnTouchInterrupt();
+}
@@ -0,0 +1,44 @@
+#include "drivers/Hrs3300.h"
+#include "Simulator.h"
+
+using namespace Pinetime::Drivers;
+
+namespace {
+  uint32_t hrsValue = 0;
+  uint32_t alsValue = 0;
+}
+
+Hrs3300::Hrs3300(TwiMaster& twiMaster, uint8_t twiAddress) : twiMaster {twiMaster}, twiAddress {twiAddress} {
+}
+
+void Hrs3300::Init() {
+}
+
+void Hrs3300::Enable() {
+}
+
+void Hrs3300::Disable() {
+}
+
+bool Hrs3300::ReadSample(Sample& sample) {
+  sample = {hrsValue, alsValue};
+  return true;
+}
+
+void Hrs3300::SetGain(uint8_t /*gain*/) {
+}
+
+void Hrs3300::SetDrive(uint8_t /*drive*/) {
+}
+
+void Hrs3300::WriteRegister(uint8_t /*reg*/, uint8_t /*data*/) {
+}
+
+uint8_t Hrs3300::ReadRegister(uint8_t /*reg*/) {
+  return 0;
+}
+
+void Pinetime::Simulator::SetHeartRateSample(uint32_t hrs, uint32_t als) {
+  hrsValue = hrs;
+  alsValue = als;
+}
@@ -0,0 +1,14 @@
+#include "drivers/InternalFlash.h"
+#include <libraries/log/nrf_log.h>
+
+using namespace Pinetime::Drivers;
+
+// The internal flash holds the firmware and the bootloader data, none of which exist in the simulator.
+
+void InternalFlash::ErasePage(uint32_t address) {
+  NRF_LOG_INFO("[InternalFlash] Erase page 0x%08x", address);
+}
+
+void InternalFlash::WriteWord(uint32_t address, uint32_t value) {
+  NRF_LOG_INFO("[InternalFlash] Write 0x%08x at 0x%08x", value, address);
+}
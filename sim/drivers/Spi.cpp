@@ -0,0 +1,36 @@
+#include "drivers/Spi.h"
+
+using namespace Pinetime::Drivers;
+
+Spi::Spi(SpiMaster& spiMaster, uint8_t pinCsn, SpiMaster::Clients client) : spiMaster {spiMaster}, pinCsn {pinCsn}, client {client} {
+}
+
+bool Spi::Write(const uint8_t* data, size_t size) {
+  return spiMaster.Write(pinCsn, data, size, client);
+}
+
+bool Spi::Read(uint8_t* cmd, size_t cmdSize, uint8_t* data, size_t dataSize) {
+  return spiMaster.Read(pinCsn, cmd, cmdSize, data, dataSize, client);
+}
+
+bool Spi::Read(uint8_t* cmd, size_t cmdSize, uint8_t* data, size_t dataSize, SpiMaster::Clients client) {
+  return spiMaster.Read(pinCsn, cmd, cmdSize, data, dataSize, client);
+}
+
+void Spi::Sleep() {
+}
+
+bool Spi::Init() {
+  return true;
+}
+
+bool Spi::WriteCmdAndBuffer(const uint8_t* cmd, size_t cmdSize, const uint8_t* data, size_t dataSize) {
+  return spiMaster.WriteCmdAndBuffer(pinCsn, cmd, cmdSize, data, dataSize, client);
+}
+
+bool Spi::WriteCmdAndBuffer(const uint8_t* cmd, size_t cmdSize, const uint8_t* data, size_t dataSize, SpiMaster::Clients client) {
+  return spiMaster.WriteCmdAndBuffer(pinCsn, cmd, cmdSize, data, dataSize, client);
+}
+
+void Spi::Wakeup() {
+}
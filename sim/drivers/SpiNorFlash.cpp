@@ -0,0 +1,106 @@
+#include "drivers/SpiNorFlash.h"
+#include <cstring>
+#include <vector>
+#include "drivers/Spi.h"
+
+using namespace Pinetime::Drivers;
+
+// 4MB of RAM emulating the external SPI NOR flash: programming can only clear bits and erasing a
+// 4KB sector sets them back to 1, so littlefs sees the same constraints as on the watch.
+
+namespace {
+  constexpr size_t flashSize = 4 * 1024 * 1024;
+  constexpr size_t sectorSize = 4096;
+
+  std::vector<uint8_t>& Memory() {
+    static std::vector<uint8_t> memory(flashSize, 0xff);
+    return memory;
+  }
+}
+
+SpiNorFlash::SpiNorFlash(Spi& spi) : spi {spi} {
+}
+
+void SpiNorFlash::Init() {
+  device_id = ReadIdentificaion();
+}
+
+void SpiNorFlash::Uninit() {
+}
+
+void SpiNorFlash::Sleep() {
+}
+
+void SpiNorFlash::Wakeup() {
+}
+
+SpiNorFlash::Identification SpiNorFlash::ReadIdentificaion() {
+  Identification identification;
+  identification.manufacturer = 0x0b; // XTX Technology, as on the PineTime
+  identification.type = 0x40;
+  identification.density = 0x16;
+  return identification;
+}
+
+uint8_t SpiNorFlash::ReadStatusRegister() {
+  return 0;
+}
+
+bool SpiNorFlash::WriteInProgress() {
+  return false;
+}
+
+bool SpiNorFlash::WriteEnabled() {
+  return true;
+}
+
+uint8_t SpiNorFlash::ReadConfigurationRegister() {
+  return 0;
+}
+
+void SpiNorFlash::Read(uint32_t address, uint8_t* buffer, size_t size) {
+  if (address + size > flashSize) {
+    return;
+  }
+  std::memcpy(buffer, &Memory()[address], size);
+}
+
+void SpiNorFlash::WriteEnable() {
+}
+
+void SpiNorFlash::SectorErase(uint32_t sectorAddress) {
+  sectorAddress &= ~(sectorSize - 1);
+  if (sectorAddress + sectorSize > flashSize) {
+    return;
+  }
+  std::memset(&Memory()[sectorAddress], 0xff, sectorSize);
+}
+
+uint8_t SpiNorFlash::ReadSecurityRegister() {
+  return 0;
+}
+
+bool SpiNorFlash::ProgramFailed() {
+  return false;
+}
+
+bool SpiNorFlash::EraseFailed() {
+  return false;
+}
+
+void SpiNorFlash::Write(uint32_t address, const uint8_t* buffer, size_t size) {
+  if (address + size > flashSize) {
+    return;
+  }
+  auto& memory = Memory();
+  for (size_t i = 0; i < size; i++) {
+    memory[address + i] &= buffer[i];
+  }
+}
+
+void SpiNorFlash::StartPageProgram(uint32_t address, const uint8_t* buffer, size_t size) {
+  Write(address, buffer, size);
+}
+
+void SpiNorFlash::WaitWriteCompleted() {
+}
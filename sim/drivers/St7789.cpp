@@ -0,0 +1,248 @@
+#include "drivers/St7789.h"
+#include "drivers/St7789Scanline.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <nrf.h>
+#include <libraries/log/nrf_log.h>
+#include "drivers/Spi.h"
+#include "Simulator.h"
+
+using namespace Pinetime::Drivers;
+
+// Frame memory of the panel (240x320, RGB565 as sent over SPI, i.e. big endian since LV_COLOR_16_SWAP is set).
+// DrawBuffer() writes into it at the window given by the caller, and the visible frame is read through the
+// vertical scrolling start address, like the ST7789 does.
+//
+// The writes are also checked against the scan of the panel (St7789Scanline): each DrawBuffer() is modeled as an SPI
+// transfer at 8MHz, started when the call is made or when the previous modeled transfer ends, and recorded in a trace
+// with whether the scan passed over the written lines during the transfer.
+
+namespace {
+  constexpr uint16_t frameWidth = 240;
+  constexpr uint16_t frameHeight = 320;
+  constexpr uint16_t visibleHeight = 240;
+
+  uint8_t frameMemory[frameWidth * frameHeight * 2];
+  uint16_t scrollTopFixedLines = 0;
+  uint16_t scrollLines = frameHeight;
+  uint16_t scrollStart = 0;
+  Pinetime::Simulator::LcdStatistics statistics;
+  // The host clock keeps running, so the modeled scan stays in step with the writes
+  Pinetime::Drivers::St7789Scanline scanline;
+
+  constexpr size_t nbTearingRecords = 512;
+  Pinetime::Simulator::TearingRecord tearingRecords[nbTearingRecords];
+  size_t tearingRecordCount = 0;
+  Pinetime::Simulator::TearingStatistics tearingStatistics;
+  uint32_t transferEnd = 0;
+  uint32_t scanReference = 0;
+
+  void RecordTearing(uint16_t y, uint16_t height, size_t size, uint32_t phase) {
+    const uint32_t now = DWT->CYCCNT;
+    const uint32_t writeCycles = Pinetime::Drivers::St7789Scanline::WriteCycles(size);
+    // The previous transfer may still be in progress on the bus
+    const uint32_t start = (static_cast<int32_t>(transferEnd - now) > 0) ? transferEnd : now;
+    transferEnd = start + writeCycles;
+
+    Pinetime::Simulator::TearingRecord record;
+    record.start = start;
+    record.cycles = writeCycles;
+    record.firstLine = (y + frameHeight - scrollStart) % frameHeight;
+    record.nbLines = height;
+    record.phase = (phase + (start - now)) % Pinetime::Drivers::St7789Scanline::frameCycles;
+    record.torn = Pinetime::Drivers::St7789Scanline::IsTorn(record.phase, record.firstLine, height, writeCycles);
+    scanReference = start - record.phase;
+    tearingRecords[tearingRecordCount % nbTearingRecords] = record;
+    tearingRecordCount++;
+
+    tearingStatistics.writes++;
+    if (record.torn) {
+      tearingStatistics.tornWrites++;
+    }
+  }
+}
+
+St7789::St7789(Spi& spi, uint8_t pinDataCommand, uint8_t pinReset) : spi {spi}, pinDataCommand {pinDataCommand}, pinReset {pinReset} {
+}
+
+void St7789::Init() {
+  std::memset(frameMemory, 0, sizeof(frameMemory));
+  scrollTopFixedLines = 0;
+  scrollLines = frameHeight;
+  scrollStart = 0;
+  scanline.Synchronize(DWT->CYCCNT);
+}
+
+void St7789::Uninit() {
+}
+
+void St7789::DrawPixel(uint16_t x, uint16_t y, uint32_t color) {
+  if (x >= Width || y >= Height) {
+    return;
+  }
+  auto* pixel = &frameMemory[(y * frameWidth + x) * 2];
+  pixel[0] = static_cast<uint8_t>(color >> 8u);
+  pixel[1] = static_cast<uint8_t>(color & 0xffu);
+  statistics.pixels++;
+  statistics.bytes += 2;
+}
+
+void St7789::VerticalScrollDefinition(uint16_t topFixedLines, uint16_t scrollLines, uint16_t /*bottomFixedLines*/) {
+  scrollTopFixedLines = topFixedLines;
+  ::scrollLines = scrollLines;
+}
+
+void St7789::VerticalScrollStartAddress(uint16_t line) {
+  verticalScrollingStartAddress = line;
+  scrollStart = line;
+  statistics.verticalScrollCommands++;
+}
+
+void St7789::DrawBuffer(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t* data, size_t size) {
+  statistics.drawBufferCalls++;
+  statistics.pixels += width * height;
+  statistics.bytes += size;
+
+  // Same addressing as the RAMWR command: the data fills the window line by line and the
+  // excess (if any) is dropped.
+  size_t offset = 0;
+  for (uint16_t line = y; line < y + height && line < frameHeight; line++) {
+    for (uint16_t column = x; column < x + width && offset + 1 < size; column++) {
+      if (column < frameWidth) {
+        auto* pixel = &frameMemory[(line * frameWidth + column) * 2];
+        pixel[0] = data[offset];
+        pixel[1] = data[offset + 1];
+      }
+      offset += 2;
+    }
+  }
+  RecordTearing(y, height, size, scanline.Phase(DWT->CYCCNT));
+  spi.Write(data, size);
+}
+
+void St7789::Sleep() {
+  statistics.sleepCount++;
+  NRF_LOG_INFO("[LCD] Sleep");
+}
+
+void St7789::Wakeup() {
+  statistics.wakeupCount++;
+  VerticalScrollStartAddress(verticalScrollingStartAddress);
+  scanline.Synchronize(DWT->CYCCNT);
+  NRF_LOG_INFO("[LCD] Wakeup");
+}
+
+const Pinetime::Simulator::LcdStatistics& Pinetime::Simulator::GetLcdStatistics() {
+  return statistics;
+}
+
+void Pinetime::Simulator::ResetLcdStatistics() {
+  statistics = {};
+}
+
+uint16_t Pinetime::Simulator::GetVerticalScrollStart() {
+  return scrollStart;
+}
+
+void Pinetime::Simulator::ReadVisibleFrame(uint16_t* pixels) {
+  for (uint16_t visibleLine = 0; visibleLine < visibleHeight; visibleLine++) {
+    uint16_t line = visibleLine;
+    if (visibleLine >= scrollTopFixedLines && visibleLine < scrollTopFixedLines + scrollLines) {
+      line = scrollTopFixedLines + ((visibleLine - scrollTopFixedLines + scrollStart - scrollTopFixedLines) % scrollLines);
+    }
+    for (uint16_t column = 0; column < frameWidth; column++) {
+      const auto* pixel = &frameMemory[(line * frameWidth + column) * 2];
+      pixels[visibleLine * frameWidth + column] = static_cast<uint16_t>((pixel[0] << 8u) | pixel[1]);
+    }
+  }
+}
+
+bool Pinetime::Simulator::DumpVisibleFrame(const char* path) {
+  static uint16_t pixels[frameWidth * visibleHeight];
+  ReadVisibleFrame(pixels);
+
+  FILE* file = std::fopen(path, "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  std::fprintf(file, "P6\n%d %d\n255\n", frameWidth, visibleHeight);
+  for (auto pixel : pixels) {
+    uint8_t rgb[3] = {static_cast<uint8_t>((pixel >> 11u) << 3u),
+                      static_cast<uint8_t>(((pixel >> 5u) & 0x3fu) << 2u),
+                      static_cast<uint8_t>((pixel & 0x1fu) << 3u)};
+    std::fwrite(rgb, 1, sizeof(rgb), file);
+  }
+  std::fclose(file);
+  return true;
+}
+
+const Pinetime::Simulator::TearingStatistics& Pinetime::Simulator::GetTearingStatistics() {
+  return tearingStatistics;
+}
+
+void Pinetime::Simulator::ResetTearingStatistics() {
+  tearingStatistics = {};
+}
+
+bool Pinetime::Simulator::DumpTearingTrace(const char* path) {
+  using Pinetime::Drivers::St7789Scanline;
+  static constexpr uint32_t maxColumns = 4096;
+  static uint8_t image[maxColumns * frameHeight * 3];
+
+  const size_t count = std::min(tearingRecordCount, nbTearingRecords);
+  const size_t first = tearingRecordCount - count;
+  uint32_t nbColumns = 1;
+  uint32_t end = DWT->CYCCNT;
+  if (count > 0) {
+    // One column per line period, ending with the newest write
+    const TearingRecord& oldest = tearingRecords[first % nbTearingRecords];
+    const TearingRecord& newest = tearingRecords[(tearingRecordCount - 1) % nbTearingRecords];
+    end = newest.start + newest.cycles;
+    nbColumns = std::min(maxColumns, (end - oldest.start) / St7789Scanline::lineCycles + 1);
+  }
+  const uint32_t origin = end - (nbColumns - 1) * St7789Scanline::lineCycles;
+
+  std::memset(image, 0, nbColumns * frameHeight * 3);
+  auto plot = [&](uint32_t column, uint16_t line, uint8_t r, uint8_t g, uint8_t b) {
+    auto* pixel = &image[((line % frameHeight) * nbColumns + column) * 3];
+    pixel[0] = r;
+    pixel[1] = g;
+    pixel[2] = b;
+  };
+
+  for (size_t i = first; i < tearingRecordCount; i++) {
+    const TearingRecord& record = tearingRecords[i % nbTearingRecords];
+    if (static_cast<int32_t>(record.start - origin) < 0) {
+      continue;
+    }
+    const uint32_t startColumn = (record.start - origin) / St7789Scanline::lineCycles;
+    const uint32_t endColumn = std::min(nbColumns - 1, (record.start + record.cycles - origin) / St7789Scanline::lineCycles);
+    for (uint32_t column = startColumn; column <= endColumn; column++) {
+      for (uint16_t line = 0; line < record.nbLines; line++) {
+        if (record.torn) {
+          plot(column, record.firstLine + line, 0xff, 0x00, 0x00);
+        } else {
+          plot(column, record.firstLine + line, 0x00, 0xc0, 0x00);
+        }
+      }
+    }
+  }
+
+  // Position of the scan, from the reference of the newest write
+  for (uint32_t column = 0; column < nbColumns; column++) {
+    const int32_t sinceReference = static_cast<int32_t>(origin + column * St7789Scanline::lineCycles - scanReference);
+    const int32_t frameCycles = St7789Scanline::frameCycles;
+    const uint32_t phase = ((sinceReference % frameCycles) + frameCycles) % frameCycles;
+    plot(column, phase / St7789Scanline::lineCycles, 0xff, 0xff, 0xff);
+  }
+
+  FILE* file = std::fopen(path, "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  std::fprintf(file, "P6\n%u %d\n255\n", static_cast<unsigned>(nbColumns), frameHeight);
+  std::fwrite(image, 1, nbColumns * frameHeight * 3, file);
+  std::fclose(file);
+  return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Drivers {
+    // Timing model of the refresh of the ST7789 panel.
+    //
+    // The controller scans its 320 display lines (the lines of the frame memory shifted by the vertical scrolling
+    // start address) top to bottom, at the frame rate set by FRCTRL2 (60Hz after reset). A line written while the scan
+    // passes over it is displayed half old, half new: the area tears. The position of the scan is extrapolated from
+    // a reference instant. Durations are in cycles of the 64MHz CPU clock.
+    //
+    // The model is only used by the simulator to measure the torn writes: the TE output of the controller is not
+    // connected on the PineTime, and the firmware has no clock that both keeps running while the core sleeps and
+    // follows the oscillator of the panel, whose frequency is only specified within a few percent. Without a tearing
+    // effect signal to synchronize on, an extrapolated scan drifts away from the real one within a few seconds.
+    class St7789Scanline {
+    public:
+      static constexpr uint32_t cyclesPerSecond = 64000000;
+      static constexpr uint32_t frameRate = 60;
+      static constexpr uint16_t nbLines = 320;
+      static constexpr uint32_t frameCycles = cyclesPerSecond / frameRate;
+      static constexpr uint32_t lineCycles = frameCycles / nbLines;
+      // SPI clock at 8MHz
+      static constexpr uint32_t cyclesPerByte = 64;
+
+      // The scan is at the beginning of the first line at the given time
+      void Synchronize(uint32_t cycles) {
+        reference = cycles;
+      }
+
+      // Cycles elapsed since the beginning of the frame being scanned at the given time
+      uint32_t Phase(uint32_t cycles) {
+        uint32_t elapsed = cycles - reference;
+        if (elapsed >= frameCycles) {
+          // Keeps the reference close, so that the difference does not wrap around
+          elapsed %= frameCycles;
+          reference = cycles - elapsed;
+        }
+        return elapsed;
+      }
+
+      static constexpr uint32_t WriteCycles(size_t bytes) {
+        return bytes * cyclesPerByte;
+      }
+
+      // True if a write started at the given phase is displayed torn
+      static constexpr bool IsTorn(uint32_t phase, uint16_t firstLine, uint16_t nbWrittenLines, uint32_t writeCycles) {
+        const uint32_t sinceStart = SinceStart(phase, firstLine);
+        return sinceStart < nbWrittenLines * lineCycles || frameCycles - sinceStart < writeCycles;
+      }
+
+    private:
+      uint32_t reference = 0;
+
+      // Cycles elapsed since the scan entered firstLine
+      static constexpr uint32_t SinceStart(uint32_t phase, uint16_t firstLine) {
+        return (phase + frameCycles - (firstLine % nbLines) * lineCycles) % frameCycles;
+      }
+    };
+  }
+}
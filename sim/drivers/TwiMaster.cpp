@@ -0,0 +1,65 @@
+#include "drivers/TwiMaster.h"
+#include <cstring>
+#include <semphr.h>
+
+using namespace Pinetime::Drivers;
+
+// The TWI devices (Cst816S, Bma421, Hrs3300) are emulated at the driver level. The transactions are not queued, a
+// mutex serializes them so that the callers still wait for each other.
+
+namespace {
+  NRF_TWIM_Type twim1;
+  SemaphoreHandle_t mutex = nullptr;
+}
+
+NRF_TWIM_Type* const NRF_TWIM1 = &twim1;
+
+TwiMaster::TwiMaster(NRF_TWIM_Type* module, uint32_t frequency, uint8_t pinSda, uint8_t pinScl)
+  : module {module}, frequency {frequency}, pinSda {pinSda}, pinScl {pinScl} {
+}
+
+void TwiMaster::ConfigurePins() const {
+}
+
+void TwiMaster::Init() {
+  if (mutex == nullptr) {
+    mutex = xSemaphoreCreateBinary();
+    xSemaphoreGive(mutex);
+  }
+  twiBaseAddress = module;
+}
+
+TwiMaster::ErrorCodes TwiMaster::Read(uint8_t /*deviceAddress*/, uint8_t /*registerAddress*/, uint8_t* data, size_t size) {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  std::memset(data, 0, size);
+  xSemaphoreGive(mutex);
+  return ErrorCodes::NoError;
+}
+
+TwiMaster::ErrorCodes TwiMaster::Read(const ReadRequest* requests, size_t count) {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  for (size_t i = 0; i < count; i++) {
+    std::memset(requests[i].buffer, 0, requests[i].size);
+  }
+  xSemaphoreGive(mutex);
+  return ErrorCodes::NoError;
+}
+
+TwiMaster::ErrorCodes TwiMaster::Write(uint8_t /*deviceAddress*/, uint8_t /*registerAddress*/, const uint8_t* /*data*/, size_t size) {
+  ASSERT(size <= maxDataSize);
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  xSemaphoreGive(mutex);
+  return ErrorCodes::NoError;
+}
+
+void TwiMaster::OnStoppedEvent() {
+}
+
+void TwiMaster::OnErrorEvent() {
+}
+
+void TwiMaster::Sleep() {
+}
+
+void TwiMaster::Wakeup() {
+}
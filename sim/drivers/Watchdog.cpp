@@ -0,0 +1,38 @@
+#include "drivers/Watchdog.h"
+
+using namespace Pinetime::Drivers;
+
+void Watchdog::Setup(uint8_t /*timeoutSeconds*/, SleepBehaviour /*sleepBehaviour*/, HaltBehaviour /*haltBehaviour*/) {
+  resetReason = ResetReason::HardReset;
+}
+
+void Watchdog::Start() {
+}
+
+void Watchdog::Reload() {
+}
+
+const char* Pinetime::Drivers::ResetReasonToString(Watchdog::ResetReason reason) {
+  switch (reason) {
+    case Watchdog::ResetReason::ResetPin:
+      return "Reset pin";
+    case Watchdog::ResetReason::Watchdog:
+      return "Watchdog";
+    case Watchdog::ResetReason::DebugInterface:
+      return "Debug interface";
+    case Watchdog::ResetReason::LpComp:
+      return "LPCOMP";
+    case Watchdog::ResetReason::SystemOff:
+      return "System OFF";
+    case Watchdog::ResetReason::CpuLockup:
+      return "CPU Lock-up";
+    case Watchdog::ResetReason::SoftReset:
+      return "Soft reset";
+    case Watchdog::ResetReason::NFC:
+      return "NFC";
+    case Watchdog::ResetReason::HardReset:
+      return "Hard reset";
+    default:
+      return "Unknown";
+  }
+}
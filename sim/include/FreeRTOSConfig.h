@@ -0,0 +1,88 @@
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/*-----------------------------------------------------------
+ * FreeRTOS configuration of the host simulator (POSIX port).
+ *
+ * The values that change the behaviour of the application (tick rate, priorities, timers) are the same as
+ * in src/FreeRTOSConfig.h so that delays and timeouts expressed in ticks behave like on the watch.
+ * The heap is backed by malloc() (heap_3.c) and is therefore not limited by configTOTAL_HEAP_SIZE, unless
+ * HEAP_TRACKING selects the heap of the firmware (heap_4_infinitime.c).
+ *----------------------------------------------------------*/
+
+#define configUSE_PREEMPTION                    1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#define configUSE_TICKLESS_IDLE                 0
+#define configCPU_CLOCK_HZ                      (64000000UL)
+#define configTICK_RATE_HZ                      1024
+#define configMAX_PRIORITIES                    (3)
+#define configMINIMAL_STACK_SIZE                (PTHREAD_STACK_MIN)
+#ifdef HEAP_TRACKING
+  /* The stacks of the POSIX port (PTHREAD_STACK_MIN words for the idle and timer tasks) are allocated from the heap:
+   * 512KB are added to the 40KB of the firmware. */
+  #define configTOTAL_HEAP_SIZE (1024 * 40 + 1024 * 512)
+#else
+  #define configTOTAL_HEAP_SIZE (1024 * 40)
+#endif
+#define configMAX_TASK_NAME_LEN                 (4)
+#define configUSE_16_BIT_TICKS                  0
+#define configIDLE_SHOULD_YIELD                 1
+#define configUSE_MUTEXES                       1
+#define configUSE_RECURSIVE_MUTEXES             1
+#define configUSE_COUNTING_SEMAPHORES           1
+#define configUSE_ALTERNATIVE_API               0
+#define configQUEUE_REGISTRY_SIZE               2
+#define configUSE_QUEUE_SETS                    0
+#define configUSE_TIME_SLICING                  0
+#define configUSE_NEWLIB_REENTRANT              0
+#define configENABLE_BACKWARD_COMPATIBILITY     1
+
+/* Hook function related definitions. */
+#define configUSE_IDLE_HOOK             0
+#define configUSE_TICK_HOOK             0
+#define configCHECK_FOR_STACK_OVERFLOW  0
+#define configUSE_MALLOC_FAILED_HOOK    0
+
+/* Run time and task stats gathering related definitions. */
+#define configGENERATE_RUN_TIME_STATS        0
+#define configUSE_TRACE_FACILITY             1
+#define configUSE_STATS_FORMATTING_FUNCTIONS 0
+
+/* Co-routine definitions. */
+#define configUSE_CO_ROUTINES           0
+#define configMAX_CO_ROUTINE_PRIORITIES (2)
+
+/* Software timer definitions. */
+#define configUSE_TIMERS             1
+#define configTIMER_TASK_PRIORITY    (1)
+#define configTIMER_QUEUE_LENGTH     32
+#define configTIMER_TASK_STACK_DEPTH (PTHREAD_STACK_MIN)
+
+/* Optional functions - most linkers will remove unused functions anyway. */
+#define INCLUDE_vTaskPrioritySet               1
+#define INCLUDE_uxTaskPriorityGet              1
+#define INCLUDE_vTaskDelete                    1
+#define INCLUDE_vTaskSuspend                   1
+#define INCLUDE_xResumeFromISR                 1
+#define INCLUDE_vTaskDelayUntil                1
+#define INCLUDE_vTaskDelay                     1
+#define INCLUDE_xTaskGetSchedulerState         1
+#define INCLUDE_xTaskGetCurrentTaskHandle      1
+#define INCLUDE_uxTaskGetStackHighWaterMark    1
+#define INCLUDE_xTaskGetIdleTaskHandle         1
+#define INCLUDE_xTimerGetTimerDaemonTaskHandle 1
+#define INCLUDE_pcTaskGetTaskName              1
+#define INCLUDE_eTaskGetState                  1
+#define INCLUDE_xEventGroupSetBitFromISR       1
+#define INCLUDE_xTimerPendFunctionCall         1
+
+#if !(defined(__ASSEMBLY__) || defined(__ASSEMBLER__))
+  #include <limits.h>
+  #include "nrf.h"
+  #include "nrf_assert.h"
+  #include "app_error.h"
+#endif
+
+#define configASSERT(x) ASSERT(x)
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,8 @@
+#pragma once
+#include <assert.h>
+
+#define NRF_SUCCESS      (0)
+#define NRF_ERROR_NO_MEM (4)
+
+#define APP_ERROR_HANDLER(errorCode) assert((errorCode) == NRF_SUCCESS)
+#define APP_ERROR_CHECK(errorCode)   assert((errorCode) == NRF_SUCCESS)
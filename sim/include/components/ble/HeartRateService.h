@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+// Simulator replacement for src/components/ble/HeartRateService.h.
+//
+// HeartRateController notifies this service for each new heart rate; without NimBLE there is nobody to
+// notify, so the notifications are dropped.
+
+namespace Pinetime {
+  namespace Controllers {
+    class HeartRateService {
+    public:
+      void OnNewHeartRateValue(uint8_t /*heartRateValue*/) {
+      }
+    };
+  }
+}
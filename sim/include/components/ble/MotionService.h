@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+// Simulator replacement for src/components/ble/MotionService.h.
+//
+// MotionController notifies this service for each new step count and acceleration; without NimBLE there is
+// nobody to notify, so the notifications are dropped.
+
+namespace Pinetime {
+  namespace Controllers {
+    class MotionService {
+    public:
+      void OnNewStepCountValue(uint32_t /*stepCount*/) {
+      }
+
+      void OnNewMotionValues(int16_t /*x*/, int16_t /*y*/, int16_t /*z*/) {
+      }
+    };
+  }
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+
+// Types referenced by BatteryController.h. The simulator provides its own BatteryController.cpp, so
+// the SAADC driver itself is not emulated.
+
+typedef int16_t nrf_saadc_value_t;
+
+typedef enum {
+  NRF_SAADC_INPUT_DISABLED,
+  NRF_SAADC_INPUT_AIN0,
+  NRF_SAADC_INPUT_AIN1,
+  NRF_SAADC_INPUT_AIN2,
+  NRF_SAADC_INPUT_AIN3,
+  NRF_SAADC_INPUT_AIN4,
+  NRF_SAADC_INPUT_AIN5,
+  NRF_SAADC_INPUT_AIN6,
+  NRF_SAADC_INPUT_AIN7,
+  NRF_SAADC_INPUT_VDD
+} nrf_saadc_input_t;
+
+typedef struct {
+  int type;
+} nrfx_saadc_evt_t;
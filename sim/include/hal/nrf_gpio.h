@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+
+// GPIOs are simulated as a plain array of pin levels so that drivers toggling backlight, motor or
+// reset pins keep working; nothing is connected to them.
+
+typedef enum { NRF_GPIO_PIN_NOPULL, NRF_GPIO_PIN_PULLDOWN, NRF_GPIO_PIN_PULLUP = 3 } nrf_gpio_pin_pull_t;
+
+namespace Pinetime {
+  namespace Simulator {
+    uint8_t& GpioLevel(uint32_t pin);
+  }
+}
+
+inline void nrf_gpio_cfg_output(uint32_t /*pin*/) {
+}
+
+inline void nrf_gpio_cfg_input(uint32_t /*pin*/, nrf_gpio_pin_pull_t /*pull*/) {
+}
+
+inline void nrf_gpio_pin_set(uint32_t pin) {
+  Pinetime::Simulator::GpioLevel(pin) = 1;
+}
+
+inline void nrf_gpio_pin_clear(uint32_t pin) {
+  Pinetime::Simulator::GpioLevel(pin) = 0;
+}
+
+inline uint32_t nrf_gpio_pin_read(uint32_t pin) {
+  return Pinetime::Simulator::GpioLevel(pin);
+}
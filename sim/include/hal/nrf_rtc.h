@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+
+// The RTC is emulated from the FreeRTOS tick count: the firmware runs the kernel tick from RTC1 at 1024Hz
+// and the simulator keeps configTICK_RATE_HZ at the same value, so both counters advance together.
+
+typedef struct {
+  uint32_t unused;
+} NRF_RTC_Type;
+
+extern NRF_RTC_Type* const NRF_RTC1;
+#define portNRF_RTC_REG NRF_RTC1
+
+uint32_t nrf_rtc_counter_get(NRF_RTC_Type const* rtc);
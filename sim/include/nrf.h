@@ -0,0 +1,47 @@
+#pragma once
+#include <stdint.h>
+
+// Host replacement for the nRF52 MDK header. Peripheral register blocks only exist as opaque types so that
+// driver headers declaring pointers to them still compile; the simulator drivers never dereference them.
+// This header is included by FreeRTOSConfig.h and must therefore stay valid C.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  uint32_t unused;
+} NRF_SPIM_Type;
+
+typedef struct {
+  uint32_t unused;
+} NRF_TWIM_Type;
+
+extern NRF_TWIM_Type* const NRF_TWIM1;
+
+void NVIC_SystemReset(void);
+
+#ifdef __cplusplus
+}
+
+// Debug registers used to measure durations. Reading DWT->CYCCNT returns the time elapsed on the host,
+// expressed in cycles of the 64MHz CPU clock of the nRF52.
+struct SimulatorCycleCounter {
+  operator uint32_t() const;
+};
+
+struct DWT_Type {
+  uint32_t CTRL;
+  SimulatorCycleCounter CYCCNT;
+};
+
+struct CoreDebug_Type {
+  uint32_t DEMCR;
+};
+
+extern DWT_Type* const DWT;
+extern CoreDebug_Type* const CoreDebug;
+
+  #define DWT_CTRL_CYCCNTENA_Msk     (1UL)
+  #define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+#endif
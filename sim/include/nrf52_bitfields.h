@@ -0,0 +1,6 @@
+#pragma once
+
+// Subset of the nRF52 register bitfields used by the driver headers compiled into the simulator.
+
+#define WDT_CONFIG_HALT_Pos  (3UL)
+#define WDT_CONFIG_SLEEP_Pos (0UL)
@@ -0,0 +1,4 @@
+#pragma once
+#include <assert.h>
+
+#define ASSERT(expr) assert(expr)
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdio>
+
+// NRF_LOG_* are routed to stdout. The format strings are the ones written for the nRF logger, which
+// are printf compatible.
+
+#define NRF_LOG_INFO(...)                                                                                                                  \
+  do {                                                                                                                                     \
+    std::printf("[INFO] " __VA_ARGS__);                                                                                                    \
+    std::printf("\n");                                                                                                                     \
+  } while (0)
+#define NRF_LOG_WARNING(...)                                                                                                               \
+  do {                                                                                                                                     \
+    std::printf("[WARN] " __VA_ARGS__);                                                                                                    \
+    std::printf("\n");                                                                                                                     \
+  } while (0)
+#define NRF_LOG_ERROR(...)                                                                                                                 \
+  do {                                                                                                                                     \
+    std::printf("[ERROR] " __VA_ARGS__);                                                                                                   \
+    std::printf("\n");                                                                                                                     \
+  } while (0)
+#define NRF_LOG_DEBUG(...)
+#define NRF_LOG_FLUSH()
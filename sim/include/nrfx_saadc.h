@@ -0,0 +1,2 @@
+#pragma once
+#include "drivers/include/nrfx_saadc.h"
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <chrono>
+
+#include <FreeRTOS.h>
+#include <queue.h>
+#include <task.h>
+#include <timers.h>
+#include <heartratetask/HeartRateTask.h>
+#include <components/settings/Settings.h>
+#include <drivers/Bma421.h>
+#include <drivers/PinMap.h>
+#include <components/motion/MotionController.h>
+
+#include "components/ble/NotificationManager.h"
+#include "components/alarm/AlarmController.h"
+#include "components/fs/FS.h"
+#include "touchhandler/TouchHandler.h"
+#include "displayapp/DisplayApp.h"
+#include "drivers/Watchdog.h"
+#include "systemtask/Messages.h"
+
+// Simulator replacement for src/systemtask/SystemTask.h.
+//
+// It keeps the public interface used by DisplayApp and the controllers (PushMessage, IsSleeping,
+// IsSleepDisabled, OnTouchEvent) but drops NimBLE, the button handler and the GPIOTE plumbing. The
+// message loop mirrors the parts of the firmware SystemTask that drive the display: touch and button
+// events, sleep/wake transitions, and the periodic jobs (motion, time update) the loop blocks until.
+
+extern std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> NoInit_BackUpTime;
+
+namespace Pinetime {
+  namespace Drivers {
+    class Cst816S;
+    class SpiMaster;
+    class SpiNorFlash;
+    class St7789;
+    class TwiMaster;
+    class Hrs3300;
+  }
+
+  namespace Controllers {
+    class Battery;
+    class Ble;
+    class TouchHandler;
+  }
+
+  namespace System {
+    class SystemTask {
+    public:
+      enum class SystemTaskState { Sleeping, Running, GoingToSleep, WakingUp };
+      SystemTask(Drivers::SpiMaster& spi,
+                 Pinetime::Drivers::SpiNorFlash& spiNorFlash,
+                 Drivers::TwiMaster& twiMaster,
+                 Drivers::Cst816S& touchPanel,
+                 Controllers::Battery& batteryController,
+                 Controllers::Ble& bleController,
+                 Controllers::DateTime& dateTimeController,
+                 Controllers::AlarmController& alarmController,
+                 Drivers::Watchdog& watchdog,
+                 Pinetime::Controllers::NotificationManager& notificationManager,
+                 Pinetime::Drivers::Hrs3300& heartRateSensor,
+                 Pinetime::Controllers::MotionController& motionController,
+                 Pinetime::Drivers::Bma421& motionSensor,
+                 Controllers::Settings& settingsController,
+                 Pinetime::Controllers::HeartRateController& heartRateController,
+                 Pinetime::Applications::DisplayApp& displayApp,
+                 Pinetime::Applications::HeartRateTask& heartRateApp,
+                 Pinetime::Controllers::FS& fs,
+                 Pinetime::Controllers::TouchHandler& touchHandler);
+
+      void Start();
+      void PushMessage(Messages msg);
+
+      void OnTouchEvent();
+
+      bool IsSleepDisabled() {
+        return doNotGoToSleep;
+      }
+
+      bool IsSleeping() const {
+        return state == SystemTaskState::Sleeping || state == SystemTaskState::WakingUp;
+      }
+
+    private:
+      TaskHandle_t taskHandle;
+
+      Pinetime::Drivers::SpiMaster& spi;
+      Pinetime::Drivers::SpiNorFlash& spiNorFlash;
+      Pinetime::Drivers::TwiMaster& twiMaster;
+      Pinetime::Drivers::Cst816S& touchPanel;
+      Pinetime::Controllers::Battery& batteryController;
+
+      Pinetime::Controllers::Ble& bleController;
+      Pinetime::Controllers::DateTime& dateTimeController;
+      Pinetime::Controllers::AlarmController& alarmController;
+      QueueHandle_t systemTasksMsgQueue;
+      Pinetime::Drivers::Watchdog& watchdog;
+      Pinetime::Controllers::NotificationManager& notificationManager;
+      Pinetime::Drivers::Hrs3300& heartRateSensor;
+      Pinetime::Drivers::Bma421& motionSensor;
+      Pinetime::Controllers::Settings& settingsController;
+      Pinetime::Controllers::HeartRateController& heartRateController;
+      Pinetime::Controllers::MotionController& motionController;
+
+      Pinetime::Applications::DisplayApp& displayApp;
+      Pinetime::Applications::HeartRateTask& heartRateApp;
+      Pinetime::Controllers::FS& fs;
+      Pinetime::Controllers::TouchHandler& touchHandler;
+
+      static void Process(void* instance);
+      void Work();
+      bool doNotGoToSleep = false;
+      SystemTaskState state = SystemTaskState::Running;
+
+      void GoToRunning();
+      void UpdateMotion();
+      bool IsMotionPollingNeeded() const;
+      TickType_t TicksToNextJob() const;
+      void RunPeriodicJobs();
+      TickType_t lastMotionUpdate = 0;
+      // The motion sensor buffers its samples in its FIFO, they are drained in a single read once per second
+      static constexpr TickType_t motionPollingPeriod = pdMS_TO_TICKS(1000);
+      // The watchdog is configured with a 7s timeout
+      static constexpr TickType_t watchdogReloadPeriod = pdMS_TO_TICKS(5 * 1000);
+    };
+  }
+}
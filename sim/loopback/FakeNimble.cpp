@@ -0,0 +1,153 @@
+#include "FakeNimble.h"
+#include <cstring>
+
+uint16_t FakeNimble::attMtu = 247;
+std::deque<os_mbuf*> FakeNimble::notifications;
+std::vector<uint16_t> FakeNimble::characteristicHandles;
+int FakeNimble::allocatedMbufs = 0;
+std::vector<ble_npl_callout*> FakeNimble::callouts;
+
+os_mbuf* FakeNimble::Write(const void* data, uint16_t length) {
+  return ble_hs_mbuf_from_flat(data, length);
+}
+
+void FakeNimble::ExpireCallouts() {
+  for (ble_npl_callout* co : callouts) {
+    if (co->active) {
+      co->active = false;
+      co->ev.fn(&co->ev);
+    }
+  }
+}
+
+int ble_gatts_count_cfg(const struct ble_gatt_svc_def* /*defs*/) {
+  return 0;
+}
+
+int ble_gatts_add_svcs(const struct ble_gatt_svc_def* svcs) {
+  // Assign the handles in declaration order, as NimBLE does: service, then declaration and value of each characteristic
+  static uint16_t handle = 0;
+  for (const ble_gatt_svc_def* svc = svcs; svc->type != BLE_GATT_SVC_TYPE_END; svc++) {
+    handle++;
+    for (const ble_gatt_chr_def* chr = svc->characteristics; chr != nullptr && chr->uuid != nullptr; chr++) {
+      handle += 2;
+      if (chr->val_handle != nullptr) {
+        *chr->val_handle = handle;
+      }
+      FakeNimble::characteristicHandles.push_back(handle);
+    }
+  }
+  return 0;
+}
+
+int ble_gattc_notify_custom(uint16_t /*conn_handle*/, uint16_t /*att_handle*/, struct os_mbuf* om) {
+  if (om == nullptr) {
+    return -1;
+  }
+  FakeNimble::notifications.push_back(om);
+  return 0;
+}
+
+uint16_t ble_att_mtu(uint16_t /*conn_handle*/) {
+  return FakeNimble::attMtu;
+}
+
+struct os_mbuf* ble_hs_mbuf_att_pkt(void) {
+  auto* om = new os_mbuf;
+  om->om_data = om->buffer + os_mbuf::leadingSpace;
+  om->om_len = 0;
+  FakeNimble::allocatedMbufs++;
+  return om;
+}
+
+struct os_mbuf* ble_hs_mbuf_from_flat(const void* buf, uint16_t len) {
+  os_mbuf* om = ble_hs_mbuf_att_pkt();
+  if (os_mbuf_append(om, buf, len) != 0) {
+    os_mbuf_free_chain(om);
+    return nullptr;
+  }
+  return om;
+}
+
+int os_mbuf_append(struct os_mbuf* om, const void* data, uint16_t len) {
+  void* destination = os_mbuf_extend(om, len);
+  if (destination == nullptr) {
+    return -1;
+  }
+  std::memcpy(destination, data, len);
+  return 0;
+}
+
+void* os_mbuf_extend(struct os_mbuf* om, uint16_t len) {
+  if (om->om_data + om->om_len + len > om->buffer + os_mbuf::bufferSize) {
+    return nullptr;
+  }
+  void* extension = om->om_data + om->om_len;
+  om->om_len += len;
+  return extension;
+}
+
+void os_mbuf_adj(struct os_mbuf* om, int req_len) {
+  // Positive: trim from the head, negative: trim from the tail
+  if (req_len >= 0) {
+    const uint16_t length = (req_len < om->om_len) ? req_len : om->om_len;
+    om->om_data += length;
+    om->om_len -= length;
+  } else {
+    const uint16_t length = (-req_len < om->om_len) ? -req_len : om->om_len;
+    om->om_len -= length;
+  }
+}
+
+int os_mbuf_copyinto(struct os_mbuf* om, int off, const void* src, int len) {
+  if (off + len > om->om_len) {
+    return -1;
+  }
+  std::memcpy(om->om_data + off, src, len);
+  return 0;
+}
+
+int os_mbuf_copydata(const struct os_mbuf* om, int off, int len, void* dst) {
+  if (off + len > om->om_len) {
+    return -1;
+  }
+  std::memcpy(dst, om->om_data + off, len);
+  return 0;
+}
+
+int os_mbuf_free_chain(struct os_mbuf* om) {
+  if (om != nullptr) {
+    delete om;
+    FakeNimble::allocatedMbufs--;
+  }
+  return 0;
+}
+
+struct ble_npl_eventq* nimble_port_get_dflt_eventq(void) {
+  static ble_npl_eventq eventq;
+  return &eventq;
+}
+
+void* ble_npl_event_get_arg(struct ble_npl_event* ev) {
+  return ev->arg;
+}
+
+void ble_npl_callout_init(struct ble_npl_callout* co, struct ble_npl_eventq* /*evq*/, ble_npl_event_fn* ev_cb, void* ev_arg) {
+  co->ev.fn = ev_cb;
+  co->ev.arg = ev_arg;
+  co->active = false;
+  FakeNimble::callouts.push_back(co);
+}
+
+int ble_npl_callout_reset(struct ble_npl_callout* co, ble_npl_time_t /*ticks*/) {
+  co->active = true;
+  return 0;
+}
+
+void ble_npl_callout_stop(struct ble_npl_callout* co) {
+  co->active = false;
+}
+
+ble_npl_time_t ble_npl_time_ms_to_ticks32(uint32_t ms) {
+  return ms;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <nimble/nimble_port.h>
+
+// State of the fake NimBLE host (include/host/ble_gap.h) shared with the loopback.
+namespace FakeNimble {
+  // ATT MTU returned by ble_att_mtu()
+  extern uint16_t attMtu;
+  // Notifications sent by the services, the receiver frees them with os_mbuf_free_chain()
+  extern std::deque<os_mbuf*> notifications;
+  // Value handles of the characteristics registered with ble_gatts_add_svcs(), in declaration order
+  extern std::vector<uint16_t> characteristicHandles;
+  // Number of mbufs allocated and not freed yet
+  extern int allocatedMbufs;
+  // Callouts initialized with ble_npl_callout_init()
+  extern std::vector<ble_npl_callout*> callouts;
+
+  // Returns a mbuf with the content of a write to a characteristic
+  os_mbuf* Write(const void* data, uint16_t length);
+  // Runs the callouts armed with ble_npl_callout_reset(), as if their delay had elapsed
+  void ExpireCallouts();
+}
@@ -0,0 +1,305 @@
+// Loopback of the BLE FS write path: a phone model sends a file to Controllers::FSService through a fake NimBLE
+// host (include/host/ble_gap.h), with every window size supported by the watch, and the file is read back from
+// littlefs (on the RAM flash of the simulator) to check its content:
+//
+//   pinetime-fs-loopback [--size <bytes>] [--mtu <bytes>] [--interval <ms>] [--packets-per-event <count>]
+//
+// The radio is modelled with connection events: the phone sends up to --packets-per-event write packets per
+// connection event, a response notified by the watch during an event reaches the phone in the next event and the
+// phone sends the following packets in the event after that. The throughput printed for each window is the size of
+// the file divided by the duration of these connection events; the time spent in FSService (measured on the host,
+// so much shorter than on the watch) and the number of pages programmed in the flash are printed next to it.
+// A last transfer is abandoned by the phone after its header, the transfer timeout of the watch must end it.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "FakeNimble.h"
+#include "components/ble/FSService.h"
+#include "components/fs/FS.h"
+#include "drivers/PinMap.h"
+#include "drivers/Spi.h"
+#include "drivers/SpiMaster.h"
+#include "drivers/SpiNorFlash.h"
+#include "systemtask/SystemTask.h"
+
+namespace {
+  // Packets of the BLE FS protocol, as described in doc/BLEFS.md
+  enum class Commands : uint8_t { Write = 0x20, WritePacing = 0x21, WriteData = 0x22 };
+
+  struct __attribute__((packed)) WriteHeader {
+    Commands command;
+    uint8_t window;
+    uint16_t pathLength;
+    uint32_t offset;
+    uint64_t modificationTime;
+    uint32_t totalSize;
+  };
+
+  struct __attribute__((packed)) WriteResponse {
+    Commands command;
+    int8_t status;
+    uint16_t credits;
+    uint32_t offset;
+    uint64_t modificationTime;
+    uint32_t freeSpace;
+  };
+
+  struct __attribute__((packed)) WriteData {
+    Commands command;
+    uint8_t status;
+    uint16_t padding;
+    uint32_t offset;
+    uint32_t dataSize;
+  };
+
+  constexpr char filePath[] = "/loopback.bin";
+  constexpr uint16_t connectionHandle = 1;
+
+  struct Options {
+    uint32_t fileSize = 64 * 1024;
+    double connectionIntervalMs = 30;
+    unsigned packetsPerEvent = 4;
+  };
+
+  struct Result {
+    bool ok = false;
+    uint32_t packets = 0;
+    uint32_t responses = 0;
+    uint32_t connectionEvents = 0;
+    double processingMs = 0;
+    uint32_t pagesProgrammed = 0;
+  };
+
+  Pinetime::Drivers::SpiMaster spi {Pinetime::Drivers::SpiMaster::SpiModule::SPI0,
+                                    {Pinetime::Drivers::SpiMaster::BitOrder::Msb_Lsb,
+                                     Pinetime::Drivers::SpiMaster::Modes::Mode3,
+                                     Pinetime::Drivers::SpiMaster::Frequencies::Freq8Mhz,
+                                     Pinetime::PinMap::SpiSck,
+                                     Pinetime::PinMap::SpiMosi,
+                                     Pinetime::PinMap::SpiMiso}};
+  Pinetime::Drivers::Spi flashSpi {spi, Pinetime::PinMap::SpiFlashCsn, Pinetime::Drivers::SpiMaster::Clients::FlashRead};
+  Pinetime::Drivers::SpiNorFlash spiNorFlash {flashSpi};
+  Pinetime::Controllers::FS fs {spiNorFlash};
+  Pinetime::System::SystemTask systemTask;
+  Pinetime::Controllers::FSService fsService {systemTask, fs};
+  uint16_t transferHandle = 0;
+
+  Options options;
+  bool allOk = true;
+
+  uint8_t FileContent(uint32_t offset) {
+    return static_cast<uint8_t>((offset * 31) ^ (offset >> 8));
+  }
+
+  // Writes a packet on the transfer characteristic and returns the time spent in FSService
+  double SendPacket(const std::vector<uint8_t>& packet) {
+    os_mbuf* om = FakeNimble::Write(packet.data(), packet.size());
+    ble_gatt_access_ctxt context {BLE_GATT_ACCESS_OP_WRITE_CHR, om};
+    auto start = std::chrono::steady_clock::now();
+    fsService.OnFSServiceRequested(connectionHandle, transferHandle, &context);
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    os_mbuf_free_chain(om);
+    return elapsed;
+  }
+
+  bool CheckFile(uint32_t size) {
+    lfs_file_t file;
+    if (fs.FileOpen(&file, filePath, LFS_O_RDONLY) < 0) {
+      return false;
+    }
+    bool ok = true;
+    uint8_t buffer[256];
+    uint32_t offset = 0;
+    int res;
+    while ((res = fs.FileRead(&file, buffer, sizeof(buffer))) > 0) {
+      for (int i = 0; i < res; i++) {
+        if (buffer[i] != FileContent(offset + i)) {
+          ok = false;
+        }
+      }
+      offset += res;
+    }
+    fs.FileClose(&file);
+    return ok && res == 0 && offset == size;
+  }
+
+  Result SendFile(uint8_t window) {
+    Result result;
+    fs.FileDelete(filePath);
+    const uint32_t pagesProgrammedBefore = fs.GetCacheStatistics().writeBacks;
+    const uint32_t dataSize = FakeNimble::attMtu - 3 - sizeof(WriteData);
+
+    struct PendingResponse {
+      WriteResponse response;
+      uint32_t usableEvent;
+    };
+    std::vector<PendingResponse> pending;
+
+    uint32_t event = 0;
+    uint32_t sendOffset = 0;
+    uint32_t credits = 0;
+    bool headerSent = false;
+    bool complete = false;
+    while (!complete) {
+      // Responses received during the previous events
+      for (auto it = pending.begin(); it != pending.end();) {
+        if (it->usableEvent > event) {
+          ++it;
+          continue;
+        }
+        const WriteResponse& response = it->response;
+        if (response.command != Commands::WritePacing || response.status != 0x01) {
+          std::fprintf(stderr, "window %u: error %d at offset %u\n", window, response.status, response.offset);
+          return result;
+        }
+        credits = (response.credits == 0) ? 1 : response.credits;
+        sendOffset = response.offset;
+        complete = (response.freeSpace == 0);
+        it = pending.erase(it);
+      }
+      if (complete) {
+        break;
+      }
+
+      unsigned sent = 0;
+      if (!headerSent) {
+        std::vector<uint8_t> packet(sizeof(WriteHeader) + std::strlen(filePath));
+        WriteHeader header {Commands::Write, window, static_cast<uint16_t>(std::strlen(filePath)), 0, 0, options.fileSize};
+        std::memcpy(packet.data(), &header, sizeof(header));
+        std::memcpy(packet.data() + sizeof(header), filePath, std::strlen(filePath));
+        result.processingMs += SendPacket(packet);
+        headerSent = true;
+        sent++;
+      }
+      for (; sent < options.packetsPerEvent && credits > 0 && sendOffset < options.fileSize; sent++) {
+        const uint32_t size = std::min(dataSize, options.fileSize - sendOffset);
+        std::vector<uint8_t> packet(sizeof(WriteData) + size);
+        WriteData data {Commands::WriteData, 0x01, 0, sendOffset, size};
+        std::memcpy(packet.data(), &data, sizeof(data));
+        for (uint32_t i = 0; i < size; i++) {
+          packet[sizeof(data) + i] = FileContent(sendOffset + i);
+        }
+        result.processingMs += SendPacket(packet);
+        result.packets++;
+        sendOffset += size;
+        credits--;
+      }
+
+      while (!FakeNimble::notifications.empty()) {
+        os_mbuf* om = FakeNimble::notifications.front();
+        FakeNimble::notifications.pop_front();
+        PendingResponse response {};
+        os_mbuf_copydata(om, 0, sizeof(WriteResponse), &response.response);
+        response.usableEvent = event + 2;
+        pending.push_back(response);
+        os_mbuf_free_chain(om);
+        result.responses++;
+      }
+
+      event++;
+      if (sent == 0 && pending.empty()) {
+        std::fprintf(stderr, "window %u: transfer stalled at offset %u\n", window, sendOffset);
+        return result;
+      }
+    }
+
+    result.connectionEvents = event;
+    result.pagesProgrammed = fs.GetCacheStatistics().writeBacks - pagesProgrammedBefore;
+    result.ok = CheckFile(options.fileSize);
+    return result;
+  }
+
+  // Sends the header of a transfer and nothing else, then expires the transfer timeout of FSService
+  bool AbandonTransfer() {
+    std::vector<uint8_t> packet(sizeof(WriteHeader) + std::strlen(filePath));
+    WriteHeader header {Commands::Write, 1, static_cast<uint16_t>(std::strlen(filePath)), 0, 0, options.fileSize};
+    std::memcpy(packet.data(), &header, sizeof(header));
+    std::memcpy(packet.data() + sizeof(header), filePath, std::strlen(filePath));
+    SendPacket(packet);
+    while (!FakeNimble::notifications.empty()) {
+      os_mbuf_free_chain(FakeNimble::notifications.front());
+      FakeNimble::notifications.pop_front();
+    }
+    FakeNimble::ExpireCallouts();
+    return systemTask.startFileTransferCount == systemTask.stopFileTransferCount;
+  }
+
+  void LoopbackTask(void*) {
+    spiNorFlash.Init();
+    fs.Init();
+    fsService.Init();
+    // The transfer characteristic is the second one of the service
+    transferHandle = FakeNimble::characteristicHandles[1];
+
+    std::printf("# %u bytes, MTU %u, connection interval %.2fms, %u packets per event\n",
+                options.fileSize,
+                FakeNimble::attMtu,
+                options.connectionIntervalMs,
+                options.packetsPerEvent);
+    std::printf("# window packets responses     link      B/s  processing  pages\n");
+    for (uint8_t window : {1, 2, 4, 8, 16}) {
+      Result result = SendFile(window);
+      const double linkSeconds = result.connectionEvents * options.connectionIntervalMs / 1000;
+      std::printf("%8u %7u %9u %7.2fs %8.0f %9.3fms %6u %s\n",
+                  window,
+                  result.packets,
+                  result.responses,
+                  linkSeconds,
+                  (linkSeconds > 0) ? options.fileSize / linkSeconds : 0,
+                  result.processingMs,
+                  result.pagesProgrammed,
+                  result.ok ? "ok" : "FAILED");
+      allOk = allOk && result.ok;
+    }
+
+    const bool abandonedOk = AbandonTransfer();
+    std::printf("# abandoned transfer %s\n", abandonedOk ? "ok" : "FAILED");
+    allOk = allOk && abandonedOk;
+
+    if (systemTask.startFileTransferCount != systemTask.stopFileTransferCount || FakeNimble::allocatedMbufs != 0) {
+      std::printf("# unbalanced file transfer messages (%u/%u) or leaked mbufs (%d)\n",
+                  systemTask.startFileTransferCount,
+                  systemTask.stopFileTransferCount,
+                  FakeNimble::allocatedMbufs);
+      allOk = false;
+    }
+    std::exit(allOk ? 0 : 1);
+  }
+}
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i += 2) {
+    const bool hasValue = i + 1 < argc;
+    if (hasValue && std::strcmp(argv[i], "--size") == 0) {
+      options.fileSize = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 0));
+    } else if (hasValue && std::strcmp(argv[i], "--mtu") == 0) {
+      FakeNimble::attMtu = static_cast<uint16_t>(std::atoi(argv[i + 1]));
+    } else if (hasValue && std::strcmp(argv[i], "--interval") == 0) {
+      options.connectionIntervalMs = std::atof(argv[i + 1]);
+    } else if (hasValue && std::strcmp(argv[i], "--packets-per-event") == 0) {
+      options.packetsPerEvent = static_cast<unsigned>(std::atoi(argv[i + 1]));
+    } else {
+      std::fprintf(stderr,
+                   "Usage: %s [--size <bytes>] [--mtu <bytes>] [--interval <ms>] [--packets-per-event <count>]\n",
+                   argv[0]);
+      return 1;
+    }
+  }
+  if (FakeNimble::attMtu <= 3 + sizeof(WriteData) || options.packetsPerEvent == 0) {
+    std::fprintf(stderr, "Invalid MTU or number of packets per event\n");
+    return 1;
+  }
+
+  // FSService waits with vTaskDelay() and the SPI driver of the simulator notifies the calling task
+  xTaskCreate(LoopbackTask, "LOOPBACK", 2048, nullptr, tskIDLE_PRIORITY + 1, nullptr);
+  vTaskStartScheduler();
+  return 0;
+}
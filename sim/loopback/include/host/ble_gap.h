@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <nrf_assert.h>
+
+// Minimal replacement of the NimBLE host API used by FSService, for the BLE FS loopback (sim/loopback/FsLoopback.cpp).
+//
+// The types keep the name and the field order of NimBLE so that the designated initializers of the services compile
+// unchanged. An os_mbuf is a single flat buffer with some leading space, as the ATT packets allocated by
+// ble_hs_mbuf_att_pkt(). The notifications are not sent over the air: ble_gattc_notify_custom() hands them to the
+// phone model of the loopback. The callouts of the NimBLE porting layer only run when the loopback expires them.
+
+#define BLE_UUID_TYPE_16 16
+#define BLE_UUID_TYPE_32 32
+#define BLE_UUID_TYPE_128 128
+
+#define BLE_GATT_SVC_TYPE_END 0
+#define BLE_GATT_SVC_TYPE_PRIMARY 1
+#define BLE_GATT_SVC_TYPE_SECONDARY 2
+
+#define BLE_GATT_CHR_F_BROADCAST 0x0001
+#define BLE_GATT_CHR_F_READ 0x0002
+#define BLE_GATT_CHR_F_WRITE_NO_RSP 0x0004
+#define BLE_GATT_CHR_F_WRITE 0x0008
+#define BLE_GATT_CHR_F_NOTIFY 0x0010
+#define BLE_GATT_CHR_F_INDICATE 0x0020
+
+#define BLE_GATT_ACCESS_OP_READ_CHR 0
+#define BLE_GATT_ACCESS_OP_WRITE_CHR 1
+
+#define BLE_ATT_ERR_INSUFFICIENT_RES 0x11
+
+struct os_mbuf {
+  static constexpr size_t leadingSpace = 8;
+  static constexpr size_t bufferSize = 512;
+
+  uint8_t* om_data;
+  uint16_t om_len;
+  uint8_t buffer[bufferSize];
+};
+
+typedef struct {
+  uint8_t type;
+} ble_uuid_t;
+
+typedef struct {
+  ble_uuid_t u;
+  uint16_t value;
+} ble_uuid16_t;
+
+typedef struct {
+  ble_uuid_t u;
+  uint8_t value[16];
+} ble_uuid128_t;
+
+struct ble_gatt_access_ctxt {
+  uint8_t op;
+  struct os_mbuf* om;
+};
+
+typedef int ble_gatt_access_fn(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt* ctxt, void* arg);
+
+struct ble_gatt_dsc_def;
+
+struct ble_gatt_chr_def {
+  const ble_uuid_t* uuid;
+  ble_gatt_access_fn* access_cb;
+  void* arg;
+  struct ble_gatt_dsc_def* descriptors;
+  uint16_t flags;
+  uint8_t min_key_size;
+  uint16_t* val_handle;
+};
+
+struct ble_gatt_svc_def {
+  uint8_t type;
+  const ble_uuid_t* uuid;
+  const struct ble_gatt_svc_def** includes;
+  const struct ble_gatt_chr_def* characteristics;
+};
+
+int ble_gatts_count_cfg(const struct ble_gatt_svc_def* defs);
+int ble_gatts_add_svcs(const struct ble_gatt_svc_def* svcs);
+int ble_gattc_notify_custom(uint16_t conn_handle, uint16_t att_handle, struct os_mbuf* om);
+uint16_t ble_att_mtu(uint16_t conn_handle);
+
+struct os_mbuf* ble_hs_mbuf_att_pkt(void);
+struct os_mbuf* ble_hs_mbuf_from_flat(const void* buf, uint16_t len);
+
+int os_mbuf_append(struct os_mbuf* om, const void* data, uint16_t len);
+void* os_mbuf_extend(struct os_mbuf* om, uint16_t len);
+void os_mbuf_adj(struct os_mbuf* om, int req_len);
+int os_mbuf_copyinto(struct os_mbuf* om, int off, const void* src, int len);
+int os_mbuf_copydata(const struct os_mbuf* om, int off, int len, void* dst);
+int os_mbuf_free_chain(struct os_mbuf* om);
+
+typedef uint32_t ble_npl_time_t;
+struct ble_npl_event;
+typedef void ble_npl_event_fn(struct ble_npl_event* ev);
+
+struct ble_npl_event {
+  ble_npl_event_fn* fn;
+  void* arg;
+};
+
+struct ble_npl_eventq {};
+
+struct ble_npl_callout {
+  struct ble_npl_event ev;
+  bool active;
+};
+
+void* ble_npl_event_get_arg(struct ble_npl_event* ev);
+void ble_npl_callout_init(struct ble_npl_callout* co, struct ble_npl_eventq* evq, ble_npl_event_fn* ev_cb, void* ev_arg);
+int ble_npl_callout_reset(struct ble_npl_callout* co, ble_npl_time_t ticks);
+void ble_npl_callout_stop(struct ble_npl_callout* co);
+ble_npl_time_t ble_npl_time_ms_to_ticks32(uint32_t ms);
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <host/ble_gap.h>
+
+// Loopback replacement for the NimBLE porting layer, see include/host/ble_gap.h.
+
+struct ble_npl_eventq* nimble_port_get_dflt_eventq(void);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include "systemtask/Messages.h"
+
+// Loopback replacement for src/systemtask/SystemTask.h: FSService only pushes the file transfer messages and waits
+// for the system to be awake. The messages are counted so that the loopback can check the wake-up handshake.
+
+namespace Pinetime {
+  namespace System {
+    class SystemTask {
+    public:
+      void PushMessage(Messages msg) {
+        if (msg == Messages::StartFileTransfer) {
+          startFileTransferCount++;
+        } else if (msg == Messages::StopFileTransfer) {
+          stopFileTransferCount++;
+        }
+      }
+
+      bool IsSleeping() const {
+        return false;
+      }
+
+      unsigned startFileTransferCount = 0;
+      unsigned stopFileTransferCount = 0;
+    };
+  }
+}
@@ -0,0 +1,308 @@
+// Headless simulator of the PineTime firmware.
+//
+// Runs DisplayApp, ScreenGraph and the watch faces on top of the FreeRTOS POSIX port, with stub drivers
+// for the LCD, the touch panel and the sensors. The user input and sensor values are read from a script
+// (a file given on the command line, or stdin), one command per line:
+//
+//   wait <ms>                    let the firmware run for the given time
+//   tap <x> <y>                  single tap
+//   doubletap <x> <y>            double tap
+//   longtap <x> <y>              long press
+//   swipe <left|right|up|down>   swipe gesture
+//   button                       click on the side button
+//   motion <x> <y> <z> <steps>   values returned by the accelerometer
+//   hrs <hrs> <als>              values returned by the heart rate sensor
+//   heap <bytes>                 free heap reported to the firmware (used by the screen cache of the ScreenGraph)
+//   heap-report                  log the heap counters, free block histogram and call sites (HEAP_TRACKING builds only)
+//   dump <file.ppm>              write the content of the panel as a PPM image
+//   stats                        print the LCD counters since the previous "stats" and reset them
+//   frames                       print the records of the frame profiler (last frames redrawn by LVGL)
+//   tearing <file.ppm>           print the number of writes torn by the scan of the panel since the previous "tearing",
+//                                and write the timeline of the last writes as a PPM image
+//   quit                         exit the simulator
+//
+// Lines starting with '#' are ignored.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <timers.h>
+
+#include "components/battery/BatteryController.h"
+#include "components/ble/BleController.h"
+#include "components/ble/NotificationManager.h"
+#include "components/brightness/BrightnessController.h"
+#include "components/motor/MotorController.h"
+#include "components/datetime/DateTimeController.h"
+#include "components/heartrate/HeartRateController.h"
+#include "components/fs/FS.h"
+#include "components/frameprofiler/FrameProfiler.h"
+#include "drivers/Spi.h"
+#include "drivers/SpiMaster.h"
+#include "drivers/SpiNorFlash.h"
+#include "drivers/St7789.h"
+#include "drivers/TwiMaster.h"
+#include "drivers/Cst816s.h"
+#include "drivers/PinMap.h"
+#include "drivers/Bma421.h"
+#include "drivers/Hrs3300.h"
+#include "drivers/Watchdog.h"
+#include "systemtask/SystemTask.h"
+#include "systemtask/SystemMonitor.h"
+#include "touchhandler/TouchHandler.h"
+#include "displayapp/DisplayApp.h"
+#include "displayapp/screens/RedrawPlanner.h"
+#include "Simulator.h"
+
+static constexpr uint8_t touchPanelTwiAddress = 0x15;
+static constexpr uint8_t motionSensorTwiAddress = 0x18;
+static constexpr uint8_t heartRateSensorTwiAddress = 0x44;
+
+Pinetime::Drivers::SpiMaster spi {Pinetime::Drivers::SpiMaster::SpiModule::SPI0,
+                                  {Pinetime::Drivers::SpiMaster::BitOrder::Msb_Lsb,
+                                   Pinetime::Drivers::SpiMaster::Modes::Mode3,
+                                   Pinetime::Drivers::SpiMaster::Frequencies::Freq8Mhz,
+                                   Pinetime::PinMap::SpiSck,
+                                   Pinetime::PinMap::SpiMosi,
+                                   Pinetime::PinMap::SpiMiso}};
+
+Pinetime::Drivers::Spi lcdSpi {spi, Pinetime::PinMap::SpiLcdCsn, Pinetime::Drivers::SpiMaster::Clients::Display};
+Pinetime::Drivers::St7789 lcd {lcdSpi, Pinetime::PinMap::LcdDataCommand, Pinetime::PinMap::LcdReset};
+
+Pinetime::Drivers::Spi flashSpi {spi, Pinetime::PinMap::SpiFlashCsn, Pinetime::Drivers::SpiMaster::Clients::FlashRead};
+Pinetime::Drivers::SpiNorFlash spiNorFlash {flashSpi};
+
+Pinetime::Drivers::TwiMaster twiMaster {NRF_TWIM1, 0x06200000, Pinetime::PinMap::TwiSda, Pinetime::PinMap::TwiScl};
+Pinetime::Drivers::Cst816S touchPanel {twiMaster, touchPanelTwiAddress};
+Pinetime::Drivers::Bma421 motionSensor {twiMaster, motionSensorTwiAddress};
+Pinetime::Drivers::Hrs3300 heartRateSensor {twiMaster, heartRateSensorTwiAddress};
+
+Pinetime::Controllers::Battery batteryController;
+Pinetime::Controllers::Ble bleController;
+
+Pinetime::Controllers::HeartRateController heartRateController;
+Pinetime::Applications::HeartRateTask heartRateApp(heartRateSensor, heartRateController);
+
+Pinetime::Controllers::FS fs {spiNorFlash};
+Pinetime::Controllers::Settings settingsController {fs};
+Pinetime::Controllers::MotorController motorController {};
+
+Pinetime::Controllers::DateTime dateTimeController {settingsController};
+Pinetime::Drivers::Watchdog watchdog;
+Pinetime::Controllers::NotificationManager notificationManager;
+Pinetime::Controllers::MotionController motionController;
+Pinetime::Controllers::AlarmController alarmController {dateTimeController};
+Pinetime::Controllers::TouchHandler touchHandler;
+Pinetime::Controllers::BrightnessController brightnessController {};
+Pinetime::Controllers::FrameProfiler frameProfiler;
+
+Pinetime::Applications::DisplayApp displayApp(lcd,
+                                              touchPanel,
+                                              batteryController,
+                                              bleController,
+                                              dateTimeController,
+                                              watchdog,
+                                              notificationManager,
+                                              heartRateController,
+                                              settingsController,
+                                              motorController,
+                                              motionController,
+                                              alarmController,
+                                              brightnessController,
+                                              touchHandler,
+                                              fs,
+                                              frameProfiler);
+
+Pinetime::System::SystemTask systemTask(spi,
+                                        spiNorFlash,
+                                        twiMaster,
+                                        touchPanel,
+                                        batteryController,
+                                        bleController,
+                                        dateTimeController,
+                                        alarmController,
+                                        watchdog,
+                                        notificationManager,
+                                        heartRateSensor,
+                                        motionController,
+                                        motionSensor,
+                                        settingsController,
+                                        heartRateController,
+                                        displayApp,
+                                        heartRateApp,
+                                        fs,
+                                        touchHandler);
+
+std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> NoInit_BackUpTime;
+
+namespace {
+  FILE* script = nullptr;
+  TaskHandle_t scriptTaskHandle;
+
+  void PushGesture(Pinetime::Drivers::Cst816S::Gestures gesture, uint16_t x, uint16_t y) {
+    Pinetime::Drivers::Cst816S::TouchInfos info;
+    info.x = x;
+    info.y = y;
+    info.gesture = gesture;
+    info.touching = true;
+    info.isValid = true;
+    Pinetime::Simulator::PushTouch(info);
+    vTaskDelay(pdMS_TO_TICKS(20));
+
+    info.gesture = Pinetime::Drivers::Cst816S::Gestures::None;
+    info.touching = false;
+    Pinetime::Simulator::PushTouch(info);
+  }
+
+  void PrintFrames() {
+    Pinetime::Controllers::FrameProfiler::Frame frames[Pinetime::Controllers::FrameProfiler::nbFrames];
+    auto nb = frameProfiler.GetFrames(frames, Pinetime::Controllers::FrameProfiler::nbFrames);
+    std::printf("[FRAMES] total=%u bytes=%u\n",
+                static_cast<unsigned>(frameProfiler.TotalFrames()),
+                static_cast<unsigned>(frameProfiler.TotalBytes()));
+    for (uint8_t i = 0; i < nb; i++) {
+      std::printf("[FRAME] tick=%u areas=%u draws=%u pixels=%u bytes=%u render=%uus wait=%uus\n",
+                  static_cast<unsigned>(frames[i].timestamp),
+                  static_cast<unsigned>(frames[i].areas),
+                  static_cast<unsigned>(frames[i].drawCalls),
+                  static_cast<unsigned>(frames[i].pixels),
+                  static_cast<unsigned>(frames[i].bytes),
+                  static_cast<unsigned>(frames[i].renderTime),
+                  static_cast<unsigned>(frames[i].waitTime));
+    }
+  }
+
+  bool ExecuteCommand(char* line) {
+    char* command = std::strtok(line, " \t\r\n");
+    if (command == nullptr || command[0] == '#') {
+      return true;
+    }
+
+    auto nextInt = []() {
+      char* argument = std::strtok(nullptr, " \t\r\n");
+      return (argument != nullptr) ? std::atoi(argument) : 0;
+    };
+
+    if (std::strcmp(command, "wait") == 0) {
+      vTaskDelay(pdMS_TO_TICKS(nextInt()));
+    } else if (std::strcmp(command, "tap") == 0) {
+      int x = nextInt();
+      PushGesture(Pinetime::Drivers::Cst816S::Gestures::SingleTap, x, nextInt());
+    } else if (std::strcmp(command, "doubletap") == 0) {
+      int x = nextInt();
+      PushGesture(Pinetime::Drivers::Cst816S::Gestures::DoubleTap, x, nextInt());
+    } else if (std::strcmp(command, "longtap") == 0) {
+      int x = nextInt();
+      PushGesture(Pinetime::Drivers::Cst816S::Gestures::LongPress, x, nextInt());
+    } else if (std::strcmp(command, "swipe") == 0) {
+      char* direction = std::strtok(nullptr, " \t\r\n");
+      if (direction == nullptr) {
+        return false;
+      }
+      if (std::strcmp(direction, "left") == 0) {
+        PushGesture(Pinetime::Drivers::Cst816S::Gestures::SlideLeft, 200, 120);
+      } else if (std::strcmp(direction, "right") == 0) {
+        PushGesture(Pinetime::Drivers::Cst816S::Gestures::SlideRight, 40, 120);
+      } else if (std::strcmp(direction, "up") == 0) {
+        PushGesture(Pinetime::Drivers::Cst816S::Gestures::SlideUp, 120, 40);
+      } else if (std::strcmp(direction, "down") == 0) {
+        PushGesture(Pinetime::Drivers::Cst816S::Gestures::SlideDown, 120, 200);
+      } else {
+        return false;
+      }
+    } else if (std::strcmp(command, "button") == 0) {
+      Pinetime::Simulator::PushButton();
+    } else if (std::strcmp(command, "motion") == 0) {
+      int x = nextInt();
+      int y = nextInt();
+      int z = nextInt();
+      Pinetime::Simulator::SetMotion(x, y, z, nextInt());
+    } else if (std::strcmp(command, "hrs") == 0) {
+      int hrs = nextInt();
+      Pinetime::Simulator::SetHeartRateSample(hrs, nextInt());
+    } else if (std::strcmp(command, "heap") == 0) {
+      Pinetime::Simulator::SetFreeHeapSize(nextInt());
+    } else if (std::strcmp(command, "heap-report") == 0) {
+#ifdef HEAP_TRACKING
+      Pinetime::System::SystemMonitor::LogHeapReport();
+#else
+      std::printf("[HEAP] heap-report needs a build with -DHEAP_TRACKING=ON\n");
+#endif
+    } else if (std::strcmp(command, "dump") == 0) {
+      char* path = std::strtok(nullptr, " \t\r\n");
+      if (path == nullptr || !Pinetime::Simulator::DumpVisibleFrame(path)) {
+        return false;
+      }
+    } else if (std::strcmp(command, "stats") == 0) {
+      const auto& statistics = Pinetime::Simulator::GetLcdStatistics();
+      std::printf("[STATS] tick=%u drawBuffer=%u pixels=%u bytes=%u vscroll=%u scrollStart=%u handPixelsPerSecond=%u\n",
+                  static_cast<unsigned>(xTaskGetTickCount()),
+                  static_cast<unsigned>(statistics.drawBufferCalls),
+                  static_cast<unsigned>(statistics.pixels),
+                  static_cast<unsigned>(statistics.bytes),
+                  static_cast<unsigned>(statistics.verticalScrollCommands),
+                  static_cast<unsigned>(Pinetime::Simulator::GetVerticalScrollStart()),
+                  static_cast<unsigned>(RedrawPlanner::pixelsRedrawnPerSecond()));
+      Pinetime::Simulator::ResetLcdStatistics();
+    } else if (std::strcmp(command, "frames") == 0) {
+      PrintFrames();
+    } else if (std::strcmp(command, "tearing") == 0) {
+      char* path = std::strtok(nullptr, " \t\r\n");
+      if (path == nullptr || !Pinetime::Simulator::DumpTearingTrace(path)) {
+        return false;
+      }
+      const auto& statistics = Pinetime::Simulator::GetTearingStatistics();
+      std::printf("[TEARING] tick=%u writes=%u torn=%u\n",
+                  static_cast<unsigned>(xTaskGetTickCount()),
+                  static_cast<unsigned>(statistics.writes),
+                  static_cast<unsigned>(statistics.tornWrites));
+      Pinetime::Simulator::ResetTearingStatistics();
+    } else if (std::strcmp(command, "quit") == 0) {
+      std::fflush(stdout);
+      std::exit(0);
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  void ScriptTask(void* /*unused*/) {
+    char line[256];
+    uint32_t lineNumber = 0;
+    while (std::fgets(line, sizeof(line), script) != nullptr) {
+      lineNumber++;
+      if (!ExecuteCommand(line)) {
+        std::fprintf(stderr, "Invalid command at line %u\n", static_cast<unsigned>(lineNumber));
+        std::exit(1);
+      }
+    }
+    std::fflush(stdout);
+    std::exit(0);
+  }
+}
+
+void Pinetime::Simulator::OnTouchInterrupt() {
+  systemTask.OnTouchEvent();
+}
+
+void Pinetime::Simulator::PushButton() {
+  systemTask.PushMessage(Pinetime::System::Messages::HandleButtonEvent);
+}
+
+int main(int argc, char** argv) {
+  script = (argc > 1) ? std::fopen(argv[1], "r") : stdin;
+  if (script == nullptr) {
+    std::fprintf(stderr, "Unable to open %s\n", argv[1]);
+    return 1;
+  }
+
+  systemTask.Start();
+  // Lowest priority, so that the firmware tasks are never preempted by the script
+  xTaskCreate(ScriptTask, "SIM", 512, nullptr, tskIDLE_PRIORITY, &scriptTaskHandle);
+
+  vTaskStartScheduler();
+  return 0;
+}
@@ -0,0 +1,138 @@
+// Floating-point / fixed-point comparison of the PPG signal chain.
+//
+// Feeds the same heart rate sensor samples to Controllers::PpgFloat and Controllers::PpgFixed, the way
+// HeartRateTask does (one sample every Ppg::deltaTms, Reset() on ambient light or when the HR is lost),
+// and prints the BPM returned by both for each analysis, followed by a summary.
+//
+//   pinetime-ppg-replay <file>              replay a trace: one "<hrs> <als>" sample per line, '#' starts a comment
+//   pinetime-ppg-replay --synthetic <bpm>   60 seconds of a sine wave at <bpm> with drift and noise
+//
+// The durations are measured on the host and are only useful to compare both implementations with each other:
+// the cycle counts are host time converted at 64MHz, not a measurement on the Cortex-M4 of the watch.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "components/heartrate/Ppg.h"
+
+using namespace Pinetime::Controllers;
+
+namespace {
+  struct Sample {
+    uint32_t hrs;
+    uint32_t als;
+  };
+
+  constexpr double cpuFrequencyMHz = 64.0;
+
+  bool LoadTrace(const char* fileName, std::vector<Sample>& samples) {
+    FILE* file = std::fopen(fileName, "r");
+    if (file == nullptr) {
+      std::fprintf(stderr, "Cannot open %s\n", fileName);
+      return false;
+    }
+    char line[128];
+    while (std::fgets(line, sizeof(line), file) != nullptr) {
+      if (line[0] == '#') {
+        continue;
+      }
+      unsigned long hrs;
+      unsigned long als;
+      if (std::sscanf(line, "%lu %lu", &hrs, &als) == 2) {
+        samples.push_back({static_cast<uint32_t>(hrs), static_cast<uint32_t>(als)});
+      }
+    }
+    std::fclose(file);
+    return true;
+  }
+
+  void Synthesize(float bpm, std::vector<Sample>& samples) {
+    constexpr int duration = 60000;
+    std::srand(1);
+    for (int time = 0; time < duration; time += Ppg::deltaTms) {
+      float seconds = time / 1000.0f;
+      float pulse = 30.0f * std::sin(2.0f * static_cast<float>(M_PI) * bpm / 60.0f * seconds);
+      float drift = 20.0f * seconds;
+      samples.push_back({static_cast<uint32_t>(20000.0f + pulse + drift + std::rand() % 5), 10});
+    }
+  }
+
+  // Runs one implementation on a sample and mimics the state handling of HeartRateTask.
+  template <typename Implementation>
+  int Step(Implementation& ppg, const Sample& sample, double& elapsedUs) {
+    auto start = std::chrono::steady_clock::now();
+    int8_t ambient = ppg.Preprocess(sample.hrs, sample.als);
+    int bpm = ppg.HeartRate();
+    elapsedUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    if (ambient > 0) {
+      ppg.Reset(true);
+      bpm = 0;
+    } else if (bpm < 0) {
+      ppg.Reset(false);
+      bpm = 0;
+    }
+    return bpm;
+  }
+}
+
+int main(int argc, char** argv) {
+  std::vector<Sample> samples;
+  if (argc == 3 && std::strcmp(argv[1], "--synthetic") == 0) {
+    Synthesize(std::atof(argv[2]), samples);
+  } else if (argc == 2) {
+    if (!LoadTrace(argv[1], samples)) {
+      return 1;
+    }
+  } else {
+    std::fprintf(stderr, "Usage: %s <trace> | --synthetic <bpm>\n", argv[0]);
+    return 1;
+  }
+
+  PpgFloat ppgFloat;
+  PpgFixed ppgFixed;
+  double floatUs = 0;
+  double fixedUs = 0;
+  int analyses = 0;
+  int identical = 0;
+  int close = 0;
+  int maxDifference = 0;
+
+  std::printf("# time(ms) float fixed\n");
+  for (size_t idx = 0; idx < samples.size(); idx++) {
+    int bpmFloat = Step(ppgFloat, samples[idx], floatUs);
+    int bpmFixed = Step(ppgFixed, samples[idx], fixedUs);
+    if (bpmFloat == 0 && bpmFixed == 0) {
+      continue;
+    }
+    int difference = std::abs(bpmFloat - bpmFixed);
+    analyses++;
+    identical += (difference == 0) ? 1 : 0;
+    close += (difference <= 1) ? 1 : 0;
+    if (difference > maxDifference) {
+      maxDifference = difference;
+    }
+    std::printf("%zu %d %d\n", idx * Ppg::deltaTms, bpmFloat, bpmFixed);
+  }
+
+  std::printf("# %zu samples, %d analyses: %d identical, %d within 1 BPM, max difference %d BPM\n",
+              samples.size(),
+              analyses,
+              identical,
+              close,
+              maxDifference);
+  if (!samples.empty()) {
+    double floatPerSample = floatUs / samples.size();
+    double fixedPerSample = fixedUs / samples.size();
+    std::printf("# host time per sample: float %.3fus (%.0f cycles at 64MHz), fixed %.3fus (%.0f cycles at 64MHz)\n",
+                floatPerSample,
+                floatPerSample * cpuFrequencyMHz,
+                fixedPerSample,
+                fixedPerSample * cpuFrequencyMHz);
+  }
+  return 0;
+}
@@ -0,0 +1,279 @@
+// Replay of recorded sensor samples through the heart rate and motion algorithms.
+//
+// Feeds timestamped HRS3300 and BMA421 samples to Controllers::Ppg (the way HeartRateTask does: Reset() on
+// ambient light or when the HR is lost) and to Controllers::MotionController (the way SystemTask::UpdateMotion()
+// does: AddSample(), the wake checks, then Update() with the step count), and prints the results:
+//
+//   pinetime-sensor-replay [--awake] [--shake-threshold <value>] <file>
+//
+// The file contains one sample per line, '#' starts a comment:
+//
+//   <ms> hrs <hrs> <als>                  heart rate sensor, sampled every Ppg::deltaTms on the watch
+//   <ms> motion <x> <y> <z> <steps>       motion sensor, sampled every Bma421::fifoSamplePeriodMs on the watch
+//
+// and the output one event per line, followed by the time spent in each function:
+//
+//   <ms> bpm <value>                      value published by HeartRateTask (0: heart rate lost)
+//   <ms> raise                            ShouldRaiseWake() would wake the watch up
+//   <ms> shake <speed>                    ShouldShakeWake() would wake the watch up
+//
+// The output only depends on the input file (except the durations, which are printed as comments), so the
+// output of two versions of the algorithms can be compared with diff. The durations are measured on the host.
+//
+// The reference traces (sim/replay/traces) also contain the expected results:
+//
+//   <ms> expect bpm <min> <max>           the last BPM published is in [min, max] (0: no heart rate)
+//   <ms> expect raise                     ShouldRaiseWake() wakes the watch up at <ms>
+//   <ms> expect shake                     ShouldShakeWake() wakes the watch up at <ms>
+//
+// Once a file contains an expectation, its wake events must all be expected. The mismatches are reported on
+// stderr and the exit status is 1.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "components/heartrate/Ppg.h"
+#include "components/motion/MotionController.h"
+
+using namespace Pinetime::Controllers;
+
+namespace {
+  // Timestamp of the sample being replayed, returned by xTaskGetTickCount()
+  TickType_t replayTicks = 0;
+
+  struct CallStatistics {
+    const char* name;
+    uint32_t count = 0;
+    double totalUs = 0;
+    double maxUs = 0;
+
+    explicit CallStatistics(const char* name) : name {name} {
+    }
+
+    void Print() const {
+      if (count == 0) {
+        std::printf("# %-16s not called\n", name);
+        return;
+      }
+      std::printf("# %-16s %8u calls, avg %8.3fus, max %8.3fus\n", name, count, totalUs / count, maxUs);
+    }
+  };
+
+  // Calls function() and adds its duration to statistics
+  template <typename Function>
+  auto Measure(CallStatistics& statistics, Function function) -> decltype(function()) {
+    auto start = std::chrono::steady_clock::now();
+    auto result = function();
+    double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    statistics.count++;
+    statistics.totalUs += elapsed;
+    if (elapsed > statistics.maxUs) {
+      statistics.maxUs = elapsed;
+    }
+    return result;
+  }
+
+  CallStatistics preprocessStatistics {"Preprocess"};
+  CallStatistics heartRateStatistics {"HeartRate"};
+  CallStatistics addSampleStatistics {"AddSample"};
+  CallStatistics raiseWakeStatistics {"ShouldRaiseWake"};
+  CallStatistics shakeWakeStatistics {"ShouldShakeWake"};
+  CallStatistics updateStatistics {"Update"};
+
+  Ppg ppg;
+  int lastBpm = 0;
+
+  MotionController motionController;
+  bool isSleeping = true;
+  uint16_t shakeThreshold = 150;
+
+  // Wake events (time, "raise" or "shake") produced by the replay and expected by the file
+  using WakeEvents = std::vector<std::pair<unsigned long, std::string>>;
+  WakeEvents wakeEvents;
+  WakeEvents expectedWakeEvents;
+  bool hasExpectations = false;
+  unsigned nbFailedExpectations = 0;
+
+  // Measurement path of HeartRateTask::Work()
+  void ReplayHeartRate(unsigned long time, uint32_t hrs, uint32_t als) {
+    int8_t ambient = Measure(preprocessStatistics, [&]() {
+      return ppg.Preprocess(hrs, als);
+    });
+    int bpm = Measure(heartRateStatistics, [&]() {
+      return ppg.HeartRate();
+    });
+
+    if (ambient > 0) {
+      ppg.Reset(true);
+      lastBpm = 0;
+      bpm = 0;
+    } else if (bpm < 0) {
+      ppg.Reset(false);
+      bpm = 0;
+      std::printf("%lu bpm 0\n", time);
+    }
+
+    if (bpm != 0) {
+      lastBpm = bpm;
+      std::printf("%lu bpm %d\n", time, bpm);
+    }
+  }
+
+  // Motion path of SystemTask::UpdateMotion(), for a single sample
+  void ReplayMotion(unsigned long time, int16_t x, int16_t y, int16_t z, uint32_t steps) {
+    Measure(addSampleStatistics, [&]() {
+      motionController.AddSample(x, y, z, replayTicks);
+      return 0;
+    });
+    if (Measure(raiseWakeStatistics, [&]() {
+          return motionController.ShouldRaiseWake(isSleeping);
+        })) {
+      std::printf("%lu raise\n", time);
+      wakeEvents.emplace_back(time, "raise");
+    }
+    if (Measure(shakeWakeStatistics, [&]() {
+          return motionController.ShouldShakeWake(shakeThreshold);
+        })) {
+      std::printf("%lu shake %ld\n", time, static_cast<long>(motionController.CurrentShakeSpeed()));
+      wakeEvents.emplace_back(time, "shake");
+    }
+    Measure(updateStatistics, [&]() {
+      motionController.Update(steps);
+      return 0;
+    });
+  }
+
+  // Parses "bpm <min> <max>", "raise" or "shake" and checks the BPM right away: the wake events are compared
+  // once the whole file is replayed. Returns false if the expectation is invalid.
+  bool Expect(unsigned lineNumber, unsigned long time, const char* expectation) {
+    hasExpectations = true;
+    int minBpm;
+    int maxBpm;
+    char event[16];
+    if (std::sscanf(expectation, "bpm %d %d", &minBpm, &maxBpm) == 2) {
+      if (lastBpm < minBpm || lastBpm > maxBpm) {
+        std::fprintf(stderr, "Line %u: expected %d to %d bpm at %lums, got %d\n", lineNumber, minBpm, maxBpm, time, lastBpm);
+        nbFailedExpectations++;
+      }
+      return true;
+    }
+    if (std::sscanf(expectation, "%15s", event) == 1 && (std::strcmp(event, "raise") == 0 || std::strcmp(event, "shake") == 0)) {
+      expectedWakeEvents.emplace_back(time, event);
+      return true;
+    }
+    return false;
+  }
+
+  // Reports the wake events that are missing or unexpected
+  void CheckWakeEvents() {
+    for (const auto& expected : expectedWakeEvents) {
+      if (std::find(wakeEvents.begin(), wakeEvents.end(), expected) == wakeEvents.end()) {
+        std::fprintf(stderr, "Expected %s at %lums\n", expected.second.c_str(), expected.first);
+        nbFailedExpectations++;
+      }
+    }
+    for (const auto& event : wakeEvents) {
+      if (std::find(expectedWakeEvents.begin(), expectedWakeEvents.end(), event) == expectedWakeEvents.end()) {
+        std::fprintf(stderr, "Unexpected %s at %lums\n", event.second.c_str(), event.first);
+        nbFailedExpectations++;
+      }
+    }
+  }
+}
+
+// MotionController::Update(x, y, z, steps) timestamps the samples with the tick count
+extern "C" TickType_t xTaskGetTickCount(void) {
+  return replayTicks;
+}
+
+int main(int argc, char** argv) {
+  const char* fileName = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--awake") == 0) {
+      isSleeping = false;
+    } else if (std::strcmp(argv[i], "--shake-threshold") == 0 && i + 1 < argc) {
+      shakeThreshold = static_cast<uint16_t>(std::atoi(argv[++i]));
+    } else {
+      fileName = argv[i];
+    }
+  }
+  if (fileName == nullptr) {
+    std::fprintf(stderr, "Usage: %s [--awake] [--shake-threshold <value>] <file>\n", argv[0]);
+    return 1;
+  }
+
+  FILE* file = std::fopen(fileName, "r");
+  if (file == nullptr) {
+    std::fprintf(stderr, "Cannot open %s\n", fileName);
+    return 1;
+  }
+
+  char line[128];
+  unsigned lineNumber = 0;
+  while (std::fgets(line, sizeof(line), file) != nullptr) {
+    lineNumber++;
+    if (line[0] == '#' || line[0] == '\n') {
+      continue;
+    }
+
+    unsigned long time;
+    char type[16];
+    int offset;
+    if (std::sscanf(line, "%lu %15s %n", &time, type, &offset) != 2) {
+      std::fprintf(stderr, "Line %u: invalid sample\n", lineNumber);
+      continue;
+    }
+    replayTicks = static_cast<TickType_t>(time * configTICK_RATE_HZ / 1000);
+
+    if (std::strcmp(type, "hrs") == 0) {
+      unsigned long hrs;
+      unsigned long als;
+      if (std::sscanf(line + offset, "%lu %lu", &hrs, &als) == 2) {
+        ReplayHeartRate(time, static_cast<uint32_t>(hrs), static_cast<uint32_t>(als));
+        continue;
+      }
+    } else if (std::strcmp(type, "motion") == 0) {
+      int x;
+      int y;
+      int z;
+      unsigned long steps;
+      if (std::sscanf(line + offset, "%d %d %d %lu", &x, &y, &z, &steps) == 4) {
+        ReplayMotion(time, static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z), static_cast<uint32_t>(steps));
+        continue;
+      }
+    } else if (std::strcmp(type, "expect") == 0) {
+      if (Expect(lineNumber, time, line + offset)) {
+        continue;
+      }
+    }
+    std::fprintf(stderr, "Line %u: invalid sample\n", lineNumber);
+  }
+  std::fclose(file);
+
+  std::printf("# last bpm %d, %lu steps\n", lastBpm, static_cast<unsigned long>(motionController.NbSteps()));
+  std::printf("# host time per call:\n");
+  preprocessStatistics.Print();
+  heartRateStatistics.Print();
+  addSampleStatistics.Print();
+  raiseWakeStatistics.Print();
+  shakeWakeStatistics.Print();
+  updateStatistics.Print();
+
+  if (hasExpectations) {
+    CheckWakeEvents();
+    if (nbFailedExpectations > 0) {
+      std::fprintf(stderr, "%s: %u expectations not met\n", fileName, nbFailedExpectations);
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,289 @@
+// Register-level model of the SPIM EasyDMA transfers of SpiMaster::Write(), run on the host.
+//
+// The model implements the parts of the SPIM, PPI and TIMER peripherals used by the driver (ArrayList mode, END ->
+// START chaining, END counting, channel group disabling and compare interrupt) and replays the register programming of
+// SpiMaster for the two paths:
+//
+//   legacy   one segment of at most 255 bytes at a time, the next one being programmed by the END interrupt
+//   chained  the segments planned by SpimSegments, chained by PPI, with a single interrupt at the end of the chain
+//
+// For each transfer size, it checks that the bytes clocked out are the bytes of the buffer (in order, exactly once)
+// and prints the number of interrupts taken by the CPU:
+//
+//   pinetime-spim-model [<size>...]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "drivers/SpimSegments.h"
+
+using Pinetime::Drivers::SpimSegments;
+
+namespace {
+  enum class Event { SpimEnd, TimerCompare0, TimerCompare1 };
+  enum class Task { None, SpimStart, TimerCount, DisableGroup };
+
+  struct PpiChannel {
+    Event event = Event::SpimEnd;
+    Task task = Task::None;
+    bool enabled = false;
+    bool inGroup = false;
+  };
+
+  class Model {
+  public:
+    explicit Model(const std::vector<uint8_t>& memory) : memory {memory} {
+    }
+
+    // SPIM registers
+    size_t txdPtr = 0;
+    size_t txdMaxCnt = 0;
+    bool txdList = false;
+    bool intenEnd = true;
+    bool intenStarted = true;
+    bool eventsEnd = false;
+    bool eventsStarted = false;
+
+    // TIMER registers (counter mode)
+    uint32_t timerCount = 0;
+    uint32_t timerCc[2] = {0, 0};
+    bool timerRunning = false;
+    bool intenCompare1 = true;
+
+    // PPI channels of the chain
+    PpiChannel channels[3];
+
+    // Interrupt handlers of the driver
+    void (*onSpimEnd)(Model&) = nullptr;
+    void (*onTimerCompare1)(Model&) = nullptr;
+
+    std::vector<uint8_t> output;
+    unsigned interrupts = 0;
+    bool overrun = false;
+
+    void TriggerStart() {
+      pendingStarts++;
+      if (!running) {
+        Run();
+      }
+    }
+
+  private:
+    const std::vector<uint8_t>& memory;
+    unsigned pendingStarts = 0;
+    bool running = false;
+
+    void Run() {
+      running = true;
+      while (pendingStarts > 0) {
+        pendingStarts--;
+        Transfer();
+      }
+      running = false;
+    }
+
+    void Transfer() {
+      eventsStarted = true;
+      if (intenStarted) {
+        eventsStarted = false;
+        interrupts++;
+      }
+      for (size_t i = 0; i < txdMaxCnt; i++) {
+        if (txdPtr + i >= memory.size()) {
+          overrun = true;
+          break;
+        }
+        output.push_back(memory[txdPtr + i]);
+      }
+      if (txdList) {
+        txdPtr += txdMaxCnt;
+      }
+      eventsEnd = true;
+      Signal(Event::SpimEnd);
+      // The chain end handler may have cleared the event before enabling the interrupt again
+      if (intenEnd && eventsEnd && onSpimEnd != nullptr) {
+        eventsEnd = false;
+        interrupts++;
+        onSpimEnd(*this);
+      }
+    }
+
+    // The tasks of all the channels listening to an event are triggered at the same time
+    void Signal(Event event) {
+      Task tasks[3];
+      size_t count = 0;
+      for (const PpiChannel& channel : channels) {
+        if (channel.enabled && channel.event == event) {
+          tasks[count++] = channel.task;
+        }
+      }
+      for (size_t i = 0; i < count; i++) {
+        Execute(tasks[i]);
+      }
+    }
+
+    void Execute(Task task) {
+      switch (task) {
+        case Task::SpimStart:
+          pendingStarts++;
+          break;
+        case Task::TimerCount:
+          if (timerRunning) {
+            timerCount++;
+            if (timerCount == timerCc[0]) {
+              Signal(Event::TimerCompare0);
+            }
+            if (timerCount == timerCc[1]) {
+              Signal(Event::TimerCompare1);
+              if (intenCompare1 && onTimerCompare1 != nullptr) {
+                interrupts++;
+                onTimerCompare1(*this);
+              }
+            }
+          }
+          break;
+        case Task::DisableGroup:
+          for (PpiChannel& channel : channels) {
+            if (channel.inGroup) {
+              channel.enabled = false;
+            }
+          }
+          break;
+        case Task::None:
+          break;
+      }
+    }
+  };
+
+  // State of the driver (SpiMaster::currentBufferAddr/currentBufferSize)
+  size_t currentBufferAddr;
+  size_t currentBufferSize;
+  bool transferDone;
+
+  void PrepareTx(Model& model, size_t address, size_t size) {
+    model.txdPtr = address;
+    model.txdMaxCnt = size;
+    model.txdList = false;
+    model.eventsEnd = false;
+  }
+
+  // SpiMaster::OnEndEvent()
+  void OnEndEvent(Model& model) {
+    if (currentBufferSize > 0) {
+      size_t currentSize = std::min((size_t) 255, currentBufferSize);
+      PrepareTx(model, currentBufferAddr, currentSize);
+      currentBufferAddr += currentSize;
+      currentBufferSize -= currentSize;
+      model.TriggerStart();
+    } else {
+      transferDone = true;
+    }
+  }
+
+  // SpiMaster::OnChainEndEvent() and StopChain()
+  void OnChainEndEvent(Model& model) {
+    for (PpiChannel& channel : model.channels) {
+      channel.enabled = false;
+    }
+    model.timerRunning = false;
+    model.eventsEnd = false;
+    model.eventsStarted = false;
+    model.intenEnd = true;
+    model.intenStarted = true;
+    OnEndEvent(model);
+  }
+
+  // SpiMaster::Write() without chaining
+  void LegacyWrite(Model& model, size_t size) {
+    currentBufferAddr = 0;
+    currentBufferSize = size;
+    size_t currentSize = std::min((size_t) 255, currentBufferSize);
+    PrepareTx(model, currentBufferAddr, currentSize);
+    currentBufferSize -= currentSize;
+    currentBufferAddr += currentSize;
+    model.TriggerStart();
+  }
+
+  // SpiMaster::Write() and StartChain()
+  void ChainedWrite(Model& model, size_t size) {
+    currentBufferAddr = 0;
+    currentBufferSize = size;
+    const auto segments = SpimSegments::Plan(size);
+    if (!segments.IsChained()) {
+      LegacyWrite(model, size);
+      return;
+    }
+
+    model.intenEnd = false;
+    model.intenStarted = false;
+    model.timerRunning = false;
+    model.timerCount = 0;
+    model.timerCc[0] = segments.UnchainCompare();
+    model.timerCc[1] = segments.EndCompare();
+    model.channels[0] = {Event::SpimEnd, Task::SpimStart, false, true};
+    model.channels[1] = {Event::SpimEnd, Task::TimerCount, false, false};
+    model.channels[2] = {Event::TimerCompare0, Task::DisableGroup, false, false};
+    for (PpiChannel& channel : model.channels) {
+      channel.enabled = true;
+    }
+    model.timerRunning = true;
+
+    model.txdPtr = currentBufferAddr;
+    model.txdMaxCnt = segments.segmentSize;
+    model.txdList = true;
+    model.eventsEnd = false;
+
+    currentBufferAddr += segments.segmentSize * segments.chainedSegments;
+    currentBufferSize = segments.remainderSize;
+    model.TriggerStart();
+  }
+
+  struct Result {
+    unsigned interrupts;
+    bool ok;
+  };
+
+  Result Run(void (*write)(Model&, size_t), const std::vector<uint8_t>& buffer) {
+    Model model {buffer};
+    model.onSpimEnd = OnEndEvent;
+    model.onTimerCompare1 = OnChainEndEvent;
+    transferDone = false;
+    write(model, buffer.size());
+    return {model.interrupts, transferDone && !model.overrun && model.output == buffer};
+  }
+}
+
+int main(int argc, char** argv) {
+  std::vector<size_t> sizes;
+  for (int i = 1; i < argc; i++) {
+    sizes.push_back(std::strtoul(argv[i], nullptr, 0));
+  }
+  if (sizes.empty()) {
+    // Commands, a 240 pixels line, the LVGL buffer (240x4 pixels), a flash page and a few odd sizes
+    sizes = {1, 2, 100, 255, 256, 300, 480, 511, 1000, 1920, 2049, 4096, 7680, 65535};
+  }
+
+  bool allOk = true;
+  std::printf("#   size  segments            legacy ISRs  chained ISRs\n");
+  for (size_t size : sizes) {
+    std::vector<uint8_t> buffer(size);
+    for (size_t i = 0; i < size; i++) {
+      buffer[i] = static_cast<uint8_t>(i * 7 + (i >> 8));
+    }
+    const auto segments = SpimSegments::Plan(size);
+    Result legacy = Run(LegacyWrite, buffer);
+    Result chained = Run(ChainedWrite, buffer);
+    std::printf("%8zu  %4zu x %3zu + %3zu  %12u  %12u  %s\n",
+                size,
+                segments.chainedSegments,
+                segments.segmentSize,
+                segments.remainderSize,
+                legacy.interrupts,
+                chained.interrupts,
+                (legacy.ok && chained.ok) ? "ok" : "FAILED");
+    allOk = allOk && legacy.ok && chained.ok;
+  }
+  return allOk ? 0 : 1;
+}
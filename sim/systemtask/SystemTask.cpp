@@ -0,0 +1,283 @@
+#include "systemtask/SystemTask.h"
+#include <hal/nrf_rtc.h>
+#include <libraries/log/nrf_log.h>
+#include "components/battery/BatteryController.h"
+#include "components/ble/BleController.h"
+#include "drivers/Cst816s.h"
+#include "drivers/St7789.h"
+#include "drivers/SpiMaster.h"
+#include "drivers/SpiNorFlash.h"
+#include "drivers/TwiMaster.h"
+#include "drivers/Hrs3300.h"
+
+#include <algorithm>
+
+using namespace Pinetime::System;
+
+SystemTask::SystemTask(Drivers::SpiMaster& spi,
+                       Pinetime::Drivers::SpiNorFlash& spiNorFlash,
+                       Drivers::TwiMaster& twiMaster,
+                       Drivers::Cst816S& touchPanel,
+                       Controllers::Battery& batteryController,
+                       Controllers::Ble& bleController,
+                       Controllers::DateTime& dateTimeController,
+                       Controllers::AlarmController& alarmController,
+                       Drivers::Watchdog& watchdog,
+                       Pinetime::Controllers::NotificationManager& notificationManager,
+                       Pinetime::Drivers::Hrs3300& heartRateSensor,
+                       Pinetime::Controllers::MotionController& motionController,
+                       Pinetime::Drivers::Bma421& motionSensor,
+                       Controllers::Settings& settingsController,
+                       Pinetime::Controllers::HeartRateController& heartRateController,
+                       Pinetime::Applications::DisplayApp& displayApp,
+                       Pinetime::Applications::HeartRateTask& heartRateApp,
+                       Pinetime::Controllers::FS& fs,
+                       Pinetime::Controllers::TouchHandler& touchHandler)
+  : spi {spi},
+    spiNorFlash {spiNorFlash},
+    twiMaster {twiMaster},
+    touchPanel {touchPanel},
+    batteryController {batteryController},
+    bleController {bleController},
+    dateTimeController {dateTimeController},
+    alarmController {alarmController},
+    watchdog {watchdog},
+    notificationManager {notificationManager},
+    heartRateSensor {heartRateSensor},
+    motionSensor {motionSensor},
+    settingsController {settingsController},
+    heartRateController {heartRateController},
+    motionController {motionController},
+    displayApp {displayApp},
+    heartRateApp {heartRateApp},
+    fs {fs},
+    touchHandler {touchHandler} {
+}
+
+void SystemTask::Start() {
+  systemTasksMsgQueue = xQueueCreate(10, 1);
+  if (pdPASS != xTaskCreate(SystemTask::Process, "MAIN", 350, this, 1, &taskHandle)) {
+    NRF_LOG_ERROR("[systemtask] Unable to create the task");
+  }
+}
+
+void SystemTask::Process(void* instance) {
+  auto* app = static_cast<SystemTask*>(instance);
+  NRF_LOG_INFO("systemtask task started!");
+  app->Work();
+}
+
+void SystemTask::Work() {
+  spi.Init();
+  spiNorFlash.Init();
+  spiNorFlash.Wakeup();
+
+  fs.Init();
+
+  twiMaster.Init();
+  touchPanel.Init();
+  dateTimeController.Register(this);
+  batteryController.Register(this);
+  alarmController.Init(this);
+
+  motionSensor.Init();
+  motionController.Init(motionSensor.DeviceType());
+  settingsController.Init();
+
+  displayApp.Register(this);
+  displayApp.Start(BootErrors::None);
+
+  heartRateSensor.Init();
+  heartRateSensor.Disable();
+  heartRateApp.Start();
+
+  batteryController.MeasureVoltage();
+
+  while (true) {
+    // Block until a message is received or until the next periodic job is due, as the firmware does
+    Messages msg;
+    if (xQueueReceive(systemTasksMsgQueue, &msg, TicksToNextJob()) == pdTRUE) {
+      switch (msg) {
+        case Messages::EnableSleeping:
+          doNotGoToSleep = false;
+          displayApp.PushMessage(Pinetime::Applications::Display::Messages::RestoreBrightness);
+          break;
+        case Messages::DisableSleeping:
+          doNotGoToSleep = true;
+          break;
+        case Messages::GoToRunning:
+          spi.Wakeup();
+          touchPanel.Wakeup();
+          spiNorFlash.Wakeup();
+          displayApp.PushMessage(Pinetime::Applications::Display::Messages::GoToRunning);
+          heartRateApp.PushMessage(Pinetime::Applications::HeartRateTask::Messages::WakeUp);
+          state = SystemTaskState::Running;
+          break;
+        case Messages::TouchWakeUp:
+          if (touchHandler.ProcessTouchInfo(touchPanel.GetTouchInfo())) {
+            auto gesture = touchHandler.GestureGet();
+            if ((gesture == Pinetime::Applications::TouchEvents::DoubleTap &&
+                 settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::DoubleTap)) ||
+                (gesture == Pinetime::Applications::TouchEvents::Tap &&
+                 settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::SingleTap))) {
+              GoToRunning();
+            }
+          }
+          break;
+        case Messages::GoToSleep:
+          if (doNotGoToSleep) {
+            break;
+          }
+          state = SystemTaskState::GoingToSleep;
+          NRF_LOG_INFO("[systemtask] Going to sleep");
+          displayApp.PushMessage(Pinetime::Applications::Display::Messages::GoToSleep);
+          heartRateApp.PushMessage(Pinetime::Applications::HeartRateTask::Messages::GoToSleep);
+          break;
+        case Messages::OnNewTime:
+          displayApp.PushMessage(Pinetime::Applications::Display::Messages::RestoreBrightness);
+          displayApp.PushMessage(Pinetime::Applications::Display::Messages::UpdateDateTime);
+          break;
+        case Messages::SetOffAlarm:
+          if (state == SystemTaskState::Sleeping) {
+            GoToRunning();
+          }
+          displayApp.PushMessage(Pinetime::Applications::Display::Messages::AlarmTriggered);
+          break;
+        case Messages::OnTouchEvent:
+          if (touchHandler.ProcessTouchInfo(touchPanel.GetTouchInfo())) {
+            displayApp.PushMessage(Pinetime::Applications::Display::Messages::TouchEvent);
+          }
+          break;
+        case Messages::HandleButtonEvent:
+          // The simulator has no debouncing nor long press detection: every button event is a click
+          if (IsSleeping()) {
+            GoToRunning();
+            break;
+          }
+          displayApp.PushMessage(Pinetime::Applications::Display::Messages::RestoreBrightness);
+          displayApp.PushMessage(Pinetime::Applications::Display::Messages::ButtonPushed);
+          break;
+        case Messages::OnDisplayTaskSleeping:
+          spiNorFlash.Sleep();
+          spi.Sleep();
+          touchPanel.Sleep();
+          state = SystemTaskState::Sleeping;
+          break;
+        case Messages::TimeEventTimerExpired:
+          // The time events are emitted by DateTime::UpdateTime() in RunPeriodicJobs()
+          break;
+        case Messages::OnNewDay:
+          motionSensor.ResetStepCounter();
+          break;
+        case Messages::MeasureBatteryTimerExpired:
+          batteryController.MeasureVoltage();
+          break;
+        default:
+          break;
+      }
+    }
+
+    RunPeriodicJobs();
+  }
+}
+
+void SystemTask::RunPeriodicJobs() {
+  TickType_t now = xTaskGetTickCount();
+  if (IsMotionPollingNeeded() && now - lastMotionUpdate >= motionPollingPeriod) {
+    lastMotionUpdate = now;
+    UpdateMotion();
+  }
+
+  uint32_t systick_counter = nrf_rtc_counter_get(portNRF_RTC_REG);
+  dateTimeController.UpdateTime(systick_counter);
+  NoInit_BackUpTime = dateTimeController.CurrentDateTime();
+  watchdog.Reload();
+}
+
+TickType_t SystemTask::TicksToNextJob() const {
+  static_assert(configTICK_RATE_HZ == 1024, "The RTC ticks and the FreeRTOS ticks must be the same");
+
+  // The watchdog must be reloaded before it expires
+  TickType_t timeout = watchdogReloadPeriod;
+
+  if (IsMotionPollingNeeded()) {
+    TickType_t elapsed = xTaskGetTickCount() - lastMotionUpdate;
+    timeout = std::min(timeout, (elapsed < motionPollingPeriod) ? motionPollingPeriod - elapsed : 0);
+  }
+
+  // The time is refreshed every second while the display is on. While sleeping, the chimes and the new day events
+  // are emitted when the timer of the time events expires (TimeEventTimerExpired).
+  if (state == SystemTaskState::Running) {
+    timeout = std::min(timeout, dateTimeController.TicksToNextSecond(nrf_rtc_counter_get(portNRF_RTC_REG)));
+  }
+
+  return timeout;
+}
+
+bool SystemTask::IsMotionPollingNeeded() const {
+  if (state == SystemTaskState::GoingToSleep || state == SystemTaskState::WakingUp) {
+    return false;
+  }
+
+  // While sleeping, the motion sensor is only polled if it can wake the watch up
+  return state == SystemTaskState::Running ||
+         settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::RaiseWrist) ||
+         settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::Shake);
+}
+
+void SystemTask::UpdateMotion() {
+  Drivers::Bma421::FifoValues motionValues;
+  if (!motionSensor.ProcessFifo(motionValues)) {
+    // Keep the step count of the last successful read rather than reporting 0 steps
+    return;
+  }
+
+  // The samples were buffered by the sensor at a steady rate, the last one is the most recent
+  constexpr TickType_t samplePeriod = pdMS_TO_TICKS(Drivers::Bma421::fifoSamplePeriodMs);
+  TickType_t timestamp = xTaskGetTickCount() - motionValues.nbSamples * samplePeriod;
+  bool shouldWakeUp = false;
+  for (size_t i = 0; i < motionValues.nbSamples; i++) {
+    const auto& sample = motionValues.samples[i];
+    timestamp += samplePeriod;
+    motionController.AddSample(sample.x, sample.y, sample.z, timestamp);
+
+    if (settingsController.GetNotificationStatus() != Controllers::Settings::Notification::Sleep) {
+      if ((settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::RaiseWrist) &&
+           motionController.ShouldRaiseWake(state == SystemTaskState::Sleeping)) ||
+          (settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::Shake) &&
+           motionController.ShouldShakeWake(settingsController.GetShakeThreshold()))) {
+        shouldWakeUp = true;
+      }
+    }
+  }
+  motionController.Update(motionValues.steps);
+
+  if (shouldWakeUp) {
+    GoToRunning();
+  }
+}
+
+void SystemTask::GoToRunning() {
+  if (state == SystemTaskState::Sleeping) {
+    state = SystemTaskState::WakingUp;
+    PushMessage(Messages::GoToRunning);
+  }
+}
+
+void SystemTask::OnTouchEvent() {
+  if (state == SystemTaskState::Running) {
+    PushMessage(Messages::OnTouchEvent);
+  } else if (state == SystemTaskState::Sleeping) {
+    if (settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::SingleTap) or
+        settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::DoubleTap)) {
+      PushMessage(Messages::TouchWakeUp);
+    }
+  }
+}
+
+void SystemTask::PushMessage(System::Messages msg) {
+  if (msg == Messages::GoToSleep && !doNotGoToSleep) {
+    state = SystemTaskState::GoingToSleep;
+  }
+  xQueueSend(systemTasksMsgQueue, &msg, portMAX_DELAY);
+}
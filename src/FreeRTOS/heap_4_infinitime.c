@@ -37,6 +37,7 @@
 * See heap_1.c, heap_2.c and heap_3.c for alternative implementations, and the
 * memory management pages of http://www.FreeRTOS.org for more information.
 */
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -50,6 +51,10 @@ task.h is included from an application file. */
 
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
+#ifdef HEAP_TRACKING
+ #include "heap_tracking.h"
+#endif
+
 #if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
  #error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
 #endif
@@ -113,9 +118,55 @@ application.  When the bit is free the block is still part of the free heap
 space. */
 static size_t xBlockAllocatedBit = 0;
 
+#ifdef HEAP_TRACKING
+/* The index of the call site of an allocated block is kept in bits 24 to 30 of
+its xBlockSize member, which are never set in the size of a block. */
+#define heapCALL_SITE_SHIFT		( ( size_t ) 24 )
+#define heapCALL_SITE_MASK		( ( size_t ) 0x7f << heapCALL_SITE_SHIFT )
+
+#if( configTOTAL_HEAP_SIZE >= ( 1UL << 24 ) ) || ( heapTRACKING_MAX_CALL_SITES > 0x80 )
+ #error The block sizes and the call site indexes do not fit in xBlockSize
+#endif
+
+static HeapCallSite_t xCallSites[ heapTRACKING_MAX_CALL_SITES ];
+static size_t xNumberOfCallSites = 1;
+static size_t xLiveBytes = 0U;
+static size_t xPeakBytes = 0U;
+static uint32_t ulAllocations = 0U;
+static uint32_t ulFrees = 0U;
+static uint32_t ulFailedAllocations = 0U;
+
+/*
+* Charges the block, which is being allocated, to the call site and records its
+* index in the block.  Called with the scheduler suspended.
+*/
+static void prvTrackAllocation( BlockLink_t *pxBlock, const void *pvCallSite );
+
+/*
+* Removes the block, which is being freed, from the bytes of its call site and
+* clears the index of the call site.  Called with the scheduler suspended.
+*/
+static void prvTrackFree( BlockLink_t *pxBlock );
+
+#define heapMALLOC( xWantedSize ) pvPortMallocFrom( ( xWantedSize ), pvCallSite )
+#else
+#define heapCALL_SITE_MASK		( ( size_t ) 0 )
+#define heapMALLOC( xWantedSize ) pvPortMalloc( xWantedSize )
+#endif /* HEAP_TRACKING */
+
+/*-----------------------------------------------------------*/
+
+#ifdef HEAP_TRACKING
+void *pvPortMalloc( size_t xWantedSize )
+{
+ return pvPortMallocFrom( xWantedSize, __builtin_return_address( 0 ) );
+}
 /*-----------------------------------------------------------*/
 
+void *pvPortMallocFrom( size_t xWantedSize, const void *pvCallSite )
+#else
 void *pvPortMalloc( size_t xWantedSize )
+#endif
 {
  BlockLink_t *pxBlock, *pxPreviousBlock, *pxNewBlockLink;
  void *pvReturn = NULL;
@@ -229,6 +280,10 @@ void *pvPortMalloc( size_t xWantedSize )
            mtCOVERAGE_TEST_MARKER();
          }
 
+#ifdef HEAP_TRACKING
+         prvTrackAllocation( pxBlock, pvCallSite );
+#endif
+
          /* The block is being returned - it is allocated and owned
          by the application and has no "next" block. */
          pxBlock->xBlockSize |= xBlockAllocatedBit;
@@ -249,6 +304,13 @@ void *pvPortMalloc( size_t xWantedSize )
      mtCOVERAGE_TEST_MARKER();
    }
 
+#ifdef HEAP_TRACKING
+   if( ( pvReturn == NULL ) && ( xWantedSize > 0 ) )
+   {
+     ulFailedAllocations++;
+   }
+#endif
+
    traceMALLOC( pvReturn, xWantedSize );
  }
  ( void ) xTaskResumeAll();
@@ -300,6 +362,10 @@ void vPortFree( void *pv )
 
        vTaskSuspendAll();
        {
+#ifdef HEAP_TRACKING
+         prvTrackFree( pxLink );
+#endif
+
          /* Add this block to the list of free blocks. */
          xFreeBytesRemaining += pxLink->xBlockSize;
          traceFREE( pv, pxLink->xBlockSize );
@@ -448,7 +514,15 @@ static void prvInsertBlockIntoFreeList( BlockLink_t *pxBlockToInsert )
 
 /*-----------------------------------------------------------*/
 
+#ifdef HEAP_TRACKING
+void* pvPortRealloc(void* pv, size_t xWantedSize) {
+ return pvPortReallocFrom(pv, xWantedSize, __builtin_return_address(0));
+}
+
+void* pvPortReallocFrom(void* pv, size_t xWantedSize, const void* pvCallSite) {
+#else
 void* pvPortRealloc(void* pv, size_t xWantedSize) {
+#endif
  size_t move_size;
  size_t block_size;
  BlockLink_t* pxLink;
@@ -462,7 +536,7 @@ void* pvPortRealloc(void* pv, size_t xWantedSize) {
 
  if (pv == NULL) {
    // pv points to NULL. Allocate a new buffer.
-   return pvPortMalloc(xWantedSize);
+   return heapMALLOC(xWantedSize);
  }
 
  // The memory being freed will have an BlockLink_t structure immediately before it.
@@ -474,10 +548,10 @@ void* pvPortRealloc(void* pv, size_t xWantedSize) {
  // Check allocate block
  if ((pxLink->xBlockSize & xBlockAllocatedBit) != 0) {
    // The block is being returned to the heap - it is no longer allocated.
-   block_size = (pxLink->xBlockSize & ~xBlockAllocatedBit) - xHeapStructSize;
+   block_size = (pxLink->xBlockSize & ~(xBlockAllocatedBit | heapCALL_SITE_MASK)) - xHeapStructSize;
 
    // Allocate a new buffer
-   pvReturn = pvPortMalloc(xWantedSize);
+   pvReturn = heapMALLOC(xWantedSize);
 
    // Check creation and determine the data size to be copied to the new buffer
    if (pvReturn != NULL) {
@@ -495,8 +569,131 @@ void* pvPortRealloc(void* pv, size_t xWantedSize) {
    }
  } else {
    // pv does not point to a valid memory buffer. Allocate a new one
-   pvReturn = pvPortMalloc(xWantedSize);
+   pvReturn = heapMALLOC(xWantedSize);
  }
 
  return pvReturn;
-}
\ No newline at end of file
+}
+#ifdef HEAP_TRACKING
+/*-----------------------------------------------------------*/
+
+static void prvTrackAllocation( BlockLink_t *pxBlock, const void *pvCallSite )
+{
+ HeapCallSite_t *pxCallSite;
+ size_t xIndex;
+
+ /* The table is small and only compiled in tracking builds: it is searched
+ linearly. */
+ for( xIndex = 1; xIndex < xNumberOfCallSites; xIndex++ )
+ {
+   if( xCallSites[ xIndex ].pvCallSite == pvCallSite )
+   {
+     break;
+   }
+ }
+
+ if( xIndex == xNumberOfCallSites )
+ {
+   if( xNumberOfCallSites < heapTRACKING_MAX_CALL_SITES )
+   {
+     xCallSites[ xIndex ].pvCallSite = pvCallSite;
+     xNumberOfCallSites++;
+   }
+   else
+   {
+     xIndex = 0;
+   }
+ }
+
+ pxCallSite = &( xCallSites[ xIndex ] );
+ pxCallSite->ulAllocations++;
+ pxCallSite->xLiveBytes += pxBlock->xBlockSize;
+ if( pxCallSite->xLiveBytes > pxCallSite->xPeakBytes )
+ {
+   pxCallSite->xPeakBytes = pxCallSite->xLiveBytes;
+ }
+
+ ulAllocations++;
+ xLiveBytes += pxBlock->xBlockSize;
+ if( xLiveBytes > xPeakBytes )
+ {
+   xPeakBytes = xLiveBytes;
+ }
+
+ pxBlock->xBlockSize |= xIndex << heapCALL_SITE_SHIFT;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTrackFree( BlockLink_t *pxBlock )
+{
+ HeapCallSite_t *pxCallSite = &( xCallSites[ ( pxBlock->xBlockSize & heapCALL_SITE_MASK ) >> heapCALL_SITE_SHIFT ] );
+
+ pxBlock->xBlockSize &= ~heapCALL_SITE_MASK;
+
+ pxCallSite->ulFrees++;
+ pxCallSite->xLiveBytes -= pxBlock->xBlockSize;
+
+ ulFrees++;
+ xLiveBytes -= pxBlock->xBlockSize;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetHeapCallSites( HeapCallSite_t *pxCallSites, size_t xMaxCallSites )
+{
+ size_t xIndex;
+ size_t xCount = 0;
+
+ vTaskSuspendAll();
+ {
+   for( xIndex = 0; ( xIndex < xNumberOfCallSites ) && ( xCount < xMaxCallSites ); xIndex++ )
+   {
+     if( xCallSites[ xIndex ].ulAllocations != 0 )
+     {
+       pxCallSites[ xCount++ ] = xCallSites[ xIndex ];
+     }
+   }
+ }
+ ( void ) xTaskResumeAll();
+
+ return xCount;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapReport( HeapReport_t *pxReport )
+{
+ BlockLink_t *pxBlock;
+ size_t xSize;
+ size_t xBucket;
+
+ memset( pxReport, 0, sizeof( HeapReport_t ) );
+
+ vTaskSuspendAll();
+ {
+   pxReport->xLiveBytes = xLiveBytes;
+   pxReport->xPeakBytes = xPeakBytes;
+   pxReport->ulAllocations = ulAllocations;
+   pxReport->ulFrees = ulFrees;
+   pxReport->ulFailedAllocations = ulFailedAllocations;
+   pxReport->xFreeBytes = xFreeBytesRemaining;
+   pxReport->xMinimumEverFreeBytes = xMinimumEverFreeBytesRemaining;
+
+   /* The list is empty until the first allocation initialises the heap. */
+   for( pxBlock = xStart.pxNextFreeBlock; ( pxBlock != NULL ) && ( pxBlock != pxEnd ); pxBlock = pxBlock->pxNextFreeBlock )
+   {
+     pxReport->xNumberOfFreeBlocks++;
+     if( pxBlock->xBlockSize > pxReport->xLargestFreeBlock )
+     {
+       pxReport->xLargestFreeBlock = pxBlock->xBlockSize;
+     }
+
+     xBucket = 0;
+     for( xSize = pxBlock->xBlockSize >> 5; ( xSize != 0 ) && ( xBucket < heapTRACKING_HISTOGRAM_BUCKETS - 1 ); xSize >>= 1 )
+     {
+       xBucket++;
+     }
+     pxReport->usFreeBlockHistogram[ xBucket ]++;
+   }
+ }
+ ( void ) xTaskResumeAll();
+}
+#endif /* HEAP_TRACKING */
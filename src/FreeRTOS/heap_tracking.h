@@ -0,0 +1,64 @@
+#pragma once
+
+/*
+* Allocation tracking of heap_4_infinitime.c, compiled in with -DHEAP_TRACKING=ON.
+*
+* Each allocation is charged to its call site, the return address of the call to
+* malloc(), new or pvPortMalloc() (LVGL allocates through lv_mem_alloc(), which
+* is therefore the call site of all the LVGL objects). The index of the call site
+* is stored in the unused high bits of the size of the allocated block, so the
+* layout of the heap is the same as in a regular build. Addresses are resolved
+* with addr2line on the ELF file of the firmware.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Call sites tracked separately, the first entry collects the allocations of
+the call sites that did not fit in the table. */
+#define heapTRACKING_MAX_CALL_SITES 48
+
+/* Free block histogram: bucket 0 counts the blocks smaller than 32 bytes, bucket
+n the blocks of [16 << n, 32 << n) bytes and the last one all the larger blocks. */
+#define heapTRACKING_HISTOGRAM_BUCKETS 12
+
+typedef struct
+{
+ const void *pvCallSite;  /*<< NULL for the entry collecting the call sites that did not fit in the table. */
+ uint32_t ulAllocations;  /*<< Successful allocations since boot. */
+ uint32_t ulFrees;
+ size_t xLiveBytes;       /*<< Size of the blocks currently allocated, block headers and alignment included. */
+ size_t xPeakBytes;       /*<< Maximum of xLiveBytes since boot. */
+} HeapCallSite_t;
+
+typedef struct
+{
+ size_t xLiveBytes;
+ size_t xPeakBytes;
+ uint32_t ulAllocations;
+ uint32_t ulFrees;
+ uint32_t ulFailedAllocations;
+ size_t xFreeBytes;
+ size_t xMinimumEverFreeBytes;
+ size_t xNumberOfFreeBlocks;
+ size_t xLargestFreeBlock;
+ uint16_t usFreeBlockHistogram[ heapTRACKING_HISTOGRAM_BUCKETS ];
+} HeapReport_t;
+
+/* pvPortMalloc() and pvPortRealloc() charging the allocation to the given call site. */
+void *pvPortMallocFrom( size_t xWantedSize, const void *pvCallSite );
+void *pvPortReallocFrom( void *pv, size_t xWantedSize, const void *pvCallSite );
+
+/* Copies the call sites that allocated memory since boot, returns their number. */
+size_t xPortGetHeapCallSites( HeapCallSite_t *pxCallSites, size_t xMaxCallSites );
+
+/* Counters of the heap and histogram of its free blocks, walked with the scheduler suspended. */
+void vPortGetHeapReport( HeapReport_t *pxReport );
+
+#ifdef __cplusplus
+}
+#endif
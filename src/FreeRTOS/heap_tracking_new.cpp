@@ -0,0 +1,33 @@
+#ifdef HEAP_TRACKING
+  #include <cstddef>
+  #include <FreeRTOS.h>
+  #include "heap_tracking.h"
+
+// The operator new of libstdc++ allocates with malloc(), which would be the call site of every C++ object: the
+// replaceable operators charge the allocations to the code calling new (screens created by the ScreenGraph,
+// std::unique_ptr of the services, growth of the std::vector).
+
+void* operator new(std::size_t size) {
+  return pvPortMallocFrom(size, __builtin_return_address(0));
+}
+
+void* operator new[](std::size_t size) {
+  return pvPortMallocFrom(size, __builtin_return_address(0));
+}
+
+void operator delete(void* ptr) noexcept {
+  vPortFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  vPortFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept {
+  vPortFree(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t /*size*/) noexcept {
+  vPortFree(ptr);
+}
+#endif
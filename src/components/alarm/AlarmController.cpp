@@ -18,6 +18,8 @@
 #include "components/alarm/AlarmController.h"
 #include "systemtask/SystemTask.h"
 #include "task.h"
+#include <hal/nrf_rtc.h>
+#include <algorithm>
 #include <chrono>
 
 using namespace Pinetime::Controllers;
@@ -76,7 +78,9 @@ void AlarmController::ScheduleAlarm() {
   // now can convert back to a time_point
   alarmTime = std::chrono::system_clock::from_time_t(std::mktime(tmAlarmTime));
   auto secondsToAlarm = std::chrono::duration_cast<std::chrono::seconds>(alarmTime - now).count();
-  xTimerChangePeriod(alarmTimer, secondsToAlarm * configTICK_RATE_HZ, 0);
+  // Counted from the RTC, the current time being the time of the last second boundary seen by DateTime
+  TickType_t ticksToAlarm = dateTimeController.TicksUntil(nrf_rtc_counter_get(portNRF_RTC_REG), secondsToAlarm);
+  xTimerChangePeriod(alarmTimer, std::max<TickType_t>(ticksToAlarm, 1), 0);
   xTimerStart(alarmTimer, 0);
 
   state = AlarmState::Set;
@@ -0,0 +1,83 @@
+#include "components/ble/DebugService.h"
+
+using namespace Pinetime::Controllers;
+
+namespace {
+  // 0005yyxx-78fc-48fe-8e23-433b3a1942d0
+  constexpr ble_uuid128_t CharUuid(uint8_t x, uint8_t y) {
+    return ble_uuid128_t {.u = {.type = BLE_UUID_TYPE_128},
+                          .value = {0xd0, 0x42, 0x19, 0x3a, 0x3b, 0x43, 0x23, 0x8e, 0xfe, 0x48, 0xfc, 0x78, x, y, 0x05, 0x00}};
+  }
+
+  // 00050000-78fc-48fe-8e23-433b3a1942d0
+  constexpr ble_uuid128_t BaseUuid() {
+    return CharUuid(0x00, 0x00);
+  }
+
+  constexpr ble_uuid128_t debugServiceUuid {BaseUuid()};
+  constexpr ble_uuid128_t frameProfileCharUuid {CharUuid(0x01, 0x00)};
+  constexpr ble_uuid128_t spiLatencyCharUuid {CharUuid(0x02, 0x00)};
+
+  int DebugServiceCallback(uint16_t /*conn_handle*/, uint16_t attr_handle, struct ble_gatt_access_ctxt* ctxt, void* arg) {
+    auto* debugService = static_cast<DebugService*>(arg);
+    return debugService->OnRead(attr_handle, ctxt);
+  }
+}
+
+DebugService::DebugService(FrameProfiler& frameProfiler, Pinetime::Drivers::SpiMaster& spi)
+  : frameProfiler {frameProfiler},
+    spi {spi},
+    characteristicDefinition {{.uuid = &frameProfileCharUuid.u,
+                               .access_cb = DebugServiceCallback,
+                               .arg = this,
+                               .flags = BLE_GATT_CHR_F_READ,
+                               .val_handle = &frameProfileHandle},
+                              {.uuid = &spiLatencyCharUuid.u,
+                               .access_cb = DebugServiceCallback,
+                               .arg = this,
+                               .flags = BLE_GATT_CHR_F_READ,
+                               .val_handle = &spiLatencyHandle},
+                              {0}},
+    serviceDefinition {
+      {.type = BLE_GATT_SVC_TYPE_PRIMARY, .uuid = &debugServiceUuid.u, .characteristics = characteristicDefinition},
+      {0},
+    } {
+}
+
+void DebugService::Init() {
+  int res = 0;
+  res = ble_gatts_count_cfg(serviceDefinition);
+  ASSERT(res == 0);
+
+  res = ble_gatts_add_svcs(serviceDefinition);
+  ASSERT(res == 0);
+}
+
+int DebugService::OnRead(uint16_t attributeHandle, ble_gatt_access_ctxt* context) {
+  if (attributeHandle == frameProfileHandle) {
+    // The value is larger than the MTU: the stack calls this function for each Read Blob request and drops
+    // the bytes before the requested offset, so the records can change between two parts of the same read.
+    size_t size = frameProfiler.Serialize(frameProfileBuffer, sizeof(frameProfileBuffer));
+    int res = os_mbuf_append(context->om, frameProfileBuffer, size);
+    return (res == 0) ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+  }
+  if (attributeHandle == spiLatencyHandle) {
+    using Pinetime::Drivers::SpiMaster;
+    uint8_t* buffer = spiLatencyBuffer;
+    *buffer++ = 1;
+    *buffer++ = SpiMaster::nbClients;
+    *buffer++ = SpiMaster::nbLatencyBuckets;
+    *buffer++ = 0;
+    for (uint8_t client = 0; client < SpiMaster::nbClients; client++) {
+      SpiMaster::LatencyHistogram histogram = spi.GetLatencyHistogram(static_cast<SpiMaster::Clients>(client));
+      for (uint32_t count : histogram.buckets) {
+        for (uint8_t i = 0; i < 4; i++) {
+          *buffer++ = static_cast<uint8_t>(count >> (8u * i));
+        }
+      }
+    }
+    int res = os_mbuf_append(context->om, spiLatencyBuffer, sizeof(spiLatencyBuffer));
+    return (res == 0) ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+  }
+  return 0;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#define min // workaround: nimble's min/max macros conflict with libstdc++
+#define max
+#include <host/ble_gap.h>
+#undef max
+#undef min
+#include "components/frameprofiler/FrameProfiler.h"
+#include "drivers/SpiMaster.h"
+
+namespace Pinetime {
+  namespace Controllers {
+
+    // Read-only characteristics exposing internal statistics of the firmware for development purposes.
+    class DebugService {
+    public:
+      DebugService(FrameProfiler& frameProfiler, Pinetime::Drivers::SpiMaster& spi);
+      void Init();
+      int OnRead(uint16_t attributeHandle, ble_gatt_access_ctxt* context);
+
+    private:
+      FrameProfiler& frameProfiler;
+      Pinetime::Drivers::SpiMaster& spi;
+
+      struct ble_gatt_chr_def characteristicDefinition[3];
+      struct ble_gatt_svc_def serviceDefinition[2];
+
+      uint16_t frameProfileHandle;
+      uint8_t frameProfileBuffer[FrameProfiler::serializedSize];
+
+      // u8 version, u8 nb clients, u8 nb buckets, u8 reserved, then the buckets of each client (u32)
+      static constexpr size_t spiLatencySize =
+        4 + Pinetime::Drivers::SpiMaster::nbClients * Pinetime::Drivers::SpiMaster::nbLatencyBuckets * 4;
+      uint16_t spiLatencyHandle;
+      uint8_t spiLatencyBuffer[spiLatencySize];
+    };
+  }
+}
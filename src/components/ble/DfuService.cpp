@@ -1,4 +1,5 @@
 #include "components/ble/DfuService.h"
+#include <algorithm>
 #include <cstring>
 #include "components/ble/BleController.h"
 #include "drivers/SpiNorFlash.h"
@@ -161,8 +162,11 @@ int DfuService::WritePacketHandler(uint16_t connectionHandle, os_mbuf* om) {
 
     case States::Data: {
       nbPacketReceived++;
-      dfuImage.Append(om->om_data, om->om_len);
-      bytesReceived += om->om_len;
+      // A packet as large as the MTU may be split in several mbufs
+      for (os_mbuf* buffer = om; buffer != nullptr; buffer = SLIST_NEXT(buffer, om_next)) {
+        dfuImage.Append(buffer->om_data, buffer->om_len);
+        bytesReceived += buffer->om_len;
+      }
       bleController.FirmwareUpdateCurrentBytes(bytesReceived);
 
       if ((nbPacketReceived % nbPacketsToNotify) == 0 && bytesReceived != applicationSize) {
@@ -246,8 +250,7 @@ int DfuService::ControlPointHandler(uint16_t connectionHandle, os_mbuf* om) {
         NRF_LOG_INFO("[DFU] -> Receive firmware image requested, but we are not in Start Init");
         return 0;
       }
-      // TODO the chunk size is dependent of the implementation of the host application...
-      dfuImage.Init(20, applicationSize, expectedCrc);
+      dfuImage.Init(applicationSize, expectedCrc);
       NRF_LOG_INFO("[DFU] -> Starting receive firmware");
       state = States::Data;
       return 0;
@@ -350,37 +353,72 @@ void DfuService::NotificationManager::Reset() {
   xTimerStop(timer, 0);
 }
 
-void DfuService::DfuImage::Init(size_t chunkSize, size_t totalSize, uint16_t expectedCrc) {
-  if (chunkSize != 20)
+void DfuService::DfuImage::Init(size_t totalSize, uint16_t expectedCrc) {
+  if (totalSize > maxSize)
     return;
-  this->chunkSize = chunkSize;
   this->totalSize = totalSize;
   this->expectedCrc = expectedCrc;
+  this->totalReceived = 0;
+  this->totalWriteIndex = 0;
+  this->pageWriteIndex = 0;
+  this->currentPage = 0;
+  this->programFailed = false;
+  this->receivedCrc = 0xFFFF;
   this->ready = true;
 }
 
-void DfuService::DfuImage::Append(uint8_t* data, size_t size) {
-  if (!ready)
+// The packets can have any size (up to the MTU): they are copied into the current page, which is programmed as
+// soon as it is full while the next packets are copied into the other page.
+void DfuService::DfuImage::Append(const uint8_t* data, size_t size) {
+  if (!ready || totalReceived >= totalSize)
     return;
-  ASSERT(size <= 20);
+  if (size > totalSize - totalReceived)
+    size = totalSize - totalReceived;
+
+  receivedCrc = ComputeCrc(data, size, &receivedCrc);
+  totalReceived += size;
 
-  std::memcpy(tempBuffer + bufferWriteIndex, data, size);
-  bufferWriteIndex += size;
+  while (size > 0) {
+    size_t length = std::min(size, pageSize - pageWriteIndex);
+    std::memcpy(pages[currentPage].data() + pageWriteIndex, data, length);
+    pageWriteIndex += length;
+    data += length;
+    size -= length;
 
-  if (bufferWriteIndex == bufferSize) {
-    spiNorFlash.Write(writeOffset + totalWriteIndex, tempBuffer, bufferWriteIndex);
-    totalWriteIndex += bufferWriteIndex;
-    bufferWriteIndex = 0;
+    if (pageWriteIndex == pageSize) {
+      ProgramPage();
+    }
   }
 
-  if (bufferWriteIndex > 0 && totalWriteIndex + bufferWriteIndex == totalSize) {
-    spiNorFlash.Write(writeOffset + totalWriteIndex, tempBuffer, bufferWriteIndex);
-    totalWriteIndex += bufferWriteIndex;
+  if (totalReceived == totalSize) {
+    if (pageWriteIndex > 0) {
+      ProgramPage();
+    }
+    WaitProgramCompleted();
     if (totalSize < maxSize)
       WriteMagicNumber();
   }
 }
 
+void DfuService::DfuImage::ProgramPage() {
+  // The other page has been programmed while this one was filled, this usually does not wait
+  WaitProgramCompleted();
+  spiNorFlash.StartPageProgram(writeOffset + totalWriteIndex, pages[currentPage].data(), pageWriteIndex);
+  programPending = true;
+  totalWriteIndex += pageWriteIndex;
+  pageWriteIndex = 0;
+  currentPage = (currentPage + 1) % pages.size();
+}
+
+void DfuService::DfuImage::WaitProgramCompleted() {
+  if (!programPending)
+    return;
+  spiNorFlash.WaitWriteCompleted();
+  if (spiNorFlash.ProgramFailed())
+    programFailed = true;
+  programPending = false;
+}
+
 void DfuService::DfuImage::WriteMagicNumber() {
   uint32_t magic[4] = {
     // TODO When this variable is a static constexpr, the values written to the memory are not correct. Why?
@@ -401,24 +439,9 @@ void DfuService::DfuImage::Erase() {
 }
 
 bool DfuService::DfuImage::Validate() {
-  uint32_t chunkSize = 200;
-  size_t currentOffset = 0;
-  uint16_t crc = 0;
-
-  bool first = true;
-  while (currentOffset < totalSize) {
-    uint32_t readSize = (totalSize - currentOffset) > chunkSize ? chunkSize : (totalSize - currentOffset);
-
-    spiNorFlash.Read(writeOffset + currentOffset, tempBuffer, readSize);
-    if (first) {
-      crc = ComputeCrc(tempBuffer, readSize, NULL);
-      first = false;
-    } else
-      crc = ComputeCrc(tempBuffer, readSize, &crc);
-    currentOffset += readSize;
-  }
-
-  return (crc == expectedCrc);
+  // The CRC is computed as the data is received
+  WaitProgramCompleted();
+  return !programFailed && (receivedCrc == expectedCrc);
 }
 
 uint16_t DfuService::DfuImage::ComputeCrc(uint8_t const* p_data, uint32_t size, uint16_t const* p_crc) {
@@ -438,5 +461,5 @@ uint16_t DfuService::DfuImage::ComputeCrc(uint8_t const* p_data, uint32_t size,
 bool DfuService::DfuImage::IsComplete() {
   if (!ready)
     return false;
-  return totalWriteIndex == totalSize;
+  return totalReceived == totalSize;
 }
@@ -54,25 +54,34 @@ namespace Pinetime {
         DfuImage(Pinetime::Drivers::SpiNorFlash& spiNorFlash) : spiNorFlash {spiNorFlash} {
         }
 
-        void Init(size_t chunkSize, size_t totalSize, uint16_t expectedCrc);
+        void Init(size_t totalSize, uint16_t expectedCrc);
         void Erase();
-        void Append(uint8_t* data, size_t size);
+        void Append(const uint8_t* data, size_t size);
         bool Validate();
         bool IsComplete();
 
       private:
         Pinetime::Drivers::SpiNorFlash& spiNorFlash;
-        static constexpr size_t bufferSize = 200;
+        // The data is written to the flash one page at a time: a page is filled with the packets received while the
+        // other one is being programmed.
+        static constexpr size_t pageSize = 256;
         bool ready = false;
-        size_t chunkSize = 0;
         size_t totalSize = 0;
         size_t maxSize = 475136;
-        size_t bufferWriteIndex = 0;
+        size_t totalReceived = 0;
         size_t totalWriteIndex = 0;
         static constexpr size_t writeOffset = 0x40000;
-        uint8_t tempBuffer[bufferSize];
+        std::array<std::array<uint8_t, pageSize>, 2> pages;
+        uint8_t currentPage = 0;
+        size_t pageWriteIndex = 0;
+        bool programPending = false;
+        bool programFailed = false;
         uint16_t expectedCrc = 0;
+        // CRC of the data received so far
+        uint16_t receivedCrc = 0xFFFF;
 
+        void ProgramPage();
+        void WaitProgramCompleted();
         void WriteMagicNumber();
         uint16_t ComputeCrc(uint8_t const* p_data, uint32_t size, uint16_t const* p_crc);
       };
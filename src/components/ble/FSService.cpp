@@ -1,4 +1,5 @@
 #include <nrf_log.h>
+#include <nimble/nimble_port.h>
 #include "FSService.h"
 #include "components/ble/BleController.h"
 #include "systemtask/SystemTask.h"
@@ -8,6 +9,14 @@ using namespace Pinetime::Controllers;
 constexpr ble_uuid16_t FSService::fsServiceUuid;
 constexpr ble_uuid128_t FSService::fsVersionUuid;
 constexpr ble_uuid128_t FSService::fsTransferUuid;
+constexpr uint8_t FSService::maxWriteWindow;
+
+namespace {
+  void TransferTimeoutCallback(ble_npl_event* event) {
+    auto* fsService = static_cast<FSService*>(ble_npl_event_get_arg(event));
+    fsService->Reset();
+  }
+}
 
 int FSServiceCallback(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt* ctxt, void* arg) {
   auto* fsService = static_cast<FSService*>(arg);
@@ -26,7 +35,7 @@ FSService::FSService(Pinetime::System::SystemTask& systemTask, Pinetime::Control
                                 .uuid = &fsTransferUuid.u,
                                 .access_cb = FSServiceCallback,
                                 .arg = this,
-                                .flags = BLE_GATT_CHR_F_WRITE | BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_NOTIFY,
+                                .flags = BLE_GATT_CHR_F_WRITE | BLE_GATT_CHR_F_WRITE_NO_RSP | BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_NOTIFY,
                                 .val_handle = &transferCharacteristicHandle,
                               },
                               {0}},
@@ -46,6 +55,8 @@ void FSService::Init() {
 
   res = ble_gatts_add_svcs(serviceDefinition);
   ASSERT(res == 0);
+
+  ble_npl_callout_init(&transferTimeout, nimble_port_get_dflt_eventq(), TransferTimeoutCallback, this);
 }
 
 int FSService::OnFSServiceRequested(uint16_t connectionHandle, uint16_t attributeHandle, ble_gatt_access_ctxt* context) {
@@ -63,15 +74,16 @@ int FSService::OnFSServiceRequested(uint16_t connectionHandle, uint16_t attribut
 int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
   auto command = static_cast<commands>(om->om_data[0]);
   NRF_LOG_INFO("[FS_S] -> FSCommandHandler Command %d", command);
-  // Just always make sure we are awake...
-  systemTask.PushMessage(Pinetime::System::Messages::StartFileTransfer);
-  vTaskDelay(10);
-  while (systemTask.IsSleeping()) {
-    vTaskDelay(100); // 50ms
+  // Just always make sure we are awake... The system stays awake while a file is being read or written.
+  if (!readFileOpen && !writeFileOpen) {
+    systemTask.PushMessage(Pinetime::System::Messages::StartFileTransfer);
+    vTaskDelay(10);
+    while (systemTask.IsSleeping()) {
+      vTaskDelay(100); // 50ms
+    }
   }
   lfs_dir_t dir = {0};
   lfs_info info = {0};
-  lfs_file f = {0};
   switch (command) {
     case commands::READ: {
       NRF_LOG_INFO("[FS_S] -> Read");
@@ -80,68 +92,22 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
       if (plen > maxpathlen) { //> counts for null term
         return -1;
       }
+      CloseReadFile();
       memcpy(filepath, header->pathstr, plen);
       filepath[plen] = 0; // Copy and null terminate string
-      ReadResponse resp;
-      os_mbuf* om;
-      resp.command = commands::READ_DATA;
-      resp.status = 0x01;
-      resp.chunkoff = header->chunkoff;
-      int res = fs.Stat(filepath, &info);
-      if (res == LFS_ERR_NOENT && info.type != LFS_TYPE_DIR) {
-        resp.status = (int8_t) res;
-        resp.chunklen = 0;
-        resp.totallen = 0;
-        om = ble_hs_mbuf_from_flat(&resp, sizeof(ReadResponse));
-      } else {
-        resp.chunklen = std::min(header->chunksize, info.size); // TODO add mtu somehow
-        resp.totallen = info.size;
-        fs.FileOpen(&f, filepath, LFS_O_RDONLY);
-        fs.FileSeek(&f, header->chunkoff);
-        uint8_t fileData[resp.chunklen] = {0};
-        resp.chunklen = fs.FileRead(&f, fileData, resp.chunklen);
-        om = ble_hs_mbuf_from_flat(&resp, sizeof(ReadResponse));
-        os_mbuf_append(om, fileData, resp.chunklen);
-        fs.FileClose(&f);
-      }
-
-      ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
+      SendChunk(connectionHandle, header->chunkoff, header->chunksize);
       break;
     }
     case commands::READ_PACING: {
       NRF_LOG_INFO("[FS_S] -> Readpacing");
-      auto* header = (ReadHeader*) om->om_data;
-      ReadResponse resp;
-      resp.command = commands::READ_DATA;
-      resp.status = 0x01;
-      resp.chunkoff = header->chunkoff;
-      int res = fs.Stat(filepath, &info);
-      if (res == LFS_ERR_NOENT && info.type != LFS_TYPE_DIR) {
-        resp.status = (int8_t) res;
-        resp.chunklen = 0;
-        resp.totallen = 0;
-      } else {
-        resp.chunklen = std::min(header->chunksize, info.size); // TODO add mtu somehow
-        resp.totallen = info.size;
-        fs.FileOpen(&f, filepath, LFS_O_RDONLY);
-        fs.FileSeek(&f, header->chunkoff);
-      }
-      os_mbuf* om;
-      if (resp.chunklen > 0) {
-        uint8_t fileData[resp.chunklen] = {0};
-        resp.chunklen = fs.FileRead(&f, fileData, resp.chunklen);
-        om = ble_hs_mbuf_from_flat(&resp, sizeof(ReadResponse));
-        os_mbuf_append(om, fileData, resp.chunklen);
-      } else {
-        resp.chunklen = 0;
-        om = ble_hs_mbuf_from_flat(&resp, sizeof(ReadResponse));
-      }
-      fs.FileClose(&f);
-      ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
+      auto* header = (ReadPacing*) om->om_data;
+      SendChunk(connectionHandle, header->chunkoff, header->chunksize);
       break;
     }
     case commands::WRITE: {
       NRF_LOG_INFO("[FS_S] -> Write");
+      CloseReadFile();
+      CloseWriteFile();
       auto* header = (WriteHeader*) om->om_data;
       uint16_t plen = header->pathlen;
       if (plen > maxpathlen) { //> counts for null term
@@ -150,45 +116,54 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
       memcpy(filepath, header->pathstr, plen);
       filepath[plen] = 0; // Copy and null terminate string
       fileSize = header->totalSize;
-      WriteResponse resp;
-      resp.command = commands::WRITE_PACING;
-      resp.offset = header->offset;
-      resp.modTime = 0;
+      // The padding byte of the header is the number of packets the client wants to send per acknowledgment
+      writeWindow = std::max<uint8_t>(1, std::min<uint8_t>(header->padding, maxWriteWindow));
 
-      int res = fs.FileOpen(&f, filepath, LFS_O_RDWR | LFS_O_CREAT);
-      if (res == 0) {
-        fs.FileClose(&f);
-        resp.status = (res == 0) ? 0x01 : (int8_t) res;
+      int res = OpenWriteFile(header->offset);
+      if (res >= 0 && writeOffset >= static_cast<uint32_t>(fileSize)) {
+        res = CloseWriteFile(); // Nothing to receive
       }
-      resp.freespace = std::min(fs.getSize() - (fs.GetFSSize() * fs.getBlockSize()), fileSize - header->offset);
-      auto* om = ble_hs_mbuf_from_flat(&resp, sizeof(WriteResponse));
-      ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
+      SendWriteResponse(connectionHandle, res);
       break;
     }
     case commands::WRITE_DATA: {
       NRF_LOG_INFO("[FS_S] -> WriteData");
       auto* header = (WritePacing*) om->om_data;
-      WriteResponse resp;
-      resp.command = commands::WRITE_PACING;
-      resp.offset = header->offset;
-      int res = 0;
+      if (om->om_len < sizeof(WritePacing) || header->dataSize > om->om_len - sizeof(WritePacing)) {
+        return -1;
+      }
+      int res = OpenWriteFile(header->offset);
+      if (res >= 0 && header->offset != writeOffset) {
+        // A packet was lost: drop the following ones and tell the client once where to resume
+        if (!writeResumeRequested) {
+          writeResumeRequested = true;
+          SendWriteResponse(connectionHandle, res);
+        }
+        break;
+      }
+      writeResumeRequested = false;
+      if (res >= 0) {
+        res = BufferWriteData(header->data, header->dataSize);
+      }
+      packetsSinceAck++;
 
-      if (!(res = fs.FileOpen(&f, filepath, LFS_O_RDWR | LFS_O_CREAT))) {
-        if ((res = fs.FileSeek(&f, header->offset)) >= 0) {
-          res = fs.FileWrite(&f, header->data, header->dataSize);
+      const bool complete = writeOffset >= static_cast<uint32_t>(fileSize);
+      if (complete || res < 0) {
+        // Commit the file before the last acknowledgment
+        int closeRes = CloseWriteFile();
+        if (res >= 0) {
+          res = closeRes;
         }
-        fs.FileClose(&f);
       }
-      if (res < 0) {
-        resp.status = (int8_t) res;
+      if (complete || res < 0 || packetsSinceAck >= writeWindow) {
+        SendWriteResponse(connectionHandle, res);
       }
-      resp.freespace = std::min(fs.getSize() - (fs.GetFSSize() * fs.getBlockSize()), fileSize - header->offset);
-      auto* om = ble_hs_mbuf_from_flat(&resp, sizeof(WriteResponse));
-      ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
       break;
     }
     case commands::DELETE: {
       NRF_LOG_INFO("[FS_S] -> Delete");
+      CloseReadFile();
+      CloseWriteFile();
       auto* header = (DelHeader*) om->om_data;
       uint16_t plen = header->pathlen;
       char path[plen + 1] = {0};
@@ -284,6 +259,8 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
     }
     case commands::MOVE: {
       NRF_LOG_INFO("[FS_S] -> Move");
+      CloseReadFile();
+      CloseWriteFile();
       MoveHeader* header = (MoveHeader*) om->om_data;
       uint16_t plen = header->OldPathLength;
       // Null Terminate string
@@ -302,29 +279,223 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
       break;
   }
   NRF_LOG_INFO("[FS_S] -> done ");
-  systemTask.PushMessage(Pinetime::System::Messages::StopFileTransfer);
+  if (!readFileOpen && !writeFileOpen) {
+    ble_npl_callout_stop(&transferTimeout);
+    systemTask.PushMessage(Pinetime::System::Messages::StopFileTransfer);
+  } else {
+    ble_npl_callout_reset(&transferTimeout, ble_npl_time_ms_to_ticks32(transferTimeoutMs));
+  }
+  return 0;
+}
+
+void FSService::Reset() {
+  const bool transferInProgress = readFileOpen || writeFileOpen;
+  ble_npl_callout_stop(&transferTimeout);
+  CloseReadFile();
+  CloseWriteFile();
+  if (transferInProgress) {
+    systemTask.PushMessage(Pinetime::System::Messages::StopFileTransfer);
+  }
+}
+
+int FSService::OpenWriteFile(uint32_t offset) {
+  if (!writeFileOpen) {
+    // Set first so that the error response of a failed open reports the offset requested by the client
+    writeOffset = offset;
+    int res = fs.FileOpen(&writeFile, filepath, LFS_O_WRONLY | LFS_O_CREAT);
+    if (res < 0) {
+      return res;
+    }
+    writeFileOpen = true;
+    writeBufferOffset = offset;
+    writeBufferLength = 0;
+    packetsSinceAck = 0;
+    writeResumeRequested = false;
+    return fs.FileSeek(&writeFile, offset);
+  }
   return 0;
 }
 
-// Loads resp with file data given a valid filepath header and resp
-void FSService::prepareReadDataResp(ReadHeader* header, ReadResponse* resp) {
-  // uint16_t plen = header->pathlen;
-  resp->command = commands::READ_DATA;
-  resp->chunkoff = header->chunkoff;
-  resp->status = 0x01;
-  struct lfs_info info = {};
+int FSService::CloseWriteFile() {
+  if (!writeFileOpen) {
+    return 0;
+  }
+  int res = FlushWriteBuffer();
+  int closeRes = fs.FileClose(&writeFile);
+  writeFileOpen = false;
+  return (res < 0) ? res : closeRes;
+}
+
+// Adds the data received at writeOffset to the write buffer, which is written to the file when it reaches a multiple
+// of writeBuffer.size()
+int FSService::BufferWriteData(const uint8_t* data, uint32_t size) {
+  while (size > 0) {
+    const uint32_t blockEnd = (writeBufferOffset / writeBuffer.size() + 1) * writeBuffer.size();
+    const uint32_t length = std::min(size, blockEnd - writeOffset);
+    memcpy(writeBuffer.data() + writeBufferLength, data, length);
+    writeBufferLength += length;
+    writeOffset += length;
+    data += length;
+    size -= length;
+    if (writeOffset == blockEnd) {
+      int res = FlushWriteBuffer();
+      if (res < 0) {
+        return res;
+      }
+    }
+  }
+  return 0;
+}
+
+int FSService::FlushWriteBuffer() {
+  int res = 0;
+  if (writeBufferLength > 0) {
+    res = fs.FileWrite(&writeFile, writeBuffer.data(), writeBufferLength);
+  }
+  writeBufferOffset = writeOffset;
+  writeBufferLength = 0;
+  return res;
+}
+
+void FSService::SendWriteResponse(uint16_t connectionHandle, int res) {
+  WriteResponse resp;
+  resp.command = commands::WRITE_PACING;
+  resp.status = (res < 0) ? (int8_t) res : 0x01;
+  resp.credits = (res < 0) ? 0 : writeWindow;
+  resp.offset = writeOffset;
+  resp.modTime = 0;
+  const uint32_t remaining = (writeOffset < static_cast<uint32_t>(fileSize)) ? fileSize - writeOffset : 0;
+  resp.freespace = std::min<uint32_t>(fs.getSize() - (fs.GetFSSize() * fs.getBlockSize()), remaining);
+  packetsSinceAck = 0;
+  auto* om = ble_hs_mbuf_from_flat(&resp, sizeof(WriteResponse));
+  ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
+}
+
+int FSService::OpenReadFile() {
+  if (readFileOpen) {
+    return 0;
+  }
+  lfs_info info = {0};
   int res = fs.Stat(filepath, &info);
-  if (res == LFS_ERR_NOENT && info.type != LFS_TYPE_DIR) {
-    resp->status = 0x03;
-    resp->chunklen = 0;
-    resp->totallen = 0;
+  if (res < 0) {
+    return res;
+  }
+  res = fs.FileOpen(&readFile, filepath, LFS_O_RDONLY);
+  if (res < 0) {
+    return res;
+  }
+  readFileOpen = true;
+  readFileSize = info.size;
+  readFilePosition = 0;
+  return 0;
+}
+
+void FSService::CloseReadFile() {
+  if (prefetchedChunk != nullptr) {
+    os_mbuf_free_chain(prefetchedChunk);
+    prefetchedChunk = nullptr;
+  }
+  if (readFileOpen) {
+    fs.FileClose(&readFile);
+    readFileOpen = false;
+  }
+}
+
+// Returns a READ_DATA notification for the chunk at offset, the file data being read directly into the mbuf
+os_mbuf* FSService::ReadChunk(uint16_t connectionHandle, uint32_t offset, uint32_t size) {
+  ReadResponse resp;
+  resp.command = commands::READ_DATA;
+  resp.status = 0x01;
+  resp.padding = 0;
+  resp.chunkoff = offset;
+  resp.totallen = 0;
+  resp.chunklen = 0;
+
+  int res = OpenReadFile();
+  if (res < 0) {
+    resp.status = (int8_t) res;
+    return ble_hs_mbuf_from_flat(&resp, sizeof(ReadResponse));
+  }
+  resp.totallen = readFileSize;
+
+  // The notification (ATT header included) must fit in the MTU
+  const uint16_t mtu = ble_att_mtu(connectionHandle);
+  const uint32_t maxChunkSize = (mtu > 3 + sizeof(ReadResponse)) ? mtu - 3 - sizeof(ReadResponse) : 0;
+  const uint32_t remaining = (offset < readFileSize) ? readFileSize - offset : 0;
+  uint32_t chunkSize = std::min(std::min(size, remaining), maxChunkSize);
+
+  os_mbuf* om = ble_hs_mbuf_att_pkt();
+  if (om == nullptr) {
+    return nullptr;
+  }
+  if (os_mbuf_append(om, &resp, sizeof(ReadResponse)) != 0) {
+    os_mbuf_free_chain(om);
+    return nullptr;
+  }
+  if (chunkSize > 0) {
+    auto* chunk = static_cast<uint8_t*>(os_mbuf_extend(om, chunkSize));
+    if (chunk == nullptr) {
+      os_mbuf_free_chain(om);
+      return nullptr;
+    }
+    if (readFilePosition != offset) {
+      res = fs.FileSeek(&readFile, offset);
+    }
+    if (res >= 0) {
+      res = fs.FileRead(&readFile, chunk, chunkSize);
+    }
+    if (res < 0) {
+      resp.status = (int8_t) res;
+      readFilePosition = UINT32_MAX;
+      os_mbuf_adj(om, -static_cast<int>(chunkSize));
+    } else {
+      resp.chunklen = res;
+      readFilePosition = offset + res;
+      os_mbuf_adj(om, -static_cast<int>(chunkSize - res));
+    }
+    os_mbuf_copyinto(om, 0, &resp, sizeof(ReadResponse));
+  }
+  return om;
+}
+
+// Sends the chunk requested by READ or READ_PACING and reads the next one while it is being transmitted
+void FSService::SendChunk(uint16_t connectionHandle, uint32_t offset, uint32_t size) {
+  os_mbuf* om;
+  if (prefetchedChunk != nullptr && prefetchedOffset == offset && prefetchedSize == size) {
+    om = prefetchedChunk;
   } else {
-    lfs_file f;
-    resp->chunklen = std::min(header->chunksize, info.size);
-    resp->totallen = info.size;
-    fs.FileOpen(&f, filepath, LFS_O_RDONLY);
-    fs.FileSeek(&f, header->chunkoff);
-    resp->chunklen = fs.FileRead(&f, resp->chunk, resp->chunklen);
-    fs.FileClose(&f);
+    if (prefetchedChunk != nullptr) {
+      os_mbuf_free_chain(prefetchedChunk);
+    }
+    om = ReadChunk(connectionHandle, offset, size);
+  }
+  prefetchedChunk = nullptr;
+  if (om == nullptr) {
+    // Out of mbufs: report the error with a response without data and end the transfer
+    ReadResponse resp;
+    resp.command = commands::READ_DATA;
+    resp.status = (int8_t) LFS_ERR_NOMEM;
+    resp.padding = 0;
+    resp.chunkoff = offset;
+    resp.totallen = readFileOpen ? readFileSize : 0;
+    resp.chunklen = 0;
+    CloseReadFile();
+    om = ble_hs_mbuf_from_flat(&resp, sizeof(ReadResponse));
+    ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
+    return;
+  }
+
+  ReadResponse resp;
+  os_mbuf_copydata(om, 0, sizeof(ReadResponse), &resp);
+  ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
+
+  const uint32_t nextOffset = resp.chunkoff + resp.chunklen;
+  if (resp.status != 0x01 || resp.chunklen == 0 || nextOffset >= resp.totallen) {
+    // Error or end of file: the phone does not need the file anymore
+    CloseReadFile();
+    return;
   }
+  prefetchedChunk = ReadChunk(connectionHandle, nextOffset, size);
+  prefetchedOffset = nextOffset;
+  prefetchedSize = size;
 }
@@ -5,6 +5,7 @@
 #undef max
 #undef min
 
+#include <array>
 #include "components/fs/FS.h"
 
 namespace Pinetime {
@@ -22,6 +23,8 @@ namespace Pinetime {
 
       int OnFSServiceRequested(uint16_t connectionHandle, uint16_t attributeHandle, ble_gatt_access_ctxt* context);
       void NotifyFSRaw(uint16_t connectionHandle);
+      // Closes the files being transferred, called when the connection is lost or the transfer is abandoned
+      void Reset();
 
     private:
       Pinetime::System::SystemTask& systemTask;
@@ -114,7 +117,7 @@ namespace Pinetime {
       using WriteResponse = struct __attribute__((packed)) {
         commands command;
         uint8_t status;
-        uint16_t padding;
+        uint16_t credits;
         uint32_t offset;
         uint64_t modTime;
         uint32_t freespace;
@@ -190,8 +193,44 @@ namespace Pinetime {
         uint8_t status;
       };
 
+      // File being read by READ/READ_PACING, kept open between the chunks
+      lfs_file_t readFile;
+      bool readFileOpen = false;
+      uint32_t readFileSize = 0;
+      uint32_t readFilePosition = 0;
+      // Response for the next chunk, read from the flash while the previous one is being sent
+      os_mbuf* prefetchedChunk = nullptr;
+      uint32_t prefetchedOffset = 0;
+      uint32_t prefetchedSize = 0;
+
+      // File being written by WRITE/WRITE_DATA, kept open until all the data is received
+      static constexpr uint8_t maxWriteWindow = 16;
+      lfs_file_t writeFile;
+      bool writeFileOpen = false;
+      uint32_t writeOffset = 0;
+      uint8_t writeWindow = 1;
+      uint8_t packetsSinceAck = 0;
+      // A response was sent for a packet received out of order, the following ones are dropped until the client resumes
+      bool writeResumeRequested = false;
+      // Data received since the last write to the file, covering [writeBufferOffset, writeOffset)
+      std::array<uint8_t, 512> writeBuffer;
+      uint32_t writeBufferOffset = 0;
+      size_t writeBufferLength = 0;
+
+      // Calls Reset() from the NimBLE host task when the phone sends no command for a transfer in progress
+      static constexpr uint32_t transferTimeoutMs = 10000;
+      ble_npl_callout transferTimeout;
+
       int FSCommandHandler(uint16_t connectionHandle, os_mbuf* om);
-      void prepareReadDataResp(ReadHeader* header, ReadResponse* resp);
+      int OpenReadFile();
+      void CloseReadFile();
+      os_mbuf* ReadChunk(uint16_t connectionHandle, uint32_t offset, uint32_t size);
+      void SendChunk(uint16_t connectionHandle, uint32_t offset, uint32_t size);
+      int OpenWriteFile(uint32_t offset);
+      int CloseWriteFile();
+      int BufferWriteData(const uint8_t* data, uint32_t size);
+      int FlushWriteBuffer();
+      void SendWriteResponse(uint16_t connectionHandle, int res);
     };
   }
 }
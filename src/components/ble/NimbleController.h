@@ -12,6 +12,7 @@
 #include "components/ble/BatteryInformationService.h"
 #include "components/ble/CurrentTimeClient.h"
 #include "components/ble/CurrentTimeService.h"
+#include "components/ble/DebugService.h"
 #include "components/ble/DeviceInformationService.h"
 #include "components/ble/DfuService.h"
 #include "components/ble/FSService.h"
@@ -26,6 +27,7 @@
 
 namespace Pinetime {
   namespace Drivers {
+    class SpiMaster;
     class SpiNorFlash;
   }
 
@@ -49,7 +51,9 @@ namespace Pinetime {
                        Pinetime::Drivers::SpiNorFlash& spiNorFlash,
                        HeartRateController& heartRateController,
                        MotionController& motionController,
-                       FS& fs);
+                       FS& fs,
+                       FrameProfiler& frameProfiler,
+                       Pinetime::Drivers::SpiMaster& spi);
       void Init();
       void StartAdvertising();
       int OnGAPEvent(ble_gap_event* event);
@@ -106,6 +110,7 @@ namespace Pinetime {
       HeartRateService heartRateService;
       MotionService motionService;
       FSService fsService;
+      DebugService debugService;
       ServiceDiscovery serviceDiscovery;
 
       uint8_t addrType;
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+
+namespace Pinetime {
+  namespace Controllers {
+    // Incremental update of a broken-down time.
+    //
+    // The local time of the watch has no daylight saving rules (TZ is not set, newlib's localtime() behaves as
+    // gmtime()): the DST offset received over BLE is already included in the time set by the companion app. A
+    // broken-down time converted once by localtime() can therefore be advanced by adding the elapsed seconds to its
+    // fields and carrying them into the minutes, hours, day, month and year, keeping tm_wday and tm_yday in step.
+    struct BrokenDownTime {
+      // Fields that changed during an update
+      enum Changes : uint8_t { None = 0, Second = 1 << 0, Minute = 1 << 1, Hour = 1 << 2, Day = 1 << 3, All = 0x0f };
+
+      static constexpr bool IsLeapYear(int year) {
+        return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+      }
+
+      // month in [0, 11], as tm_mon
+      static constexpr int DaysInMonth(int year, int month) {
+        return (month == 1) ? (IsLeapYear(year) ? 29 : 28) : ((month == 3 || month == 5 || month == 8 || month == 10) ? 30 : 31);
+      }
+
+      // Adds the given number of seconds to tm, returns the Changes of its fields
+      static uint8_t Advance(std::tm& tm, uint32_t seconds) {
+        if (seconds == 0) {
+          return None;
+        }
+        uint8_t changes = Second;
+        uint32_t total = tm.tm_sec + seconds;
+        tm.tm_sec = total % 60;
+        uint32_t carry = total / 60;
+        if (carry == 0) {
+          return changes;
+        }
+
+        changes |= Minute;
+        total = tm.tm_min + carry;
+        tm.tm_min = total % 60;
+        carry = total / 60;
+        if (carry == 0) {
+          return changes;
+        }
+
+        changes |= Hour;
+        total = tm.tm_hour + carry;
+        tm.tm_hour = total % 24;
+        carry = total / 24;
+        if (carry == 0) {
+          return changes;
+        }
+
+        changes |= Day;
+        tm.tm_wday = (tm.tm_wday + carry) % 7;
+        // Month by month, a long sleep being the only way to skip more than one day
+        while (carry > 0) {
+          const uint32_t daysLeftInMonth = DaysInMonth(tm.tm_year + 1900, tm.tm_mon) - tm.tm_mday;
+          if (carry <= daysLeftInMonth) {
+            tm.tm_mday += carry;
+            tm.tm_yday += carry;
+            break;
+          }
+          carry -= daysLeftInMonth + 1;
+          tm.tm_mday = 1;
+          tm.tm_yday += daysLeftInMonth + 1;
+          if (++tm.tm_mon == 12) {
+            tm.tm_mon = 0;
+            tm.tm_year++;
+            tm.tm_yday = 0;
+          }
+        }
+        return changes;
+      }
+    };
+  }
+}
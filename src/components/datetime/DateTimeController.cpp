@@ -1,6 +1,7 @@
 #include "components/datetime/DateTimeController.h"
 #include <libraries/log/nrf_log.h>
 #include <systemtask/SystemTask.h>
+#include <algorithm>
 
 using namespace Pinetime::Controllers;
 
@@ -9,13 +10,21 @@ namespace {
   char const* DaysStringShortLow[] = {"--", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun"};
   char const* MonthsString[] = {"--", "JAN", "FEB", "MAR", "APR", "MAY", "JUN", "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"};
   char const* MonthsStringLow[] = {"--", "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+  void TimeEventTimerCallback(TimerHandle_t xTimer) {
+    auto* systemTask = static_cast<Pinetime::System::SystemTask*>(pvTimerGetTimerID(xTimer));
+    // The events are emitted by UpdateTime(), called by SystemTask after each message
+    systemTask->PushMessage(Pinetime::System::Messages::TimeEventTimerExpired);
+  }
 }
 
 DateTime::DateTime(Controllers::Settings& settingsController) : settingsController {settingsController} {
+  ConvertTime();
 }
 
 void DateTime::SetCurrentTime(std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> t) {
   this->currentDateTime = t;
+  ConvertTime();
   UpdateTime(previousSystickCounter); // Update internal state without updating the time
 }
 
@@ -35,6 +44,7 @@ void DateTime::SetTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour,
   NRF_LOG_INFO("%d %d %d ", day, month, year);
   NRF_LOG_INFO("%d %d %d ", hour, minute, second);
 
+  ConvertTime();
   UpdateTime(previousSystickCounter);
 
   systemTask->PushMessage(System::Messages::OnNewTime);
@@ -43,6 +53,54 @@ void DateTime::SetTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour,
 void DateTime::SetTimeZone(int8_t timezone, int8_t dst) {
   tzOffset = timezone;
   dstOffset = dst;
+  // Sent by the companion app along with the time, resynchronizes the fields as the setters of the time do
+  ConvertTime();
+}
+
+void DateTime::ConvertTime() {
+  std::time_t currentTime = std::chrono::system_clock::to_time_t(currentDateTime);
+  localTime = *std::localtime(&currentTime);
+  CountChanges(BrokenDownTime::All);
+  // The next boundary moved with the time
+  if (timeEventTimer != nullptr) {
+    ScheduleTimeEvent(previousSystickCounter);
+  }
+}
+
+void DateTime::CountChanges(uint8_t changes) {
+  if (changes & BrokenDownTime::Second) {
+    secondChanges++;
+  }
+  if (changes & BrokenDownTime::Minute) {
+    minuteChanges++;
+  }
+  if (changes & BrokenDownTime::Hour) {
+    hourChanges++;
+  }
+  if (changes & BrokenDownTime::Day) {
+    dayChanges++;
+  }
+}
+
+uint8_t DateTime::CheckChanges(Subscription& subscription) const {
+  uint8_t changes = BrokenDownTime::None;
+  if (subscription.seconds != secondChanges) {
+    subscription.seconds = secondChanges;
+    changes |= BrokenDownTime::Second;
+  }
+  if (subscription.minutes != minuteChanges) {
+    subscription.minutes = minuteChanges;
+    changes |= BrokenDownTime::Minute;
+  }
+  if (subscription.hours != hourChanges) {
+    subscription.hours = hourChanges;
+    changes |= BrokenDownTime::Hour;
+  }
+  if (subscription.days != dayChanges) {
+    subscription.days = dayChanges;
+    changes |= BrokenDownTime::Day;
+  }
+  return changes;
 }
 
 void DateTime::UpdateTime(uint32_t systickCounter) {
@@ -69,40 +127,52 @@ void DateTime::UpdateTime(uint32_t systickCounter) {
   currentDateTime += std::chrono::seconds(correctedDelta);
   uptime += std::chrono::seconds(correctedDelta);
 
-  std::time_t currentTime = std::chrono::system_clock::to_time_t(currentDateTime);
-  localTime = *std::localtime(&currentTime);
+  const uint8_t previousMinute = localTime.tm_min;
+  const uint8_t changes = BrokenDownTime::Advance(localTime, correctedDelta);
+  CountChanges(changes);
+  NotifyTimeEvents(changes, previousMinute);
 
-  auto minute = Minutes();
-  auto hour = Hours();
-
-  if (minute == 0 && !isHourAlreadyNotified) {
-    isHourAlreadyNotified = true;
-    if (systemTask != nullptr) {
-      systemTask->PushMessage(System::Messages::OnNewHour);
-    }
-  } else if (minute != 0) {
-    isHourAlreadyNotified = false;
+  // Expired (or not started yet): program the next boundary
+  if (timeEventTimer != nullptr && xTimerIsTimerActive(timeEventTimer) == pdFALSE) {
+    ScheduleTimeEvent(systickCounter);
   }
+}
 
-  if ((minute == 0 || minute == 30) && !isHalfHourAlreadyNotified) {
-    isHalfHourAlreadyNotified = true;
-    if (systemTask != nullptr) {
-      systemTask->PushMessage(System::Messages::OnNewHalfHour);
-    }
-  } else if (minute != 0 && minute != 30) {
-    isHalfHourAlreadyNotified = false;
+void DateTime::NotifyTimeEvents(uint8_t changes, uint8_t previousMinute) {
+  if (systemTask == nullptr) {
+    return;
   }
-
-  // Notify new day to SystemTask
-  if (hour == 0 and not isMidnightAlreadyNotified) {
-    isMidnightAlreadyNotified = true;
-    if (systemTask != nullptr)
-      systemTask->PushMessage(System::Messages::OnNewDay);
-  } else if (hour != 0) {
-    isMidnightAlreadyNotified = false;
+  // Emitted when a boundary is crossed by the time, not when the time is set
+  if (changes & BrokenDownTime::Hour) {
+    systemTask->PushMessage(System::Messages::OnNewHour);
+  }
+  if ((changes & BrokenDownTime::Hour) || (previousMinute < 30) != (Minutes() < 30)) {
+    systemTask->PushMessage(System::Messages::OnNewHalfHour);
+  }
+  if (changes & BrokenDownTime::Day) {
+    systemTask->PushMessage(System::Messages::OnNewDay);
   }
 }
 
+void DateTime::ScheduleTimeEvent(uint32_t systickCounter) {
+  uint32_t secondsToNextHalfHour = (30 - Minutes() % 30) * 60 - Seconds();
+  // The period of a timer can't be 0. If the timer expires early, UpdateTime() programs it again.
+  TickType_t ticks = std::max<uint32_t>(TicksUntil(systickCounter, secondsToNextHalfHour), 1);
+  xTimerChangePeriod(timeEventTimer, ticks, 0);
+}
+
+uint32_t DateTime::TicksToNextSecond(uint32_t systickCounter) const {
+  // previousSystickCounter is aligned on the last second boundary seen by UpdateTime()
+  uint32_t systickDelta = (systickCounter - previousSystickCounter) & 0xffffff;
+  return 1024 - (systickDelta % 1024);
+}
+
+uint32_t DateTime::TicksUntil(uint32_t systickCounter, uint32_t seconds) const {
+  uint32_t systickDelta = (systickCounter - previousSystickCounter) & 0xffffff;
+  uint32_t ticks = seconds * 1024;
+  return (ticks > systickDelta) ? ticks - systickDelta : 0;
+}
+
 const char* DateTime::MonthShortToString() const {
   return MonthsString[static_cast<uint8_t>(Month())];
 }
@@ -121,6 +191,8 @@ const char* DateTime::DayOfWeekShortToStringLow() const {
 
 void DateTime::Register(Pinetime::System::SystemTask* systemTask) {
   this->systemTask = systemTask;
+  timeEventTimer = xTimerCreate("timeEvent", 1, pdFALSE, systemTask, TimeEventTimerCallback);
+  ScheduleTimeEvent(previousSystickCounter);
 }
 
 using ClockType = Pinetime::Controllers::Settings::ClockType;
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <FreeRTOS.h>
+#include <timers.h>
 #include <cstdint>
 #include <chrono>
 #include <ctime>
 #include <string>
+#include "components/datetime/BrokenDownTime.h"
 #include "components/settings/Settings.h"
 
 namespace Pinetime {
@@ -47,6 +50,24 @@ namespace Pinetime {
 
       void UpdateTime(uint32_t systickCounter);
 
+      /*
+       * Number of changes of each field seen by a subscriber (a watch face), compared by CheckChanges() with the
+       * number of changes counted by UpdateTime() and by the setters, which count as a change of all the fields.
+       */
+      class Subscription {
+      private:
+        uint32_t seconds = 0;
+        uint32_t minutes = 0;
+        uint32_t hours = 0;
+        uint32_t days = 0;
+        friend class DateTime;
+      };
+
+      /*
+       * returns the BrokenDownTime::Changes of the fields since the previous call with the same subscription
+       */
+      uint8_t CheckChanges(Subscription& subscription) const;
+
       uint16_t Year() const {
         return 1900 + localTime.tm_year;
       }
@@ -136,11 +157,24 @@ namespace Pinetime {
         return uptime;
       }
 
+      /*
+       * Number of RTC ticks (1024Hz) left before CurrentDateTime() moves on to the next second, given the current
+       * value of the RTC counter.
+       */
+      uint32_t TicksToNextSecond(uint32_t systickCounter) const;
+
+      /*
+       * Number of RTC ticks left before CurrentDateTime() reaches CurrentDateTime() + seconds, given the current value
+       * of the RTC counter. Used to program the timers of the time events and of the alarm.
+       */
+      uint32_t TicksUntil(uint32_t systickCounter, uint32_t seconds) const;
+
       void Register(System::SystemTask* systemTask);
       void SetCurrentTime(std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> t);
       std::string FormattedTime();
 
     private:
+      // Converted from currentDateTime by the setters, then advanced by UpdateTime()
       std::tm localTime;
       int8_t tzOffset = 0;
       int8_t dstOffset = 0;
@@ -149,10 +183,19 @@ namespace Pinetime {
       std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> currentDateTime;
       std::chrono::seconds uptime {0};
 
-      bool isMidnightAlreadyNotified = false;
-      bool isHourAlreadyNotified = true;
-      bool isHalfHourAlreadyNotified = true;
+      uint32_t secondChanges = 0;
+      uint32_t minuteChanges = 0;
+      uint32_t hourChanges = 0;
+      uint32_t dayChanges = 0;
+
+      void ConvertTime();
+      void CountChanges(uint8_t changes);
+      void NotifyTimeEvents(uint8_t changes, uint8_t previousMinute);
+      void ScheduleTimeEvent(uint32_t systickCounter);
+
       System::SystemTask* systemTask = nullptr;
+      // One-shot timer expiring on the next half hour boundary (hours and days start on half hours too)
+      TimerHandle_t timeEventTimer = nullptr;
       Controllers::Settings& settingsController;
     };
   }
@@ -0,0 +1,118 @@
+#include "components/frameprofiler/FrameProfiler.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include <nrf.h>
+#include <hal/nrf_rtc.h>
+
+using namespace Pinetime::Controllers;
+
+namespace {
+  // DWT->CYCCNT counts at the CPU clock (64MHz)
+  constexpr uint32_t cyclesPerUs = 64;
+  // RTC1 (the FreeRTOS tick) is a 24 bits counter at 1024Hz
+  constexpr uint32_t rtcMask = 0x00ffffff;
+
+  constexpr uint32_t RtcTicksToUs(uint32_t ticks) {
+    return static_cast<uint32_t>((static_cast<uint64_t>(ticks) * 1000000) / 1024);
+  }
+
+  void Put16(uint8_t*& buffer, uint16_t value) {
+    *buffer++ = static_cast<uint8_t>(value);
+    *buffer++ = static_cast<uint8_t>(value >> 8u);
+  }
+
+  void Put32(uint8_t*& buffer, uint32_t value) {
+    Put16(buffer, static_cast<uint16_t>(value));
+    Put16(buffer, static_cast<uint16_t>(value >> 16u));
+  }
+}
+
+void FrameProfiler::Init() {
+  // The cycle counter only runs when it is enabled (a debugger usually does it)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+void FrameProfiler::BeginFrame() {
+  current = {};
+  current.timestamp = xTaskGetTickCount();
+  waitCycles = 0;
+  waitRtcTicks = 0;
+  frameStartCycles = DWT->CYCCNT;
+}
+
+void FrameProfiler::EndFrame() {
+  if (current.areas == 0) {
+    return;
+  }
+  uint32_t elapsedCycles = DWT->CYCCNT - frameStartCycles;
+  // The cycles counted during the waits are the ones of the other tasks, the rest is the CPU time of the frame
+  current.renderTime = (elapsedCycles - waitCycles) / cyclesPerUs;
+  current.waitTime = RtcTicksToUs(waitRtcTicks);
+
+  taskENTER_CRITICAL();
+  frames[head] = current;
+  head = (head + 1) % nbFrames;
+  if (count < nbFrames) {
+    count++;
+  }
+  totalFrames++;
+  totalBytes += current.bytes;
+  taskEXIT_CRITICAL();
+}
+
+void FrameProfiler::OnFlush(uint32_t pixels) {
+  current.areas++;
+  current.pixels += pixels;
+}
+
+void FrameProfiler::OnDrawBuffer(uint32_t bytes) {
+  current.drawCalls++;
+  current.bytes += bytes;
+}
+
+FrameProfiler::WaitStart FrameProfiler::StartWaiting() const {
+  return {DWT->CYCCNT, nrf_rtc_counter_get(portNRF_RTC_REG)};
+}
+
+void FrameProfiler::EndWaiting(const WaitStart& start) {
+  waitCycles += DWT->CYCCNT - start.cycles;
+  waitRtcTicks += (nrf_rtc_counter_get(portNRF_RTC_REG) - start.rtcTicks) & rtcMask;
+}
+
+uint8_t FrameProfiler::GetFrames(Frame* destination, uint8_t maxFrames) const {
+  taskENTER_CRITICAL();
+  uint8_t nb = (count < maxFrames) ? count : maxFrames;
+  uint8_t first = (head + nbFrames - nb) % nbFrames;
+  for (uint8_t i = 0; i < nb; i++) {
+    destination[i] = frames[(first + i) % nbFrames];
+  }
+  taskEXIT_CRITICAL();
+  return nb;
+}
+
+size_t FrameProfiler::Serialize(uint8_t* buffer, size_t size) const {
+  if (size < serializedSize) {
+    return 0;
+  }
+
+  uint8_t* ptr = buffer;
+  taskENTER_CRITICAL();
+  *ptr++ = 1; // version
+  *ptr++ = count;
+  Put16(ptr, 0);
+  Put32(ptr, totalFrames);
+  uint8_t first = (head + nbFrames - count) % nbFrames;
+  for (uint8_t i = 0; i < count; i++) {
+    const Frame& frame = frames[(first + i) % nbFrames];
+    Put32(ptr, frame.timestamp);
+    Put32(ptr, frame.pixels);
+    Put32(ptr, frame.bytes);
+    Put32(ptr, frame.renderTime);
+    Put32(ptr, frame.waitTime);
+    Put16(ptr, frame.areas);
+    Put16(ptr, frame.drawCalls);
+  }
+  taskEXIT_CRITICAL();
+  return ptr - buffer;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Pinetime {
+  namespace Controllers {
+
+    // Records, for each call to lv_task_handler() that redraws something, how much data is sent to the LCD
+    // and how long it takes. The last nbFrames records are kept in a ring buffer that can be read by the
+    // debug BLE service and by the simulator.
+    //
+    // The core sleeps while DisplayApp waits for the SPI transfers, and DWT->CYCCNT stops with it: the waits are timed
+    // with the RTC, which keeps running (1024Hz, so each wait is rounded to ~1ms), and the cycle counter only measures
+    // the time the CPU spends rendering.
+    class FrameProfiler {
+    public:
+      struct Frame {
+        uint32_t timestamp;  // tick count at the beginning of the frame
+        uint32_t pixels;     // pixels rendered by LVGL (sum of the areas flushed)
+        uint32_t bytes;      // bytes sent to the LCD
+        uint32_t renderTime; // us of CPU time in lv_task_handler() (DWT->CYCCNT), excluding the waits for the SPI transfers
+        uint32_t waitTime;   // us spent waiting for the SPI transfers to complete (RTC)
+        uint16_t areas;      // number of areas flushed
+        uint16_t drawCalls;  // calls to St7789::DrawBuffer() (an area wrapping around the frame memory needs 2)
+      };
+
+      static constexpr uint8_t nbFrames = 20;
+      // Size of the buffer needed by Serialize()
+      static constexpr size_t serializedSize = 8 + nbFrames * 24;
+
+      void Init();
+
+      void BeginFrame();
+      void EndFrame();
+
+      void OnFlush(uint32_t pixels);
+      void OnDrawBuffer(uint32_t bytes);
+
+      // Beginning of a wait, read from both clocks
+      struct WaitStart {
+        uint32_t cycles;
+        uint32_t rtcTicks;
+      };
+
+      WaitStart StartWaiting() const;
+      void EndWaiting(const WaitStart& start);
+
+      // Copies the records (oldest first) into frames and returns how many were copied.
+      uint8_t GetFrames(Frame* frames, uint8_t maxFrames) const;
+
+      uint32_t TotalFrames() const {
+        return totalFrames;
+      }
+
+      uint32_t TotalBytes() const {
+        return totalBytes;
+      }
+
+      // Writes the totals and the records (oldest first) in little endian:
+      // u8 version, u8 nb records, u16 reserved, u32 total frames, then nb records of 24 bytes (same layout as Frame).
+      size_t Serialize(uint8_t* buffer, size_t size) const;
+
+    private:
+      Frame frames[nbFrames];
+      uint8_t head = 0;
+      uint8_t count = 0;
+
+      Frame current = {};
+      uint32_t frameStartCycles = 0;
+      uint32_t waitCycles = 0;
+      uint32_t waitRtcTicks = 0;
+
+      uint32_t totalFrames = 0;
+      uint32_t totalBytes = 0;
+    };
+  }
+}
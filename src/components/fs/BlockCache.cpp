@@ -0,0 +1,141 @@
+#include "components/fs/BlockCache.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace Pinetime::Controllers;
+
+BlockCache::BlockCache(Pinetime::Drivers::SpiNorFlash& flashDriver) : flashDriver {flashDriver} {
+}
+
+bool BlockCache::Read(uint32_t address, uint8_t* buffer, size_t size) {
+  bool ok = true;
+  while (size > 0) {
+    const uint32_t pageAddress = address & ~(pageSize - 1u);
+    const size_t offset = address - pageAddress;
+    const size_t length = std::min(size, pageSize - offset);
+
+    Page* page = Find(pageAddress);
+    if (page != nullptr) {
+      statistics.hits++;
+    } else if (length == pageSize) {
+      // Whole page not cached: read it directly, with the next whole pages that are not cached either
+      size_t bypassLength = pageSize;
+      while (bypassLength + pageSize <= size && Find(pageAddress + bypassLength) == nullptr) {
+        bypassLength += pageSize;
+      }
+      flashDriver.Read(address, buffer, bypassLength);
+      statistics.bypassed += bypassLength / pageSize;
+      address += bypassLength;
+      buffer += bypassLength;
+      size -= bypassLength;
+      continue;
+    } else {
+      statistics.misses++;
+      page = Load(pageAddress, ok);
+    }
+
+    page->lastUse = ++useCounter;
+    std::memcpy(buffer, page->data.data() + offset, length);
+    address += length;
+    buffer += length;
+    size -= length;
+  }
+  return ok;
+}
+
+bool BlockCache::Program(uint32_t address, const uint8_t* buffer, size_t size) {
+  bool ok = true;
+  while (size > 0) {
+    const uint32_t pageAddress = address & ~(pageSize - 1u);
+    const size_t offset = address - pageAddress;
+    const size_t length = std::min(size, pageSize - offset);
+
+    Page* page = Find(pageAddress);
+    if (page != nullptr) {
+      statistics.hits++;
+    } else {
+      statistics.misses++;
+      page = Load(pageAddress, ok);
+    }
+
+    page->lastUse = ++useCounter;
+    // A NOR flash program can only clear bits
+    for (size_t i = 0; i < length; i++) {
+      page->data[offset + i] &= buffer[i];
+    }
+    if (page->dirtyBegin == page->dirtyEnd) {
+      page->dirtyBegin = offset;
+      page->dirtyEnd = offset + length;
+    } else {
+      page->dirtyBegin = std::min<uint16_t>(page->dirtyBegin, offset);
+      page->dirtyEnd = std::max<uint16_t>(page->dirtyEnd, offset + length);
+    }
+    address += length;
+    buffer += length;
+    size -= length;
+  }
+  return ok;
+}
+
+bool BlockCache::Erase(uint32_t sectorAddress, size_t sectorSize) {
+  // The content of the cached pages of the sector, programmed or not, is lost anyway
+  for (Page& page : pages) {
+    if (page.address != invalidAddress && page.address - sectorAddress < sectorSize) {
+      page.data.fill(0xff);
+      page.dirtyBegin = 0;
+      page.dirtyEnd = 0;
+    }
+  }
+  flashDriver.SectorErase(sectorAddress);
+  return !flashDriver.EraseFailed();
+}
+
+bool BlockCache::Flush() {
+  bool ok = true;
+  for (Page& page : pages) {
+    if (!WriteBack(page)) {
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+BlockCache::Page* BlockCache::Find(uint32_t pageAddress) {
+  for (Page& page : pages) {
+    if (page.address == pageAddress) {
+      return &page;
+    }
+  }
+  return nullptr;
+}
+
+BlockCache::Page* BlockCache::Load(uint32_t pageAddress, bool& writeBackOk) {
+  Page* leastRecentlyUsed = &pages[0];
+  for (Page& page : pages) {
+    if (page.address == invalidAddress) {
+      leastRecentlyUsed = &page;
+      break;
+    }
+    if (page.lastUse < leastRecentlyUsed->lastUse) {
+      leastRecentlyUsed = &page;
+    }
+  }
+
+  if (!WriteBack(*leastRecentlyUsed)) {
+    writeBackOk = false;
+  }
+  leastRecentlyUsed->address = pageAddress;
+  flashDriver.Read(pageAddress, leastRecentlyUsed->data.data(), pageSize);
+  return leastRecentlyUsed;
+}
+
+bool BlockCache::WriteBack(Page& page) {
+  if (page.dirtyBegin == page.dirtyEnd) {
+    return true;
+  }
+  flashDriver.Write(page.address + page.dirtyBegin, page.data.data() + page.dirtyBegin, page.dirtyEnd - page.dirtyBegin);
+  page.dirtyBegin = 0;
+  page.dirtyEnd = 0;
+  statistics.writeBacks++;
+  return !flashDriver.ProgramFailed();
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "drivers/SpiNorFlash.h"
+
+namespace Pinetime {
+  namespace Controllers {
+    // Write-back cache of the pages of the SPI NOR flash used by littlefs.
+    //
+    // littlefs reads the same metadata (directory entries, superblock) again and again with small reads, each one
+    // costing a SPI transaction and a wake-up of the flash. The pages read or programmed recently are kept in RAM
+    // (least recently used ones are evicted first) and the programs are only sent to the flash when the page is
+    // evicted or when Flush() is called (on littlefs sync).
+    // Reads covering whole pages that are not cached (file contents streamed by the application) bypass the cache
+    // so that they do not evict the metadata.
+    class BlockCache {
+    public:
+      // Size of a program page of the flash
+      static constexpr size_t pageSize = 256;
+      // Number of pages kept in RAM, increase to trade RAM for hits
+      static constexpr size_t nbPages = 4;
+
+      struct Statistics {
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+        uint32_t bypassed = 0;
+        uint32_t writeBacks = 0;
+      };
+
+      explicit BlockCache(Pinetime::Drivers::SpiNorFlash& flashDriver);
+      BlockCache(const BlockCache&) = delete;
+      BlockCache& operator=(const BlockCache&) = delete;
+      BlockCache(BlockCache&&) = delete;
+      BlockCache& operator=(BlockCache&&) = delete;
+
+      // Return false if a dirty page could not be written back to the flash
+      bool Read(uint32_t address, uint8_t* buffer, size_t size);
+      bool Program(uint32_t address, const uint8_t* buffer, size_t size);
+      bool Erase(uint32_t sectorAddress, size_t sectorSize);
+      bool Flush();
+
+      const Statistics& GetStatistics() const {
+        return statistics;
+      }
+
+    private:
+      static constexpr uint32_t invalidAddress = UINT32_MAX;
+
+      struct Page {
+        uint32_t address = invalidAddress;
+        uint32_t lastUse = 0;
+        // Range of bytes programmed since the page was loaded, dirtyBegin == dirtyEnd when clean
+        uint16_t dirtyBegin = 0;
+        uint16_t dirtyEnd = 0;
+        std::array<uint8_t, pageSize> data;
+      };
+
+      Pinetime::Drivers::SpiNorFlash& flashDriver;
+      std::array<Page, nbPages> pages;
+      uint32_t useCounter = 0;
+      Statistics statistics;
+
+      Page* Find(uint32_t pageAddress);
+      Page* Load(uint32_t pageAddress, bool& writeBackOk);
+      bool WriteBack(Page& page);
+    };
+  }
+}
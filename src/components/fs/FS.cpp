@@ -7,6 +7,7 @@ using namespace Pinetime::Controllers;
 
 FS::FS(Pinetime::Drivers::SpiNorFlash& driver)
   : flashDriver {driver},
+    cache {driver},
     lfsConfig {
       .context = this,
       .read = SectorRead,
@@ -114,27 +115,25 @@ lfs_ssize_t FS::GetFSSize() {
     ----------- Interface between littlefs and SpiNorFlash -----------
 
 */
-int FS::SectorSync(const struct lfs_config* /*c*/) {
-  return 0;
+int FS::SectorSync(const struct lfs_config* c) {
+  Pinetime::Controllers::FS& lfs = *(static_cast<Pinetime::Controllers::FS*>(c->context));
+  return lfs.cache.Flush() ? 0 : -1;
 }
 
 int FS::SectorErase(const struct lfs_config* c, lfs_block_t block) {
   Pinetime::Controllers::FS& lfs = *(static_cast<Pinetime::Controllers::FS*>(c->context));
   const size_t address = startAddress + (block * blockSize);
-  lfs.flashDriver.SectorErase(address);
-  return lfs.flashDriver.EraseFailed() ? -1 : 0;
+  return lfs.cache.Erase(address, blockSize) ? 0 : -1;
 }
 
 int FS::SectorProg(const struct lfs_config* c, lfs_block_t block, lfs_off_t off, const void* buffer, lfs_size_t size) {
   Pinetime::Controllers::FS& lfs = *(static_cast<Pinetime::Controllers::FS*>(c->context));
   const size_t address = startAddress + (block * blockSize) + off;
-  lfs.flashDriver.Write(address, (uint8_t*) buffer, size);
-  return lfs.flashDriver.ProgramFailed() ? -1 : 0;
+  return lfs.cache.Program(address, static_cast<const uint8_t*>(buffer), size) ? 0 : -1;
 }
 
 int FS::SectorRead(const struct lfs_config* c, lfs_block_t block, lfs_off_t off, void* buffer, lfs_size_t size) {
   Pinetime::Controllers::FS& lfs = *(static_cast<Pinetime::Controllers::FS*>(c->context));
   const size_t address = startAddress + (block * blockSize) + off;
-  lfs.flashDriver.Read(address, static_cast<uint8_t*>(buffer), size);
-  return 0;
+  return lfs.cache.Read(address, static_cast<uint8_t*>(buffer), size) ? 0 : -1;
 }
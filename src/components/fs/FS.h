@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include "drivers/SpiNorFlash.h"
+#include "components/fs/BlockCache.h"
 #include <littlefs/lfs.h>
 
 namespace Pinetime {
@@ -39,8 +40,13 @@ namespace Pinetime {
         return blockSize;
       }
 
+      const BlockCache::Statistics& GetCacheStatistics() const {
+        return cache.GetStatistics();
+      }
+
     private:
       Pinetime::Drivers::SpiNorFlash& flashDriver;
+      BlockCache cache;
 
       /*
        * External Flash MAP (4 MBytes)
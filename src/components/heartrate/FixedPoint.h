@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Controllers {
+    /// Signed fixed-point number stored on 32 bits, with FractionalBits fractional bits.
+    /// Products are computed on 64 bits and rounded to the nearest value (truncating them would bias the filters of the
+    /// PPG toward negative values). Nothing saturates: the caller must make sure that the values fit in the integer part
+    /// (31 - FractionalBits bits).
+    template <int FractionalBits>
+    class FixedPoint {
+    public:
+      static constexpr int32_t one = static_cast<int32_t>(1) << FractionalBits;
+
+      constexpr FixedPoint() = default;
+
+      constexpr FixedPoint(int value) : raw {value * one} {
+      }
+
+      constexpr FixedPoint(float value) : raw {static_cast<int32_t>(value * one + (value < 0.0f ? -0.5f : 0.5f))} {
+      }
+
+      static constexpr FixedPoint FromRaw(int32_t raw) {
+        FixedPoint result;
+        result.raw = raw;
+        return result;
+      }
+
+      constexpr int32_t Raw() const {
+        return raw;
+      }
+
+      explicit constexpr operator int() const {
+        return raw >> FractionalBits;
+      }
+
+      explicit constexpr operator float() const {
+        return static_cast<float>(raw) / one;
+      }
+
+      constexpr FixedPoint operator-() const {
+        return FromRaw(-raw);
+      }
+
+      constexpr FixedPoint operator+(FixedPoint other) const {
+        return FromRaw(raw + other.raw);
+      }
+
+      constexpr FixedPoint operator-(FixedPoint other) const {
+        return FromRaw(raw - other.raw);
+      }
+
+      template <int OtherBits>
+      constexpr FixedPoint operator*(FixedPoint<OtherBits> other) const {
+        constexpr int64_t half = static_cast<int64_t>(1) << (OtherBits - 1);
+        return FromRaw(static_cast<int32_t>((static_cast<int64_t>(raw) * other.Raw() + half) >> OtherBits));
+      }
+
+      template <int OtherBits>
+      constexpr FixedPoint operator/(FixedPoint<OtherBits> other) const {
+        return FromRaw(static_cast<int32_t>((static_cast<int64_t>(raw) * FixedPoint<OtherBits>::one) / other.Raw()));
+      }
+
+      constexpr FixedPoint operator*(int value) const {
+        return FromRaw(raw * value);
+      }
+
+      constexpr FixedPoint operator/(int value) const {
+        return FromRaw(raw / value);
+      }
+
+      FixedPoint& operator+=(FixedPoint other) {
+        raw += other.raw;
+        return *this;
+      }
+
+      FixedPoint& operator-=(FixedPoint other) {
+        raw -= other.raw;
+        return *this;
+      }
+
+      constexpr bool operator==(FixedPoint other) const {
+        return raw == other.raw;
+      }
+
+      constexpr bool operator!=(FixedPoint other) const {
+        return raw != other.raw;
+      }
+
+      constexpr bool operator<(FixedPoint other) const {
+        return raw < other.raw;
+      }
+
+      constexpr bool operator<=(FixedPoint other) const {
+        return raw <= other.raw;
+      }
+
+      constexpr bool operator>(FixedPoint other) const {
+        return raw > other.raw;
+      }
+
+      constexpr bool operator>=(FixedPoint other) const {
+        return raw >= other.raw;
+      }
+
+    private:
+      int32_t raw = 0;
+    };
+
+    /// sqrt(real * real + imag * imag), the squares are computed on 64 bits
+    template <int FractionalBits>
+    FixedPoint<FractionalBits> Magnitude(FixedPoint<FractionalBits> real, FixedPoint<FractionalBits> imag) {
+      uint64_t square = static_cast<uint64_t>(static_cast<int64_t>(real.Raw()) * real.Raw()) +
+                        static_cast<uint64_t>(static_cast<int64_t>(imag.Raw()) * imag.Raw());
+
+      // Bit by bit integer square root
+      uint64_t root = 0;
+      uint64_t bit = static_cast<uint64_t>(1) << 62;
+      while (bit > square) {
+        bit >>= 2;
+      }
+      while (bit != 0) {
+        if (square >= root + bit) {
+          square -= root + bit;
+          root = (root >> 1) + bit;
+        } else {
+          root >>= 1;
+        }
+        bit >>= 2;
+      }
+      return FixedPoint<FractionalBits>::FromRaw(static_cast<int32_t>(root));
+    }
+
+    /// Floating-point counterpart of the above, so that code templated on the arithmetic can call Magnitude() for both
+    inline float Magnitude(float real, float imag) {
+      return std::sqrt(real * real + imag * imag);
+    }
+  }
+}
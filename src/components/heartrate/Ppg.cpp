@@ -1,150 +1,161 @@
 #include "components/heartrate/Ppg.h"
+#include <cmath>
 #include <nrf_log.h>
-#include <vector>
+#include <utility>
 
 using namespace Pinetime::Controllers;
 
 namespace {
-  float LinearInterpolation(const float* xValues, const float* yValues, int length, float pointX) {
-    if (pointX > xValues[length - 1]) {
-      return yValues[length - 1];
-    } else if (pointX <= xValues[0]) {
-      return yValues[0];
+  // Number of interpolation steps per bin in PeakSearch()
+  constexpr int stepsPerBin = 100;
+
+  // Linear interpolation of values at position, expressed in steps (1/stepsPerBin of a bin)
+  template <typename Sample, typename Coefficient>
+  Sample LinearInterpolation(const Sample* values, int length, int position) {
+    if (position <= 0) {
+      return values[0];
     }
-    int index = 0;
-    while (pointX > xValues[index] && index < length - 1) {
-      index++;
+    int bin = position / stepsPerBin;
+    if (bin >= length - 1) {
+      return values[length - 1];
     }
-    float pointX0 = xValues[index - 1];
-    float pointX1 = xValues[index];
-    float pointY0 = yValues[index - 1];
-    float pointY1 = yValues[index];
-    float mu = (pointX - pointX0) / (pointX1 - pointX0);
-
-    return (pointY0 * (1 - mu) + pointY1 * mu);
+    constexpr Coefficient step = 1.0f / stepsPerBin;
+    Coefficient mu = step * (position % stepsPerBin);
+    return values[bin] + (values[bin + 1] - values[bin]) * mu;
   }
 
-  float PeakSearch(float* xVals, float* yVals, float threshold, float& width, float start, float end, int length) {
+  // Searches the peak above threshold between the bins start and end with a resolution of 1/stepsPerBin bin.
+  // Returns its center (bins) and sets its width (bins), or returns 0 if there is not exactly one peak.
+  template <typename Sample, typename Coefficient>
+  Sample PeakSearch(const Sample* values, Sample threshold, Sample& width, int start, int end, int length) {
     int peaks = 0;
     bool enabled = false;
-    float minBin = 0.0f;
-    float maxBin = 0.0f;
-    float peakCenter = 0.0f;
-    float prevValue = LinearInterpolation(xVals, yVals, length, start - 0.01f);
-    float currValue = LinearInterpolation(xVals, yVals, length, start);
-    float idx = start;
-    while (idx < end) {
-      float nextValue = LinearInterpolation(xVals, yVals, length, idx + 0.01f);
+    int minStep = 0;
+    int maxStep = 0;
+    Sample prevValue = LinearInterpolation<Sample, Coefficient>(values, length, start * stepsPerBin - 1);
+    Sample currValue = LinearInterpolation<Sample, Coefficient>(values, length, start * stepsPerBin);
+    for (int idx = start * stepsPerBin; idx < end * stepsPerBin; idx++) {
+      Sample nextValue = LinearInterpolation<Sample, Coefficient>(values, length, idx + 1);
       if (currValue < threshold) {
         enabled = true;
       }
       if (currValue >= threshold and enabled) {
         if (prevValue < threshold) {
-          minBin = idx;
+          minStep = idx;
         } else if (nextValue <= threshold) {
-          maxBin = idx;
+          maxStep = idx;
           peaks++;
-          width = maxBin - minBin;
-          peakCenter = width / 2.0f + minBin;
         }
       }
       prevValue = currValue;
       currValue = nextValue;
-      idx += 0.01f;
     }
     if (peaks != 1) {
-      width = 0.0f;
-      peakCenter = 0.0f;
+      width = 0;
+      return 0;
     }
-    return peakCenter;
+    width = Sample(maxStep - minStep) / stepsPerBin;
+    return Sample(minStep + maxStep) / (2 * stepsPerBin);
   }
 
-  float SpectrumMean(const std::array<float, Ppg::spectrumLength>& signal, int start, int end) {
+  template <typename Sample>
+  Sample SpectrumMean(const Sample* signal, int start, int end) {
     int total = 0;
-    float mean = 0.0f;
+    Sample mean = 0;
     for (int idx = start; idx < end; idx++) {
-      mean += signal.at(idx);
+      mean += signal[idx];
       total++;
     }
     if (total > 0) {
-      mean /= static_cast<float>(total);
+      mean = mean / total;
     }
     return mean;
   }
 
-  float SignalToNoise(const std::array<float, Ppg::spectrumLength>& signal, int start, int end, float max) {
-    float mean = SpectrumMean(signal, start, end);
-    return max / mean;
-  }
-
-  // Simple bandpass filter using exponential moving average
-  void Filter30to240(std::array<float, Ppg::dataLength>& signal) {
-    // From:
-    // https://www.norwegiancreations.com/2016/03/arduino-tutorial-simple-high-pass-band-pass-and-band-stop-filtering/
-
-    int length = signal.size();
-    // 0.268 is ~0.5Hz and 0.816 is ~4Hz cutoff at 10Hz sampling
-    float expAlpha = 0.816f;
-    float expAvg = 0.0f;
-    for (int loop = 0; loop < 4; loop++) {
-      expAvg = signal.front();
-      for (int idx = 0; idx < length; idx++) {
-        expAvg = (expAlpha * signal.at(idx)) + ((1 - expAlpha) * expAvg);
-        signal[idx] = expAvg;
-      }
-    }
-    expAlpha = 0.268f;
-    for (int loop = 0; loop < 4; loop++) {
-      expAvg = signal.front();
-      for (int idx = 0; idx < length; idx++) {
-        expAvg = (expAlpha * signal.at(idx)) + ((1 - expAlpha) * expAvg);
-        signal[idx] -= expAvg;
-      }
+  template <typename Sample>
+  Sample SignalToNoise(const Sample* signal, int start, int end, Sample max) {
+    Sample mean = SpectrumMean(signal, start, end);
+    if (mean <= Sample(0)) {
+      return 0;
     }
+    return max / mean;
   }
 
-  float SpectrumMax(const std::array<float, Ppg::spectrumLength>& data, int start, int end) {
-    float max = 0.0f;
+  template <typename Sample>
+  Sample SpectrumMax(const Sample* data, int start, int end) {
+    Sample max = 0;
     for (int idx = start; idx < end; idx++) {
-      if (data.at(idx) > max) {
-        max = data.at(idx);
+      if (data[idx] > max) {
+        max = data[idx];
       }
     }
     return max;
   }
 
-  void Detrend(std::array<float, Ppg::dataLength>& signal) {
-    int size = signal.size();
-    float offset = signal.front();
-    float slope = (signal.at(size - 1) - offset) / static_cast<float>(size - 1);
+  // sin(2 * pi * idx / dataLength) for the first quarter of the period:
+  // python -c 'import math;print([math.sin(2*math.pi*i/64) for i in range(17)])'
+  // Note: Harcoded and must be updated if constexpr dataLength is changed. Prevents the need to
+  // use sinf()/cosf() which results in an extra ~5KB in storage.
+  constexpr float quarterSine[(Ppg::dataLength >> 2) + 1] {
+    0.0f,        0.09801714f, 0.19509032f, 0.29028468f, 0.38268343f, 0.47139674f, 0.55557023f, 0.63439328f, 0.70710678f,
+    0.77301045f, 0.83146961f, 0.88192126f, 0.92387953f, 0.95694034f, 0.98078528f, 0.99518473f, 1.0f};
+
+  // quarterSine converted to Coefficient at compile time
+  template <typename Coefficient, size_t... Idx>
+  constexpr std::array<Coefficient, sizeof...(Idx)> ConvertQuarterSine(std::index_sequence<Idx...>) {
+    return {{Coefficient(quarterSine[Idx])...}};
+  }
+
+  template <typename Coefficient>
+  struct SineTable {
+    static constexpr std::array<Coefficient, sizeof(quarterSine) / sizeof(quarterSine[0])> values =
+      ConvertQuarterSine<Coefficient>(std::make_index_sequence<sizeof(quarterSine) / sizeof(quarterSine[0])>());
+  };
 
-    for (int idx = 0; idx < size; idx++) {
-      signal[idx] -= (slope * static_cast<float>(idx) + offset);
-    }
-    for (int idx = 0; idx < size - 1; idx++) {
-      signal[idx] = signal[idx + 1] - signal[idx];
+  template <typename Coefficient>
+  constexpr std::array<Coefficient, sizeof(quarterSine) / sizeof(quarterSine[0])> SineTable<Coefficient>::values;
+
+  template <typename Coefficient>
+  Coefficient Sine(int idx) {
+    constexpr int quarter = Ppg::dataLength >> 2;
+    const auto& table = SineTable<Coefficient>::values;
+    idx %= Ppg::dataLength;
+    if (idx <= quarter) {
+      return table[idx];
+    } else if (idx <= 2 * quarter) {
+      return table[2 * quarter - idx];
+    } else if (idx <= 3 * quarter) {
+      return -table[idx - 2 * quarter];
     }
+    return -table[4 * quarter - idx];
   }
 
-  // Hanning Coefficients from numpy: python -c 'import numpy;print(numpy.hanning(64))'
-  // Note: Harcoded and must be updated if constexpr dataLength is changed. Prevents the need to
-  // use cosf() which results in an extra ~5KB in storage.
-  // This data is symetrical so just using the first half (saves 128B when dataLength is 64).
-  static constexpr float hanning[Ppg::dataLength >> 1] {
-    0.0f,        0.00248461f, 0.00991376f, 0.0222136f,  0.03926189f, 0.06088921f, 0.08688061f, 0.11697778f,
-    0.15088159f, 0.1882551f,  0.22872687f, 0.27189467f, 0.31732949f, 0.36457977f, 0.41317591f, 0.46263495f,
-    0.51246535f, 0.56217185f, 0.61126047f, 0.65924333f, 0.70564355f, 0.75f,       0.79187184f, 0.83084292f,
-    0.86652594f, 0.89856625f, 0.92664544f, 0.95048443f, 0.96984631f, 0.98453864f, 0.99441541f, 0.99937846f};
+  template <typename Coefficient>
+  Coefficient Cosine(int idx) {
+    return Sine<Coefficient>(idx + (Ppg::dataLength >> 2));
+  }
 }
 
-Ppg::Ppg() {
-  dataAverage.fill(0.0f);
-  spectrum.fill(0.0f);
+template <typename Sample, typename Coefficient>
+BasicPpg<Sample, Coefficient>::BasicPpg() {
+  dataAverage.fill(0);
+  spectrum.fill(0);
+  ResetSpectrum();
 }
 
-int8_t Ppg::Preprocess(uint32_t hrs, uint32_t als) {
+template <typename Sample, typename Coefficient>
+int8_t BasicPpg<Sample, Coefficient>::Preprocess(uint32_t hrs, uint32_t als) {
+  // The signal is differentiated (the derivative has no trend to remove), band-pass filtered and added to the
+  // sliding DFT as it is sampled, so that HeartRate() only has to read the bins of the spectrum it needs.
+  Sample value = 0;
+  if (dataIndex > 0) {
+    value = Sample(static_cast<int32_t>(hrs - previousHrs));
+  }
+  previousHrs = hrs;
+  SlideSpectrum(Filter30to240(value));
+
   if (dataIndex < dataLength) {
-    dataHRS[dataIndex++] = hrs;
+    dataIndex++;
   }
   alsValue = als;
   if (alsValue > alsThreshold) {
@@ -153,89 +164,142 @@ int8_t Ppg::Preprocess(uint32_t hrs, uint32_t als) {
   return 0;
 }
 
-int Ppg::HeartRate() {
+template <typename Sample, typename Coefficient>
+int BasicPpg<Sample, Coefficient>::HeartRate() {
   if (dataIndex < dataLength) {
     return 0;
   }
   int hr = 0;
   hr = ProcessHeartRate(resetSpectralAvg);
   resetSpectralAvg = false;
-  // Make room for overlapWindow number of new samples
-  for (int idx = 0; idx < dataLength - overlapWindow; idx++) {
-    dataHRS[idx] = dataHRS[idx + overlapWindow];
-  }
+  // Wait for overlapWindow number of new samples
   dataIndex = dataLength - overlapWindow;
   return hr;
 }
 
-void Ppg::Reset(bool resetDaqBuffer) {
+template <typename Sample, typename Coefficient>
+void BasicPpg<Sample, Coefficient>::Reset(bool resetDaqBuffer) {
   if (resetDaqBuffer) {
     dataIndex = 0;
+    ResetSpectrum();
   }
   avgIndex = 0;
-  dataAverage.fill(0.0f);
-  lastPeakLocation = 0.0f;
+  dataAverage.fill(0);
+  lastPeakLocation = 0;
   alsThreshold = UINT16_MAX;
   alsValue = 0;
   resetSpectralAvg = true;
-  spectrum.fill(0.0f);
+  spectrum.fill(0);
+}
+
+// Simple bandpass filter using exponential moving average, applied to each new sample.
+// From:
+// https://www.norwegiancreations.com/2016/03/arduino-tutorial-simple-high-pass-band-pass-and-band-stop-filtering/
+template <typename Sample, typename Coefficient>
+Sample BasicPpg<Sample, Coefficient>::Filter30to240(Sample value) {
+  // 0.268 is ~0.5Hz and 0.816 is ~4Hz cutoff at 10Hz sampling
+  constexpr Coefficient lowPassAlpha = 0.816f;
+  constexpr Coefficient lowPassDecay = 1.0f - 0.816f;
+  constexpr Coefficient highPassAlpha = 0.268f;
+  constexpr Coefficient highPassDecay = 1.0f - 0.268f;
+  for (Sample& expAvg : lowPassStates) {
+    expAvg = (value * lowPassAlpha) + (expAvg * lowPassDecay);
+    value = expAvg;
+  }
+  for (Sample& expAvg : highPassStates) {
+    expAvg = (value * highPassAlpha) + (expAvg * highPassDecay);
+    value -= expAvg;
+  }
+  return value;
+}
+
+// Sliding DFT: replaces the oldest sample of the window by the new one and rotates each bin by one sample.
+template <typename Sample, typename Coefficient>
+void BasicPpg<Sample, Coefficient>::SlideSpectrum(Sample value) {
+  Sample delta = value - dataFiltered[writeIndex];
+  dataFiltered[writeIndex] = value;
+  writeIndex = (writeIndex + 1) % dataLength;
+
+  if (writeIndex == 0) {
+    // Get rid of the rounding errors accumulated by the sliding DFT once per window
+    ComputeSpectrum();
+    return;
+  }
+
+  for (int bin = 0; bin < nbBins; bin++) {
+    Sample real = binsReal[bin] + delta;
+    Sample imag = binsImag[bin];
+    Coefficient cosine = Cosine<Coefficient>(bin);
+    Coefficient sine = Sine<Coefficient>(bin);
+    binsReal[bin] = real * cosine - imag * sine;
+    binsImag[bin] = real * sine + imag * cosine;
+  }
+}
+
+// Direct DFT of the window, for the bins 0 to nbBins - 1
+template <typename Sample, typename Coefficient>
+void BasicPpg<Sample, Coefficient>::ComputeSpectrum() {
+  for (int bin = 0; bin < nbBins; bin++) {
+    Sample real = 0;
+    Sample imag = 0;
+    for (int idx = 0; idx < dataLength; idx++) {
+      Sample value = dataFiltered[(writeIndex + idx) % dataLength];
+      real += value * Cosine<Coefficient>(bin * idx);
+      imag -= value * Sine<Coefficient>(bin * idx);
+    }
+    binsReal[bin] = real;
+    binsImag[bin] = imag;
+  }
+}
+
+template <typename Sample, typename Coefficient>
+void BasicPpg<Sample, Coefficient>::ResetSpectrum() {
+  dataFiltered.fill(0);
+  binsReal.fill(0);
+  binsImag.fill(0);
+  lowPassStates.fill(0);
+  highPassStates.fill(0);
+  writeIndex = 0;
 }
 
 // Pass init == true to reset spectral averaging.
 // Returns -1 (Reset Acquisition), 0 (Unable to obtain HR) or HR (BPM).
-int Ppg::ProcessHeartRate(bool init) {
-  std::copy(dataHRS.begin(), dataHRS.end(), vReal.begin());
-  Detrend(vReal);
-  Filter30to240(vReal);
-  vImag.fill(0.0f);
-  // Apply Hanning Window
-  int hannIdx = 0;
-  for (int idx = 0; idx < dataLength; idx++) {
-    if (idx >= dataLength >> 1) {
-      hannIdx--;
-    }
-    vReal[idx] *= hanning[hannIdx];
-    if (idx < dataLength >> 1) {
-      hannIdx++;
-    }
+template <typename Sample, typename Coefficient>
+int BasicPpg<Sample, Coefficient>::ProcessHeartRate(bool init) {
+  // Hanning window applied in the frequency domain: 0.5 * X[k] - 0.25 * (X[k - 1] + X[k + 1]).
+  // X[-1] is the complex conjugate of X[1] since the signal is real.
+  constexpr Coefficient half = 0.5f;
+  constexpr Coefficient quarter = 0.25f;
+  magnitudes.fill(0);
+  for (int bin = 0; bin < nbBins - 1; bin++) {
+    Sample previousReal = (bin == 0) ? binsReal[1] : binsReal[bin - 1];
+    Sample previousImag = (bin == 0) ? -binsImag[1] : binsImag[bin - 1];
+    Sample real = binsReal[bin] * half - (previousReal + binsReal[bin + 1]) * quarter;
+    Sample imag = binsImag[bin] * half - (previousImag + binsImag[bin + 1]) * quarter;
+    magnitudes[bin] = Magnitude(real, imag);
   }
-  // Compute in place power spectrum
-  ArduinoFFT<float> FFT = ArduinoFFT<float>(vReal.data(), vImag.data(), dataLength, sampleFreq);
-  FFT.compute(FFTDirection::Forward);
-  FFT.complexToMagnitude();
-  FFT.~ArduinoFFT();
-  SpectrumAverage(vReal.data(), spectrum.data(), spectrum.size(), init);
-  peakLocation = 0.0f;
-  float threshold = peakDetectionThreshold;
-  float peakWidth = 0.0f;
+  SpectrumAverage(magnitudes.data(), spectrum.data(), spectrum.size(), init);
+  peakLocation = 0;
+  Sample peakWidth = 0;
   int specLen = spectrum.size();
-  float max = SpectrumMax(spectrum, hrROIbegin, hrROIend);
-  float signalToNoiseRatio = SignalToNoise(spectrum, hrROIbegin, hrROIend, max);
-  if (signalToNoiseRatio > signalToNoiseThreshold && spectrum.at(0) < dcThreshold) {
-    threshold *= max;
-    // Reuse VImag for interpolation x values passed to PeakSearch
-    for (int idx = 0; idx < dataLength; idx++) {
-      vImag[idx] = idx;
-    }
-    peakLocation = PeakSearch(vImag.data(),
-                              spectrum.data(),
-                              threshold,
-                              peakWidth,
-                              static_cast<float>(hrROIbegin),
-                              static_cast<float>(hrROIend),
-                              specLen);
-    peakLocation *= freqResolution;
+  Sample max = SpectrumMax(spectrum.data(), hrROIbegin, hrROIend);
+  Sample signalToNoiseRatio = SignalToNoise(spectrum.data(), hrROIbegin, hrROIend, max);
+  if (signalToNoiseRatio > Sample(signalToNoiseThreshold) && spectrum.at(0) < Sample(dcThreshold)) {
+    constexpr Coefficient threshold = peakDetectionThreshold;
+    constexpr Coefficient binToFrequency = freqResolution;
+    peakLocation = PeakSearch<Sample, Coefficient>(spectrum.data(), max * threshold, peakWidth, hrROIbegin, hrROIend, specLen);
+    peakLocation = peakLocation * binToFrequency;
   }
   // Peak too wide? (broad spectrum noise or large, rapid HR change)
-  if (peakWidth > maxPeakWidth) {
-    peakLocation = 0.0f;
+  if (peakWidth > Sample(maxPeakWidth)) {
+    peakLocation = 0;
   }
   // Check HR limits
-  if (peakLocation < minHR || peakLocation > maxHR) {
-    peakLocation = 0.0f;
+  if (peakLocation < Sample(minHR) || peakLocation > Sample(maxHR)) {
+    peakLocation = 0;
   }
   // Reset spectral averaging if bad reading
-  if (peakLocation == 0.0f) {
+  if (peakLocation == Sample(0)) {
     resetSpectralAvg = true;
   }
   // Set the ambient light threshold and return HR in BPM
@@ -243,50 +307,50 @@ int Ppg::ProcessHeartRate(bool init) {
   // Get current average HR. If HR reduced to zero, return -1 (reset) else HR
   peakLocation = HeartRateAverage(peakLocation);
   int rtn = -1;
-  if (peakLocation == 0.0f && lastPeakLocation > 0.0f) {
-    lastPeakLocation = 0.0f;
+  if (peakLocation == Sample(0) && lastPeakLocation > Sample(0)) {
+    lastPeakLocation = 0;
   } else {
     lastPeakLocation = peakLocation;
-    rtn = static_cast<int>((peakLocation * 60.0f) + 0.5f);
+    rtn = static_cast<int>((peakLocation * 60) + Sample(0.5f));
   }
   return rtn;
 }
 
-void Ppg::SpectrumAverage(const float* data, float* spectrum, int length, bool reset) {
+template <typename Sample, typename Coefficient>
+void BasicPpg<Sample, Coefficient>::SpectrumAverage(const Sample* data, Sample* spectrum, int length, bool reset) {
   if (reset) {
     spectralAvgCount = 0;
   }
-  float count = static_cast<float>(spectralAvgCount);
+  // Same as (spectrum * count + data) / (count + 1), without the multiplication that could overflow in fixed-point
+  int count = spectralAvgCount;
   for (int idx = 0; idx < length; idx++) {
-    spectrum[idx] = (spectrum[idx] * count + data[idx]) / (count + 1);
+    spectrum[idx] += (data[idx] - spectrum[idx]) / (count + 1);
   }
   if (spectralAvgCount < spectralAvgMax) {
     spectralAvgCount++;
   }
 }
 
-float Ppg::HeartRateAverage(float hr) {
+template <typename Sample, typename Coefficient>
+Sample BasicPpg<Sample, Coefficient>::HeartRateAverage(Sample hr) {
   avgIndex++;
   avgIndex %= dataAverage.size();
   dataAverage[avgIndex] = hr;
-  float avg = 0.0f;
-  float total = 0.0f;
-  float min = 300.0f;
-  float max = 0.0f;
-  for (const float& value : dataAverage) {
-    if (value > 0.0f) {
+  Sample avg = 0;
+  int total = 0;
+  for (const Sample& value : dataAverage) {
+    if (value > Sample(0)) {
       avg += value;
-      if (value < min)
-        min = value;
-      if (value > max)
-        max = value;
       total++;
     }
   }
   if (total > 0) {
-    avg /= total;
+    avg = avg / total;
   } else {
-    avg = 0.0f;
+    avg = 0;
   }
   return avg;
 }
+
+template class Pinetime::Controllers::BasicPpg<float, float>;
+template class Pinetime::Controllers::BasicPpg<FixedPoint<8>, FixedPoint<15>>;
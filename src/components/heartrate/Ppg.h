@@ -3,16 +3,16 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
-// Note: Change internal define 'sqrt_internal sqrt' to
-// 'sqrt_internal sqrtf' to save ~3KB of flash.
-#define FFT_SPEED_OVER_PRECISION
-#include "libs/arduinoFFT-develop/src/arduinoFFT.h"
+#include "components/heartrate/FixedPoint.h"
 
 namespace Pinetime {
   namespace Controllers {
-    class Ppg {
+    // The signal chain is written once for the two arithmetics it is instantiated with (see the aliases below):
+    // Sample holds the signal, the spectrum and the frequencies, Coefficient the filter and DFT coefficients.
+    template <typename Sample, typename Coefficient>
+    class BasicPpg {
     public:
-      Ppg();
+      BasicPpg();
       int8_t Preprocess(uint32_t hrs, uint32_t als);
       int HeartRate();
       void Reset(bool resetDaqBuffer);
@@ -49,31 +49,54 @@ namespace Pinetime {
       // Threshold for high DC level after filtering
       static constexpr float dcThreshold = 0.5f;
       // ALS detection factor
-      static constexpr float alsFactor = 2.0f;
+      static constexpr uint16_t alsFactor = 2;
+      // Number of DFT bins updated for each new sample: the spectrum is analysed up to hrROIend + 1 (peak
+      // interpolation) and the Hanning window, applied in the frequency domain, needs the next bin.
+      static constexpr uint16_t nbBins = hrROIend + 3;
+      static_assert(nbBins <= spectrumLength, "The sliding DFT must not need more bins than the spectrum");
 
-      // Raw ADC data
-      std::array<uint16_t, dataLength> dataHRS;
-      // Stores Real numbers from FFT
-      std::array<float, dataLength> vReal;
-      // Stores Imaginary numbers from FFT
-      std::array<float, dataLength> vImag;
-      // Stores power spectrum calculated from FFT real and imag values
-      std::array<float, (spectrumLength)> spectrum;
+      // Filtered samples of the analysis window (circular buffer, writeIndex points to the oldest sample)
+      std::array<Sample, dataLength> dataFiltered;
+      // Sliding DFT of dataFiltered (bins 0 to nbBins - 1)
+      std::array<Sample, nbBins> binsReal;
+      std::array<Sample, nbBins> binsImag;
+      // Magnitudes of the windowed spectrum
+      std::array<Sample, spectrumLength> magnitudes;
+      // Stores the running average of the magnitudes
+      std::array<Sample, (spectrumLength)> spectrum;
       // Stores each new HR value (Hz). Non zero values are averaged for HR output
-      std::array<float, 20> dataAverage;
+      std::array<Sample, 20> dataAverage;
 
       uint16_t avgIndex = 0;
       uint16_t spectralAvgCount = 0;
-      float lastPeakLocation = 0.0f;
+      Sample lastPeakLocation = 0;
       uint16_t alsThreshold = UINT16_MAX;
       uint16_t alsValue = 0;
       uint16_t dataIndex = 0;
-      float peakLocation;
+      uint16_t writeIndex = 0;
+      uint32_t previousHrs = 0;
+      std::array<Sample, 4> lowPassStates;
+      std::array<Sample, 4> highPassStates;
+      Sample peakLocation;
       bool resetSpectralAvg = true;
 
+      Sample Filter30to240(Sample value);
+      void SlideSpectrum(Sample value);
+      void ComputeSpectrum();
+      void ResetSpectrum();
       int ProcessHeartRate(bool init);
-      float HeartRateAverage(float hr);
-      void SpectrumAverage(const float* data, float* spectrum, int length, bool reset);
+      Sample HeartRateAverage(Sample hr);
+      void SpectrumAverage(const Sample* data, Sample* spectrum, int length, bool reset);
     };
+
+    using PpgFloat = BasicPpg<float, float>;
+    // Q23.8 signal (the raw HRS values are 16 bits, the DFT of 64 samples needs 6 more bits) and Q15 coefficients
+    using PpgFixed = BasicPpg<FixedPoint<8>, FixedPoint<15>>;
+
+#ifdef PPG_FIXED_POINT
+    using Ppg = PpgFixed;
+#else
+    using Ppg = PpgFloat;
+#endif
   }
 }
@@ -5,22 +5,37 @@
 using namespace Pinetime::Controllers;
 
 void MotionController::Update(int16_t x, int16_t y, int16_t z, uint32_t nbSteps) {
-  if (this->nbSteps != nbSteps && service != nullptr) {
-    service->OnNewStepCountValue(nbSteps);
-  }
+  AddSample(x, y, z, xTaskGetTickCount());
+  Update(nbSteps);
+}
 
-  if (service != nullptr && (this->x != x || this->y != y || this->z != z)) {
-    service->OnNewMotionValues(x, y, z);
+void MotionController::AddSample(int16_t x, int16_t y, int16_t z, TickType_t timestamp) {
+  // ShouldShakeWake() divides by the time elapsed between 2 samples
+  if (static_cast<int32_t>(timestamp - time) <= 0) {
+    timestamp = time + 1;
   }
 
   lastTime = time;
-  time = xTaskGetTickCount();
+  time = timestamp;
 
   this->x = x;
   lastY = this->y;
   this->y = y;
   lastZ = this->z;
   this->z = z;
+}
+
+void MotionController::Update(uint32_t nbSteps) {
+  if (this->nbSteps != nbSteps && service != nullptr) {
+    service->OnNewStepCountValue(nbSteps);
+  }
+
+  if (service != nullptr && (notifiedX != x || notifiedY != y || notifiedZ != z)) {
+    service->OnNewMotionValues(x, y, z);
+  }
+  notifiedX = x;
+  notifiedY = y;
+  notifiedZ = z;
 
   int32_t deltaSteps = nbSteps - this->nbSteps;
   if (deltaSteps > 0) {
@@ -52,7 +67,7 @@ bool MotionController::ShouldRaiseWake(bool isSleeping) {
 }
 
 bool MotionController::ShouldShakeWake(uint16_t thresh) {
-  /* Currently Polling at 10hz, If this ever goes faster scalar and EMA might need adjusting */
+  /* Samples come from the FIFO at 12.5hz, If this ever goes faster scalar and EMA might need adjusting */
   int32_t speed = std::abs(z + (y / 2) + (x / 4) - lastY / 2 - lastZ) / (time - lastTime) * 100;
   //(.2 * speed) + ((1 - .2) * accumulatedSpeed);
   // implemented without floats as .25Alpha
@@ -19,6 +19,11 @@ namespace Pinetime {
 
       void Update(int16_t x, int16_t y, int16_t z, uint32_t nbSteps);
 
+      // Batch of samples read from the FIFO of the motion sensor: call AddSample() for each sample (oldest first)
+      // and then Update() with the step count to notify the BLE service once for the whole batch.
+      void AddSample(int16_t x, int16_t y, int16_t z, TickType_t timestamp);
+      void Update(uint32_t nbSteps);
+
       int16_t X() const {
         return x;
       }
@@ -75,6 +80,10 @@ namespace Pinetime {
       int16_t z = 0;
       int32_t accumulatedSpeed = 0;
 
+      int16_t notifiedX = 0;
+      int16_t notifiedY = 0;
+      int16_t notifiedZ = 0;
+
       DeviceTypes deviceType = DeviceTypes::Unknown;
       Pinetime::Controllers::MotionService* service = nullptr;
     };
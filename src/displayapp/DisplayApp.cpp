@@ -10,6 +10,7 @@
 #include "components/ble/NotificationManager.h"
 #include "components/motion/MotionController.h"
 #include "components/motor/MotorController.h"
+#include "components/frameprofiler/FrameProfiler.h"
 // #include "displayapp/screens/ApplicationList.h"
 // #include "displayapp/screens/Clock.h"
 // #include "displayapp/screens/FirmwareUpdate.h"
@@ -85,7 +86,8 @@ DisplayApp::DisplayApp(Drivers::St7789& lcd,
                        Pinetime::Controllers::AlarmController& alarmController,
                        Pinetime::Controllers::BrightnessController& brightnessController,
                        Pinetime::Controllers::TouchHandler& touchHandler,
-                       Pinetime::Controllers::FS& filesystem)
+                       Pinetime::Controllers::FS& filesystem,
+                       Pinetime::Controllers::FrameProfiler& frameProfiler)
   : lcd {lcd},
     touchPanel {touchPanel},
     batteryController {batteryController},
@@ -101,7 +103,8 @@ DisplayApp::DisplayApp(Drivers::St7789& lcd,
     brightnessController {brightnessController},
     touchHandler {touchHandler},
     filesystem {filesystem},
-    lvgl {lcd, filesystem},
+    frameProfiler {frameProfiler},
+    lvgl {lcd, filesystem, frameProfiler},
     timer(this, TimerCallback) {
   _components = new ComponentContainer(&batteryController,
                                        &bleController,
@@ -126,6 +129,7 @@ void DisplayApp::Start(System::BootErrors error) {
 
   bootError = error;
 
+  frameProfiler.Init();
   lvgl.Init();
 
   // if (error == System::BootErrors::TouchController) {
@@ -227,7 +231,9 @@ void DisplayApp::Refresh() {
       if (_screenGraph) {
         _screenGraph->handleRefresh();
       }
+      frameProfiler.BeginFrame();
       queueTimeout = lv_task_handler();
+      frameProfiler.EndFrame();
 
       if (!systemTask->IsSleepDisabled() && IsPastDimTime()) {
         if (!isDimmed) {
@@ -48,6 +48,7 @@ namespace Pinetime {
     class BrightnessController;
     class TouchHandler;
     class FS;
+    class FrameProfiler;
   }
 
   namespace System {
@@ -73,7 +74,8 @@ namespace Pinetime {
                  Pinetime::Controllers::AlarmController& alarmController,
                  Pinetime::Controllers::BrightnessController& brightnessController,
                  Pinetime::Controllers::TouchHandler& touchHandler,
-                 Pinetime::Controllers::FS& filesystem);
+                 Pinetime::Controllers::FS& filesystem,
+                 Pinetime::Controllers::FrameProfiler& frameProfiler);
       ~DisplayApp();
       void Start(System::BootErrors error);
       void PushMessage(Display::Messages msg);
@@ -101,6 +103,7 @@ namespace Pinetime {
       Pinetime::Controllers::BrightnessController& brightnessController;
       Pinetime::Controllers::TouchHandler& touchHandler;
       Pinetime::Controllers::FS& filesystem;
+      Pinetime::Controllers::FrameProfiler& frameProfiler;
 
       Pinetime::Controllers::FirmwareValidator validator;
       Pinetime::Components::LittleVgl lvgl;
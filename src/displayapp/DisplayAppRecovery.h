@@ -34,6 +34,7 @@ namespace Pinetime {
     class AlarmController;
     class BrightnessController;
     class FS;
+    class FrameProfiler;
   }
 
   namespace System {
@@ -57,7 +58,8 @@ namespace Pinetime {
                  Pinetime::Controllers::AlarmController& alarmController,
                  Pinetime::Controllers::BrightnessController& brightnessController,
                  Pinetime::Controllers::TouchHandler& touchHandler,
-                 Pinetime::Controllers::FS& filesystem);
+                 Pinetime::Controllers::FS& filesystem,
+                 Pinetime::Controllers::FrameProfiler& frameProfiler);
       void Start();
 
       void Start(Pinetime::System::BootErrors) {
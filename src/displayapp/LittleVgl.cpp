@@ -6,6 +6,7 @@
 #include "drivers/St7789.h"
 #include "littlefs/lfs.h"
 #include "components/fs/FS.h"
+#include "components/frameprofiler/FrameProfiler.h"
 
 using namespace Pinetime::Components;
 
@@ -73,7 +74,10 @@ bool touchpad_read(lv_indev_drv_t* indev_drv, lv_indev_data_t* data) {
   return lvgl->GetTouchPadInfo(data);
 }
 
-LittleVgl::LittleVgl(Pinetime::Drivers::St7789& lcd, Pinetime::Controllers::FS& filesystem) : lcd {lcd}, filesystem {filesystem} {
+LittleVgl::LittleVgl(Pinetime::Drivers::St7789& lcd,
+                     Pinetime::Controllers::FS& filesystem,
+                     Pinetime::Controllers::FrameProfiler& frameProfiler)
+  : lcd {lcd}, filesystem {filesystem}, frameProfiler {frameProfiler} {
 }
 
 void LittleVgl::Init() {
@@ -132,27 +136,42 @@ void LittleVgl::InitFileSystem() {
 }
 
 void LittleVgl::SetFullRefresh(FullRefreshDirections direction) {
-  if (scrollDirection == FullRefreshDirections::None) {
-    scrollDirection = direction;
-    if (scrollDirection == FullRefreshDirections::Down) {
-      lv_disp_set_direction(lv_disp_get_default(), 1);
-    } else if (scrollDirection == FullRefreshDirections::Right) {
-      lv_disp_set_direction(lv_disp_get_default(), 2);
-    } else if (scrollDirection == FullRefreshDirections::Left) {
-      lv_disp_set_direction(lv_disp_get_default(), 3);
-    } else if (scrollDirection == FullRefreshDirections::RightAnim) {
-      lv_disp_set_direction(lv_disp_get_default(), 5);
-    } else if (scrollDirection == FullRefreshDirections::LeftAnim) {
-      lv_disp_set_direction(lv_disp_get_default(), 4);
-    }
+  if (scrollDirection != FullRefreshDirections::None) {
+    // The screen of the previous transition is replaced before being completely flushed: the new transition starts
+    // from what is displayed now
+    EndTransition();
+  }
+  scrollDirection = direction;
+  if (scrollDirection == FullRefreshDirections::Down) {
+    lv_disp_set_direction(lv_disp_get_default(), 1);
+  } else if (scrollDirection == FullRefreshDirections::Right) {
+    lv_disp_set_direction(lv_disp_get_default(), 2);
+  } else if (scrollDirection == FullRefreshDirections::Left) {
+    lv_disp_set_direction(lv_disp_get_default(), 3);
+  } else if (scrollDirection == FullRefreshDirections::RightAnim) {
+    lv_disp_set_direction(lv_disp_get_default(), 5);
+  } else if (scrollDirection == FullRefreshDirections::LeftAnim) {
+    lv_disp_set_direction(lv_disp_get_default(), 4);
   }
   fullRefresh = true;
 }
 
+void LittleVgl::EndTransition() {
+  // The lines written so far are displayed, so that the writes that follow land on the visible lines
+  if (scrollOffset != writeOffset) {
+    scrollOffset = writeOffset;
+    lcd.VerticalScrollStartAddress(scrollOffset);
+  }
+  scrollDirection = FullRefreshDirections::None;
+  lv_disp_set_direction(lv_disp_get_default(), 0);
+}
+
 void LittleVgl::FlushDisplay(const lv_area_t* area, lv_color_t* color_p) {
   uint16_t y1, y2, width, height = 0;
 
+  auto waitStart = frameProfiler.StartWaiting();
   ulTaskNotifyTake(pdTRUE, 200);
+  frameProfiler.EndWaiting(waitStart);
   // Notification is still needed (even if there is a mutex on SPI) because of the DataCommand pin
   // which cannot be set/clear during a transfer.
 
@@ -167,6 +186,7 @@ void LittleVgl::FlushDisplay(const lv_area_t* area, lv_color_t* color_p) {
 
   width = (area->x2 - area->x1) + 1;
   height = (area->y2 - area->y1) + 1;
+  frameProfiler.OnFlush(width * height);
 
   if (scrollDirection == LittleVgl::FullRefreshDirections::Down) {
 
@@ -174,8 +194,6 @@ void LittleVgl::FlushDisplay(const lv_area_t* area, lv_color_t* color_p) {
       uint16_t toScroll = 0;
       if (area->y1 == 0) {
         toScroll = height * 2;
-        scrollDirection = FullRefreshDirections::None;
-        lv_disp_set_direction(lv_disp_get_default(), 0);
       } else {
         toScroll = height;
       }
@@ -187,6 +205,9 @@ void LittleVgl::FlushDisplay(const lv_area_t* area, lv_color_t* color_p) {
         scrollOffset = (totalNbLines) -toScroll;
       }
       lcd.VerticalScrollStartAddress(scrollOffset);
+      if (area->y1 == 0) {
+        EndTransition();
+      }
     }
 
   } else if (scrollDirection == FullRefreshDirections::Up) {
@@ -194,23 +215,22 @@ void LittleVgl::FlushDisplay(const lv_area_t* area, lv_color_t* color_p) {
     if (area->y1 > 0) {
       if (area->y2 == visibleNbLines - 1) {
         scrollOffset += (height * 2);
-        scrollDirection = FullRefreshDirections::None;
-        lv_disp_set_direction(lv_disp_get_default(), 0);
       } else {
         scrollOffset += height;
       }
       scrollOffset = scrollOffset % totalNbLines;
       lcd.VerticalScrollStartAddress(scrollOffset);
+      if (area->y2 == visibleNbLines - 1) {
+        EndTransition();
+      }
     }
   } else if (scrollDirection == FullRefreshDirections::Left or scrollDirection == FullRefreshDirections::LeftAnim) {
     if (area->x2 == visibleNbLines - 1) {
-      scrollDirection = FullRefreshDirections::None;
-      lv_disp_set_direction(lv_disp_get_default(), 0);
+      EndTransition();
     }
   } else if (scrollDirection == FullRefreshDirections::Right or scrollDirection == FullRefreshDirections::RightAnim) {
     if (area->x1 == 0) {
-      scrollDirection = FullRefreshDirections::None;
-      lv_disp_set_direction(lv_disp_get_default(), 0);
+      EndTransition();
     }
   }
 
@@ -219,15 +239,20 @@ void LittleVgl::FlushDisplay(const lv_area_t* area, lv_color_t* color_p) {
 
     if (height > 0) {
       lcd.DrawBuffer(area->x1, y1, width, height, reinterpret_cast<const uint8_t*>(color_p), width * height * 2);
+      frameProfiler.OnDrawBuffer(width * height * 2);
+      waitStart = frameProfiler.StartWaiting();
       ulTaskNotifyTake(pdTRUE, 100);
+      frameProfiler.EndWaiting(waitStart);
     }
 
     uint16_t pixOffset = width * height;
     height = y2 + 1;
     lcd.DrawBuffer(area->x1, 0, width, height, reinterpret_cast<const uint8_t*>(color_p + pixOffset), width * height * 2);
+    frameProfiler.OnDrawBuffer(width * height * 2);
 
   } else {
     lcd.DrawBuffer(area->x1, y1, width, height, reinterpret_cast<const uint8_t*>(color_p), width * height * 2);
+    frameProfiler.OnDrawBuffer(width * height * 2);
   }
 
   // IMPORTANT!!!
@@ -8,11 +8,15 @@ namespace Pinetime {
     class St7789;
   }
 
+  namespace Controllers {
+    class FrameProfiler;
+  }
+
   namespace Components {
     class LittleVgl {
     public:
       enum class FullRefreshDirections { None, Up, Down, Left, Right, LeftAnim, RightAnim };
-      LittleVgl(Pinetime::Drivers::St7789& lcd, Pinetime::Controllers::FS& filesystem);
+      LittleVgl(Pinetime::Drivers::St7789& lcd, Pinetime::Controllers::FS& filesystem, Pinetime::Controllers::FrameProfiler& frameProfiler);
 
       LittleVgl(const LittleVgl&) = delete;
       LittleVgl& operator=(const LittleVgl&) = delete;
@@ -39,9 +43,14 @@ namespace Pinetime {
       void InitDisplay();
       void InitTouchpad();
       void InitFileSystem();
+      // The vertical transitions write the incoming screen into the lines of the frame memory that are not displayed
+      // and scroll them in, one flushed strip at a time. The ST7789 only scrolls along its gate lines (vertically on
+      // the PineTime), so the horizontal transitions are flushed column by column instead.
+      void EndTransition();
 
       Pinetime::Drivers::St7789& lcd;
       Pinetime::Controllers::FS& filesystem;
+      Pinetime::Controllers::FrameProfiler& frameProfiler;
 
       lv_disp_buf_t disp_buf_2;
       lv_color_t buf2_1[LV_HOR_RES_MAX * 4];
@@ -5,60 +5,95 @@
 #include "Screen.h"
 
 
+#define SCREEN_CACHE_SIZE               2
+#define SCREEN_CACHE_MIN_FREE_HEAP      (8 * 1024)
 
-DefaultScreenGraph::DefaultScreenGraph(FullRefreshProvider *refreshProvider, ComponentContainer *components)
-        : ScreenGraph(refreshProvider, components)
-{
-        // set initial screen
-        switchScreen(ScreenTag::DefaultWatchFace, 1, TransitionEffect::None);
-
-        // transitions from UtilityWatchFace
-        addSwipeTransition(ScreenTag::UtilityWatchFace, ScreenTag::Settings, Screen::SwipeDirection::Up);
-        addSwipeTransition(ScreenTag::UtilityWatchFace, ScreenTag::InfographWatchFace, Screen::SwipeDirection::Left);
-
-        // transitions from InfographWatchFace
-        addSwipeTransition(ScreenTag::InfographWatchFace, ScreenTag::Settings, Screen::SwipeDirection::Up);
-        addSwipeTransition(ScreenTag::InfographWatchFace, ScreenTag::BinaryWatchFace, Screen::SwipeDirection::Left);
-
-        // transitions from BinaryWatchFace
-        addSwipeTransition(ScreenTag::BinaryWatchFace, ScreenTag::Settings, Screen::SwipeDirection::Up);
-        addSwipeTransition(ScreenTag::BinaryWatchFace, ScreenTag::UtilityWatchFace, Screen::SwipeDirection::Left);
 
-        // transitions from FirmwareValidation
-        addButtonTransition(ScreenTag::FirmwareValidation, ScreenTag::DefaultWatchFace);
-        addSwipeTransition(ScreenTag::FirmwareValidation, ScreenTag::Previous, Screen::SwipeDirection::Right);
 
-        // transitions from SystemInfo
-        addButtonTransition(ScreenTag::SystemInfo, ScreenTag::DefaultWatchFace);
-        addSwipeTransition(ScreenTag::SystemInfo, ScreenTag::Previous, Screen::SwipeDirection::Right);
+namespace
+{
+        using ScreenTag = ScreenGraph::ScreenTag;
+        using SwipeDirection = Screen::SwipeDirection;
+
+        constexpr ScreenGraph::Transition transitions[] = {
+                // transitions from UtilityWatchFace
+                ScreenGraph::swipeTransition(ScreenTag::UtilityWatchFace, ScreenTag::Settings, SwipeDirection::Up),
+                ScreenGraph::swipeTransition(ScreenTag::UtilityWatchFace, ScreenTag::InfographWatchFace, SwipeDirection::Left),
+
+                // transitions from InfographWatchFace
+                ScreenGraph::swipeTransition(ScreenTag::InfographWatchFace, ScreenTag::Settings, SwipeDirection::Up),
+                ScreenGraph::swipeTransition(ScreenTag::InfographWatchFace, ScreenTag::BinaryWatchFace, SwipeDirection::Left),
+
+                // transitions from BinaryWatchFace
+                ScreenGraph::swipeTransition(ScreenTag::BinaryWatchFace, ScreenTag::Settings, SwipeDirection::Up),
+                ScreenGraph::swipeTransition(ScreenTag::BinaryWatchFace, ScreenTag::UtilityWatchFace, SwipeDirection::Left),
+
+                // transitions from FirmwareValidation
+                ScreenGraph::buttonTransition(ScreenTag::FirmwareValidation, ScreenTag::DefaultWatchFace),
+                ScreenGraph::swipeTransition(ScreenTag::FirmwareValidation, ScreenTag::Previous, SwipeDirection::Right),
+
+                // transitions from SystemInfo
+                ScreenGraph::buttonTransition(ScreenTag::SystemInfo, ScreenTag::DefaultWatchFace),
+                ScreenGraph::swipeTransition(ScreenTag::SystemInfo, ScreenTag::Previous, SwipeDirection::Right),
+
+                // transitions from Settings
+                ScreenGraph::buttonTransition(ScreenTag::Settings, ScreenTag::DefaultWatchFace),
+                ScreenGraph::swipeTransition(ScreenTag::Settings, ScreenTag::DefaultWatchFace, SwipeDirection::Down),
+
+                // transitions from Brightness
+                ScreenGraph::buttonTransition(ScreenTag::Brightness, ScreenTag::DefaultWatchFace),
+                ScreenGraph::swipeTransition(ScreenTag::Brightness, ScreenTag::Previous, SwipeDirection::Right),
+
+                // transitions from WakeUpMode
+                ScreenGraph::buttonTransition(ScreenTag::WakeUpMode, ScreenTag::DefaultWatchFace),
+                ScreenGraph::swipeTransition(ScreenTag::WakeUpMode, ScreenTag::Previous, SwipeDirection::Right),
+
+                // transitions from StepsGoal
+                ScreenGraph::buttonTransition(ScreenTag::StepsGoal, ScreenTag::DefaultWatchFace),
+                ScreenGraph::swipeTransition(ScreenTag::StepsGoal, ScreenTag::Previous, SwipeDirection::Right),
+        };
+
+        // in the order of the watch face index stored in the settings
+        constexpr ScreenTag watchFaces[] = {
+                ScreenTag::UtilityWatchFace,
+                ScreenTag::InfographWatchFace,
+                ScreenTag::BinaryWatchFace
+        };
+
+        // screens activated by DisplayApp and by the buttons of the settings
+        constexpr ScreenGraph::ScreenLink links[] = {
+                {ScreenTag::None, ScreenTag::DefaultWatchFace},
+                {ScreenTag::None, ScreenTag::FirmwareUpdate},
+                {ScreenTag::Settings, ScreenTag::Brightness},
+                {ScreenTag::Settings, ScreenTag::WakeUpMode},
+                {ScreenTag::Settings, ScreenTag::StepsGoal},
+                {ScreenTag::Settings, ScreenTag::SystemInfo},
+                {ScreenTag::Settings, ScreenTag::FirmwareValidation}
+        };
+
+        constexpr ScreenGraph::TransitionTable transitionTable {transitions};
+
+        static_assert(transitionTable.isValid(), "invalid or duplicate transition");
+        static_assert(transitionTable.reachesAllScreens(watchFaces, links), "a screen cannot be reached");
+}
 
-        // transitions from Settings
-        addButtonTransition(ScreenTag::Settings, ScreenTag::DefaultWatchFace);
-        addSwipeTransition(ScreenTag::Settings, ScreenTag::DefaultWatchFace, Screen::SwipeDirection::Down);
 
-        // transitions from Brightness
-        addButtonTransition(ScreenTag::Brightness, ScreenTag::DefaultWatchFace);
-        addSwipeTransition(ScreenTag::Brightness, ScreenTag::Previous, Screen::SwipeDirection::Right);
 
-        // transitions from WakeUpMode
-        addButtonTransition(ScreenTag::WakeUpMode, ScreenTag::DefaultWatchFace);
-        addSwipeTransition(ScreenTag::WakeUpMode, ScreenTag::Previous, Screen::SwipeDirection::Right);
+DefaultScreenGraph::DefaultScreenGraph(FullRefreshProvider *refreshProvider, ComponentContainer *components)
+        : ScreenGraph(refreshProvider, components, transitionTable)
+{
+        // keep the watch face and the settings when switching between them
+        setScreenCache(SCREEN_CACHE_SIZE, SCREEN_CACHE_MIN_FREE_HEAP);
 
-        // transitions from StepsGoal
-        addButtonTransition(ScreenTag::StepsGoal, ScreenTag::DefaultWatchFace);
-        addSwipeTransition(ScreenTag::StepsGoal, ScreenTag::Previous, Screen::SwipeDirection::Right);
+        // set initial screen
+        switchScreen(ScreenTag::DefaultWatchFace, 1, TransitionEffect::None);
 }
 
 
 ScreenGraph::ScreenTag DefaultScreenGraph::watchFaceScreenTagByIndex(uint8_t watchFaceIndex)
 {
-        switch (watchFaceIndex)
-        {
-        case 1:
-                return ScreenTag::InfographWatchFace;
-        case 2:
-                return ScreenTag::BinaryWatchFace;
-        default:
-                return ScreenTag::UtilityWatchFace;
-        }
+        // the first watch face is the default one
+        if (watchFaceIndex >= sizeof(watchFaces) / sizeof(watchFaces[0]))
+                return watchFaces[0];
+        return watchFaces[watchFaceIndex];
 }
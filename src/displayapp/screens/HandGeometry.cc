@@ -0,0 +1,77 @@
+#include "HandGeometry.h"
+
+
+
+namespace
+{
+        constexpr uint16_t quarter = HANDGEOMETRY_POSITIONS / 4;
+
+        constexpr double pi = 3.14159265358979323846;
+
+        // Taylor series of the sine, accurate enough on [0, pi/2] to round correctly to Q15
+        constexpr double taylorSine(double x)
+        {
+                double term = x;
+                double sum = x;
+                for (int n = 1; n < 10; n++)
+                {
+                        term *= -x * x / static_cast<double>((2 * n) * (2 * n + 1));
+                        sum += term;
+                }
+                return sum;
+        }
+
+        // sine of the first quarter of the dial (positions 0 to 180 included), computed at compile time
+        struct QuarterSineTable
+        {
+                int16_t values[quarter + 1];
+
+                constexpr QuarterSineTable() : values {}
+                {
+                        for (uint16_t i = 0; i <= quarter; i++)
+                                values[i] = static_cast<int16_t>(taylorSine(static_cast<double>(i) * 2.0 * pi / HANDGEOMETRY_POSITIONS) * 32767.0 + 0.5);
+                }
+        };
+
+        constexpr QuarterSineTable quarterSine;
+
+        static_assert(quarterSine.values[0] == 0, "sin(0) must be 0");
+        static_assert(quarterSine.values[quarter] == 32767, "sin(pi/2) must be 1");
+        static_assert((quarterSine.values[quarter / 3] >= 16383) && (quarterSine.values[quarter / 3] <= 16384), "sin(pi/6) must be 0.5");
+}
+
+
+
+int16_t HandGeometry::sine(uint16_t position)
+{
+        position %= HANDGEOMETRY_POSITIONS;
+        uint16_t index = position % quarter;
+        switch (position / quarter)
+        {
+                case 0:
+                        return quarterSine.values[index];
+                case 1:
+                        return quarterSine.values[quarter - index];
+                case 2:
+                        return static_cast<int16_t>(-quarterSine.values[index]);
+                default:
+                        return static_cast<int16_t>(-quarterSine.values[quarter - index]);
+        }
+}
+
+
+lv_point_t HandGeometry::point(uint16_t position, int16_t radius)
+{
+        // multiply and round half away from zero, like the previous floating point implementation
+        auto scale = [radius](int16_t value) -> lv_coord_t {
+                int32_t product = static_cast<int32_t>(radius) * value;
+                if (product < 0)
+                        return static_cast<lv_coord_t>(-((-product + (1 << 14)) >> 15));
+                return static_cast<lv_coord_t>((product + (1 << 14)) >> 15);
+        };
+
+        lv_point_t point;
+        point.x = static_cast<lv_coord_t>(LV_HOR_RES / 2 + scale(sine(position)));
+        point.y = static_cast<lv_coord_t>(LV_VER_RES / 2 - scale(cosine(position)));
+        return point;
+}
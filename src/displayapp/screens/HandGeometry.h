@@ -0,0 +1,37 @@
+#ifndef HANDGEOMETRY_H
+#define HANDGEOMETRY_H
+
+
+#include <cstdint>
+#include <lvgl/lvgl.h>
+
+
+// number of positions of a hand on the dial (one per minute of 12 hours, i.e. half a degree)
+#define HANDGEOMETRY_POSITIONS   720
+
+
+
+// Geometry of the hands of the analog watch faces, using a precomputed Q15 sine table instead of
+// floating point trigonometry. The positions are counted clockwise from 12 o'clock.
+class HandGeometry
+{
+public:
+
+        // position of the hour hand (720 positions per turn)
+        static uint16_t hourPosition(uint8_t hour, uint8_t minute) { return static_cast<uint16_t>((hour % 12) * 60 + minute); }
+
+        // position of the minute hand, moving every 5 seconds
+        static uint16_t minutePosition(uint8_t minute, uint8_t second) { return static_cast<uint16_t>((minute * 60 + second) / 5); }
+
+        // position of the second hand (60 positions per turn)
+        static uint16_t secondPosition(uint8_t second) { return static_cast<uint16_t>(second * (HANDGEOMETRY_POSITIONS / 60)); }
+
+        // sine and cosine of the angle of a position, in Q15 format
+        static int16_t sine(uint16_t position);
+        static int16_t cosine(uint16_t position) { return sine(position + HANDGEOMETRY_POSITIONS / 4); }
+
+        // point at the given distance of the center of the screen (a negative radius gives the opposite point)
+        static lv_point_t point(uint16_t position, int16_t radius);
+};
+
+#endif // HANDGEOMETRY_H
@@ -3,6 +3,8 @@
 
 
 #include "WatchFace.h"
+#include "RedrawPlanner.h"
+#include "HandGeometry.h"
 
 
 
@@ -53,10 +55,11 @@ private:
 
         lv_style_t _basicArcStyle;
 
+        RedrawPlanner _handsPlanner;
+
         void updateHands(bool hourChanged, bool minuteChanged);
         void updatePowerAndBleSymbols();
 
-        int16_t roundedCoord(double value);
         uint16_t stepsEndAngle(uint32_t steps);
 };
 
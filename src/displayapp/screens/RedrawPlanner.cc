@@ -0,0 +1,149 @@
+#include "RedrawPlanner.h"
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+
+
+uint32_t RedrawPlanner::_pixelsThisSecond = 0;
+uint32_t RedrawPlanner::_pixelsLastSecond = 0;
+uint32_t RedrawPlanner::_secondStartTick = 0;
+
+
+
+RedrawPlanner::RedrawPlanner()
+{
+        _moveCount = 0;
+        _areaCount = 0;
+}
+
+
+void RedrawPlanner::addLine(lv_obj_t *line)
+{
+        // the size of the object is set by the planner
+        lv_line_set_auto_size(line, false);
+}
+
+
+void RedrawPlanner::moveLine(lv_obj_t *line, lv_point_t *points, lv_point_t start, lv_point_t end)
+{
+        // guards
+        if (_moveCount >= REDRAWPLANNER_MAX_MOVES)
+                return;
+
+        // the object covers the bounding box of the points, the points are relative to it
+        Move &move = _moves[_moveCount];
+        move.line = line;
+        move.points = points;
+        move.coords.x1 = LV_MATH_MIN(start.x, end.x);
+        move.coords.y1 = LV_MATH_MIN(start.y, end.y);
+        move.coords.x2 = LV_MATH_MAX(start.x, end.x);
+        move.coords.y2 = LV_MATH_MAX(start.y, end.y);
+        move.start = {static_cast<lv_coord_t>(start.x - move.coords.x1), static_cast<lv_coord_t>(start.y - move.coords.y1)};
+        move.end = {static_cast<lv_coord_t>(end.x - move.coords.x1), static_cast<lv_coord_t>(end.y - move.coords.y1)};
+
+        // nothing to do if the line does not move
+        lv_area_t current;
+        lv_obj_get_coords(line, &current);
+        if ((current.x1 == move.coords.x1) && (current.y1 == move.coords.y1) &&
+            (current.x2 == move.coords.x2) && (current.y2 == move.coords.y2) &&
+            (points[0].x == move.start.x) && (points[0].y == move.start.y) &&
+            (points[1].x == move.end.x) && (points[1].y == move.end.y))
+                return;
+
+        _moveCount++;
+}
+
+
+void RedrawPlanner::commit()
+{
+        if (_moveCount == 0)
+                return;
+
+        // collect the old and new areas of the lines, including the extra area in which LVGL draws the line
+        // caps (this is also what lv_obj_invalidate() uses)
+        _areaCount = 0;
+        for (uint8_t i = 0; i < _moveCount; i++)
+        {
+                lv_area_t current;
+                lv_obj_get_coords(_moves[i].line, &current);
+                addArea(current, _moves[i].line->ext_draw_pad);
+                addArea(_moves[i].coords, _moves[i].line->ext_draw_pad);
+        }
+        mergeAreas();
+
+        // invalidate the merged areas first, so that the invalidations done while moving the objects are
+        // already covered and ignored by lv_inv_area()
+        lv_disp_t *display = lv_disp_get_default();
+        uint32_t pixels = 0;
+        for (uint8_t i = 0; i < _areaCount; i++)
+        {
+                _lv_inv_area(display, &_areas[i]);
+                pixels += lv_area_get_size(&_areas[i]);
+        }
+        countPixels(pixels);
+
+        // move the lines
+        for (uint8_t i = 0; i < _moveCount; i++)
+        {
+                Move &move = _moves[i];
+                move.points[0] = move.start;
+                move.points[1] = move.end;
+                lv_obj_set_pos(move.line, move.coords.x1, move.coords.y1);
+                lv_obj_set_size(move.line, lv_area_get_width(&move.coords), lv_area_get_height(&move.coords));
+                lv_line_set_points(move.line, move.points, 2);
+        }
+        _moveCount = 0;
+}
+
+
+void RedrawPlanner::addArea(const lv_area_t &area, lv_coord_t padding)
+{
+        // clip the area to the screen
+        lv_area_t screen = {0, 0, LV_HOR_RES - 1, LV_VER_RES - 1};
+        lv_area_t padded = {static_cast<lv_coord_t>(area.x1 - padding), static_cast<lv_coord_t>(area.y1 - padding),
+                            static_cast<lv_coord_t>(area.x2 + padding), static_cast<lv_coord_t>(area.y2 + padding)};
+        if (_lv_area_intersect(&_areas[_areaCount], &padded, &screen))
+                _areaCount++;
+}
+
+
+void RedrawPlanner::mergeAreas()
+{
+        // merge two areas whenever the rectangle containing both is smaller than the two areas redrawn
+        // separately (the same rule LVGL uses when joining the invalidated areas)
+        bool merged = true;
+        while (merged)
+        {
+                merged = false;
+                for (uint8_t i = 0; (i < _areaCount) && !merged; i++)
+                {
+                        for (uint8_t j = i + 1; (j < _areaCount) && !merged; j++)
+                        {
+                                lv_area_t joined;
+                                _lv_area_join(&joined, &_areas[i], &_areas[j]);
+                                if (lv_area_get_size(&joined) <= lv_area_get_size(&_areas[i]) + lv_area_get_size(&_areas[j]))
+                                {
+                                        _areas[i] = joined;
+                                        _areas[j] = _areas[_areaCount - 1];
+                                        _areaCount--;
+                                        merged = true;
+                                }
+                        }
+                }
+        }
+}
+
+
+void RedrawPlanner::countPixels(uint32_t pixels)
+{
+        TickType_t now = xTaskGetTickCount();
+        if (now - _secondStartTick >= configTICK_RATE_HZ)
+        {
+                // no redraw during the last complete second if more than one second elapsed
+                _pixelsLastSecond = (now - _secondStartTick < 2 * configTICK_RATE_HZ) ? _pixelsThisSecond : 0;
+                _pixelsThisSecond = 0;
+                _secondStartTick = now;
+        }
+        _pixelsThisSecond += pixels;
+}
@@ -0,0 +1,65 @@
+#ifndef REDRAWPLANNER_H
+#define REDRAWPLANNER_H
+
+
+#include <lvgl/lvgl.h>
+
+
+#define REDRAWPLANNER_MAX_MOVES   8
+#define REDRAWPLANNER_MAX_AREAS   (2 * REDRAWPLANNER_MAX_MOVES)
+
+
+
+// Moves line objects (the hands of the analog watch faces) while keeping the redrawn areas small.
+//
+// lv_line_set_points() with auto-size enabled invalidates the rectangle between the origin of the parent and
+// the furthest point of the line, which is most of the screen for a hand pointing down-right. The planner
+// instead places each line object on the bounding box of its points and, before anything is moved, invalidates
+// the old and new bounding boxes of all the lines that changed, merged where merging saves pixels. The
+// invalidations done by LVGL while moving the objects then fall inside these areas and are dropped.
+class RedrawPlanner
+{
+public:
+
+        RedrawPlanner();
+
+        // Must be called once for every line object handled by the planner
+        void addLine(lv_obj_t *line);
+
+        // Queues the move of a line. The points are written to the given array (which must stay valid as long
+        // as the line object exists) when commit() is called.
+        void moveLine(lv_obj_t *line, lv_point_t *points, lv_point_t start, lv_point_t end);
+
+        // Invalidates the areas to redraw and moves the lines queued since the previous call
+        void commit();
+
+        // Number of pixels invalidated by all planners during the last complete second
+        static uint32_t pixelsRedrawnPerSecond() { return _pixelsLastSecond; }
+
+private:
+
+        struct Move
+        {
+                lv_obj_t *line;
+                lv_point_t *points;
+                lv_area_t coords;
+                lv_point_t start;
+                lv_point_t end;
+        };
+
+        Move _moves[REDRAWPLANNER_MAX_MOVES];
+        uint8_t _moveCount;
+
+        lv_area_t _areas[REDRAWPLANNER_MAX_AREAS];
+        uint8_t _areaCount;
+
+        static uint32_t _pixelsThisSecond;
+        static uint32_t _pixelsLastSecond;
+        static uint32_t _secondStartTick;
+
+        void addArea(const lv_area_t &area, lv_coord_t padding);
+        void mergeAreas();
+        void countPixels(uint32_t pixels);
+};
+
+#endif // REDRAWPLANNER_H
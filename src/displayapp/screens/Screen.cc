@@ -2,6 +2,8 @@
 
 #include <lvgl/lvgl.h>
 
+#include "ScreenGraph.h"
+
 #include "displayapp/fonts/font_dvsb_ascii_18.h"
 #include "displayapp/fonts/font_dvs_ascii_12.h"
 #include "displayapp/fonts/font_symbols_14.h"
@@ -15,8 +17,9 @@ Screen::Screen(ScreenGraph *screenGraph, ComponentContainer *components)
         _screenGraph = screenGraph;
         _components = components;
 
-        // clear the screen, the constructor of the derived class will refill it
-        lv_obj_clean(lv_scr_act());
+        // create an empty lvgl screen, the constructor of the derived class will fill it
+        _lvScreen = lv_obj_create(nullptr, nullptr);
+        lv_scr_load(_lvScreen);
 
         //lv_obj_set_scrollbar_mode(lv_scr_act(), LV_SCROLLBAR_MODE_OFF);
 
@@ -44,8 +47,15 @@ Screen::Screen(ScreenGraph *screenGraph, ComponentContainer *components)
 
 Screen::~Screen()
 {
-        // delete the lvgl child objects
-        lv_obj_clean(lv_scr_act());
+        // delete the lvgl screen and its child objects
+        lv_obj_del(_lvScreen);
+}
+
+
+void Screen::show()
+{
+        // make the lvgl screen active again (it is redrawn completely)
+        lv_scr_load(_lvScreen);
 }
 
 
@@ -56,7 +66,7 @@ bool Screen::setCurrentPage(uint8_t value)
                 return false;
 
         // remove the widgets of the previous page
-        lv_obj_clean(lv_scr_act());
+        lv_obj_clean(_lvScreen);
 
         // create the new page
         _currentPage = value;
@@ -98,7 +108,7 @@ bool Screen::handleDoubleTap()
 
 bool Screen::handleSwipe(SwipeDirection direction)
 {
-        // swiping up and down is automatically handled in multi-page screens
+        // swiping up and down is automatically handled in multi-page screens, the pages are scrolled like the screens
         if (isMultiPageScreen())
         {
                 switch (direction)
@@ -106,6 +116,7 @@ bool Screen::handleSwipe(SwipeDirection direction)
                 case SwipeDirection::Up:     // next page
                         if (_currentPage < pageCount())
                         {
+                                _screenGraph->startTransition(ScreenGraph::TransitionEffect::MoveTop);
                                 setCurrentPage(_currentPage + 1);
                                 return true;
                         }
@@ -113,6 +124,7 @@ bool Screen::handleSwipe(SwipeDirection direction)
                 case SwipeDirection::Down:   // previous page
                         if (_currentPage > 1)
                         {
+                                _screenGraph->startTransition(ScreenGraph::TransitionEffect::MoveBottom);
                                 setCurrentPage(_currentPage - 1);
                                 return true;
                         }
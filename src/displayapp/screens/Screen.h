@@ -32,6 +32,10 @@ public:
 
         bool isRunning() const { return _isRunning; }
 
+        // screens that can be kept hidden by the ScreenGraph and shown again as they are
+        virtual bool isCacheable() const { return false; }
+        void show();
+
         virtual lv_color_t backgroundColor() const { return lv_color_hex(0x000000); }
         virtual lv_color_t foregroundColor() const { return lv_color_hex(0xffffff); }
 
@@ -69,6 +73,7 @@ private:
 
         ScreenGraph *_screenGraph;
         ComponentContainer *_components;
+        lv_obj_t *_lvScreen;
 
         uint8_t _currentPage;
 
@@ -1,5 +1,7 @@
 #include "ScreenGraph.h"
 
+#include <FreeRTOS.h>
+
 #include "Screen.h"
 
 #include "displayapp/FullRefreshProvider.h"
@@ -16,11 +18,10 @@
 
 
 #define BUTTON_DEBOUNCE_TICKS   500
-#define MAX_PREVIOUS_SCREENS    4
 
 
 
-ScreenGraph::ScreenGraph(FullRefreshProvider *refreshProvider, ComponentContainer *components)
+ScreenGraph::ScreenGraph(FullRefreshProvider *refreshProvider, ComponentContainer *components, const TransitionTable &transitions)
 {
         _refreshProvider = refreshProvider;
         _components = components;
@@ -29,9 +30,12 @@ ScreenGraph::ScreenGraph(FullRefreshProvider *refreshProvider, ComponentContaine
         _nextPageNumber = 1;
         _nextEffect = TransitionEffect::None;
         _currentScreen = nullptr;
-        _transitions.clear();
+        _transitions = &transitions;
         _lastButtonPressTicks = 0;
-        _previousScreens.clear();
+        _previousScreenCount = 0;
+        _cachedScreenCount = 0;
+        _maxCachedScreens = 0;
+        _minFreeHeapForCache = 0;
 }
 
 
@@ -40,97 +44,10 @@ ScreenGraph::~ScreenGraph()
         // delete the current screen
         if (_currentScreen)
                 delete _currentScreen;
-}
-
-
-void ScreenGraph::addButtonTransition(ScreenTag fromScreen, ScreenTag toScreen, TransitionEffect effect)
-{
-        addButtonTransition(fromScreen, toScreen, 1, effect);
-}
-
-
-void ScreenGraph::addButtonTransition(ScreenTag fromScreen, ScreenTag toScreen, uint8_t toPageNumber, TransitionEffect effect)
-{
-        // guards
-        if ((fromScreen == ScreenTag::None) || (fromScreen == ScreenTag::Previous) || (toScreen == ScreenTag::None))
-                return;
-
-        // add the transition
-        Transition transition;
-        transition.trigger = TransitionTrigger::Button;
-        transition.swipeDirection = Screen::SwipeDirection::None;
-        transition.fromScreen = fromScreen;
-        transition.toScreen = toScreen;
-        transition.toPageNumber = toPageNumber;
-        transition.effect = effect;
-        _transitions.push_back(transition);
-}
-
-
-void ScreenGraph::addSwipeTransition(ScreenTag fromScreen, ScreenTag toScreen, Screen::SwipeDirection direction)
-{
-        addSwipeTransition(fromScreen, toScreen, 1, direction);
-}
-
-
-void ScreenGraph::addSwipeTransition(ScreenTag fromScreen, ScreenTag toScreen, uint8_t toPageNumber, Screen::SwipeDirection direction)
-{
-        // guards
-        if ((fromScreen == ScreenTag::None) || (fromScreen == ScreenTag::Previous) || (toScreen == ScreenTag::None))
-                return;
-        if (direction == Screen::SwipeDirection::None)
-                return;
-
-        // add the transition
-        Transition transition;
-        transition.trigger = TransitionTrigger::Swipe;
-        transition.swipeDirection = direction;
-        transition.fromScreen = fromScreen;
-        transition.toScreen = toScreen;
-        transition.toPageNumber = toPageNumber;
-        switch (direction)
-        {
-        case Screen::SwipeDirection::Left:
-                transition.effect = TransitionEffect::MoveLeft;
-                break;
-        case Screen::SwipeDirection::Right:
-                transition.effect = TransitionEffect::MoveRight;
-                break;
-        case Screen::SwipeDirection::Up:
-                transition.effect = TransitionEffect::MoveTop;
-                break;
-        case Screen::SwipeDirection::Down:
-                transition.effect = TransitionEffect::MoveBottom;
-                break;
-        default:
-                transition.effect = TransitionEffect::None;
-                break;
-        }
-        _transitions.push_back(transition);
-}
 
-
-void ScreenGraph::addInactivityTransition(ScreenTag fromScreen, ScreenTag toScreen, TransitionEffect effect)
-{
-        addInactivityTransition(fromScreen, toScreen, 1, effect);
-}
-
-
-void ScreenGraph::addInactivityTransition(ScreenTag fromScreen, ScreenTag toScreen, uint8_t toPageNumber, TransitionEffect effect)
-{
-        // guards
-        if ((fromScreen == ScreenTag::None) || (fromScreen == ScreenTag::Previous) || (toScreen == ScreenTag::None))
-                return;
-
-        // add the transition
-        Transition transition;
-        transition.trigger = TransitionTrigger::Inactivity;
-        transition.swipeDirection = Screen::SwipeDirection::None;
-        transition.fromScreen = fromScreen;
-        transition.toScreen = toScreen;
-        transition.toPageNumber = toPageNumber;
-        transition.effect = effect;
-        _transitions.push_back(transition);
+        // delete the hidden screens
+        for (uint8_t i = 0; i < _cachedScreenCount; i++)
+                delete _cachedScreens[i].screen;
 }
 
 
@@ -167,6 +84,38 @@ void ScreenGraph::setDefaultWatchFace(ScreenTag tag)
 }
 
 
+void ScreenGraph::setScreenCache(uint8_t maxScreens, size_t minFreeHeap)
+{
+        _maxCachedScreens = (maxScreens < maxCachedScreens) ? maxScreens : maxCachedScreens;
+        _minFreeHeapForCache = minFreeHeap;
+        trimScreenCache();
+}
+
+
+void ScreenGraph::startTransition(TransitionEffect effect)
+{
+        // the vertical effects scroll the new screen in with the vertical scrolling of the LCD (a single write of
+        // the screen), the horizontal ones draw it column by column since the LCD cannot scroll horizontally
+        switch (effect)
+        {
+        case TransitionEffect::MoveLeft:
+                _refreshProvider->SetFullRefresh(FullRefreshProvider::FullRefreshDirections::Right);
+                break;
+        case TransitionEffect::MoveRight:
+                _refreshProvider->SetFullRefresh(FullRefreshProvider::FullRefreshDirections::Left);
+                break;
+        case TransitionEffect::MoveTop:
+                _refreshProvider->SetFullRefresh(FullRefreshProvider::FullRefreshDirections::Up);
+                break;
+        case TransitionEffect::MoveBottom:
+                _refreshProvider->SetFullRefresh(FullRefreshProvider::FullRefreshDirections::Down);
+                break;
+        default:
+                break;
+        }
+}
+
+
 void ScreenGraph::handleRefresh()
 {
         // do we need to switch the screen?
@@ -197,18 +146,7 @@ bool ScreenGraph::handleButtonPress()
         }
 
         // check if there's a matching transition
-        for (Transition transition : _transitions)
-        {
-                if ((transition.trigger == TransitionTrigger::Button)
-                                && (transition.fromScreen == _currentTag))
-                {
-                        switchScreen(transition.toScreen, transition.toPageNumber, transition.effect);
-                        return true;
-                }
-        }
-
-        // unhandled
-        return false;
+        return handleTransition(TransitionTrigger::Button);
 }
 
 
@@ -222,18 +160,7 @@ bool ScreenGraph::handleTap()
         }
 
         // check if there's a matching transition
-        for (Transition transition : _transitions)
-        {
-                if ((transition.trigger == TransitionTrigger::Tap)
-                                && (transition.fromScreen == _currentTag))
-                {
-                        switchScreen(transition.toScreen, transition.toPageNumber, transition.effect);
-                        return true;
-                }
-        }
-
-        // unhandled
-        return false;
+        return handleTransition(TransitionTrigger::Tap);
 }
 
 
@@ -247,18 +174,7 @@ bool ScreenGraph::handleLongTap()
         }
 
         // check if there's a matching transition
-        for (Transition transition : _transitions)
-        {
-                if ((transition.trigger == TransitionTrigger::LongTap)
-                                && (transition.fromScreen == _currentTag))
-                {
-                        switchScreen(transition.toScreen, transition.toPageNumber, transition.effect);
-                        return true;
-                }
-        }
-
-        // unhandled
-        return false;
+        return handleTransition(TransitionTrigger::LongTap);
 }
 
 
@@ -272,18 +188,7 @@ bool ScreenGraph::handleDoubleTap()
         }
 
         // check if there's a matching transition
-        for (Transition transition : _transitions)
-        {
-                if ((transition.trigger == TransitionTrigger::DoubleTap)
-                                && (transition.fromScreen == _currentTag))
-                {
-                        switchScreen(transition.toScreen, transition.toPageNumber, transition.effect);
-                        return true;
-                }
-        }
-
-        // unhandled
-        return false;
+        return handleTransition(TransitionTrigger::DoubleTap);
 }
 
 
@@ -297,19 +202,7 @@ bool ScreenGraph::handleSwipe(Screen::SwipeDirection direction)
         }
 
         // check if there's a matching transition
-        for (Transition transition : _transitions)
-        {
-                if ((transition.trigger == TransitionTrigger::Swipe)
-                                && (transition.swipeDirection == direction)
-                                && (transition.fromScreen == _currentTag))
-                {
-                        switchScreen(transition.toScreen, transition.toPageNumber, transition.effect);
-                        return true;
-                }
-        }
-
-        // unhandled
-        return false;
+        return handleTransition(TransitionTrigger::Swipe, direction);
 }
 
 
@@ -322,6 +215,17 @@ bool ScreenGraph::handleTouch(int x, int y)
 }
 
 
+bool ScreenGraph::handleTransition(TransitionTrigger trigger, Screen::SwipeDirection direction)
+{
+        // look the transition up in the table
+        const TransitionTable::Target &target = _transitions->find(_currentTag, trigger, direction);
+        if (target.toScreen == ScreenTag::None)
+                return false;
+        switchScreen(target.toScreen, target.toPageNumber, target.effect);
+        return true;
+}
+
+
 void ScreenGraph::switchScreen(ScreenTag tag, uint8_t pageNumber, TransitionEffect effect)
 {
         // clear the "next screen" information
@@ -337,28 +241,28 @@ void ScreenGraph::switchScreen(ScreenTag tag, uint8_t pageNumber, TransitionEffe
         if (tag == ScreenTag::Previous)
         {
                 // the screens stack must not be empty
-                if (_previousScreens.empty())
+                if (_previousScreenCount == 0)
                         return;
 
-                // update destination tag and page number
-                ScreenInfo prevScreen = _previousScreens.back();
-                tag = prevScreen.tag;
-                pageNumber = prevScreen.pageNumber;
-
-                // remove that screen from the stack
-                _previousScreens.pop_back();
+                // remove the last screen from the stack and update destination tag and page number
+                _previousScreenCount--;
+                tag = _previousScreens[_previousScreenCount].tag;
+                pageNumber = _previousScreens[_previousScreenCount].pageNumber;
         }
         else
         {
-                // make sure that the screens stack doesn't exceed its maximum size
-                while (static_cast<int>(_previousScreens.size()) >= MAX_PREVIOUS_SCREENS)
-                        _previousScreens.erase(_previousScreens.begin());
+                // when the screens stack is full, forget the oldest screen
+                if (_previousScreenCount == maxPreviousScreens)
+                {
+                        for (uint8_t i = 1; i < maxPreviousScreens; i++)
+                                _previousScreens[i - 1] = _previousScreens[i];
+                        _previousScreenCount--;
+                }
 
                 // remember the current screen
-                ScreenInfo screen;
-                screen.tag = _currentTag;
-                screen.pageNumber = _currentScreen ? _currentScreen->currentPage() : 1;
-                _previousScreens.push_back(screen);
+                _previousScreens[_previousScreenCount].tag = _currentTag;
+                _previousScreens[_previousScreenCount].pageNumber = _currentScreen ? _currentScreen->currentPage() : 1;
+                _previousScreenCount++;
         }
 
         // handle another special case: tag == DefaultWatchFace
@@ -370,41 +274,90 @@ void ScreenGraph::switchScreen(ScreenTag tag, uint8_t pageNumber, TransitionEffe
                 // stay on the current screen if no valid tag has been returned
                 if (tag == ScreenTag::None)
                 {
-                        _previousScreens.pop_back();
+                        _previousScreenCount--;
                         return;
                 }
         }
 
         // set "full refresh direction" in LittleVgl
-        switch (effect)
-        {
-        case TransitionEffect::MoveLeft:
-                _refreshProvider->SetFullRefresh(FullRefreshProvider::FullRefreshDirections::Right);
-                break;
-        case TransitionEffect::MoveRight:
-                _refreshProvider->SetFullRefresh(FullRefreshProvider::FullRefreshDirections::Left);
-                break;
-        case TransitionEffect::MoveTop:
-                _refreshProvider->SetFullRefresh(FullRefreshProvider::FullRefreshDirections::Up);
-                break;
-        case TransitionEffect::MoveBottom:
-                _refreshProvider->SetFullRefresh(FullRefreshProvider::FullRefreshDirections::Down);
-                break;
-        default:
-                break;
-        }
-
-        (void)effect;
+        startTransition(effect);
 
-        // delete the old screen and create the new one
+        // hide or delete the old screen
         if (_currentScreen)
-                delete _currentScreen;
-        _currentScreen = createScreen(tag);
+                releaseScreen(_currentTag, _currentScreen);
+
+        // show the cached screen, or create a new one
+        _currentScreen = takeCachedScreen(tag);
         if (_currentScreen)
         {
                 _currentTag = tag;
-                _currentScreen->setCurrentPage(pageNumber);
+                _currentScreen->show();
+                if (_currentScreen->currentPage() != pageNumber)
+                        _currentScreen->setCurrentPage(pageNumber);
         }
+        else
+        {
+                // make room for the new screen
+                trimScreenCache();
+                _currentScreen = createScreen(tag);
+                if (_currentScreen)
+                {
+                        _currentTag = tag;
+                        _currentScreen->setCurrentPage(pageNumber);
+                }
+        }
+        trimScreenCache();
+}
+
+
+void ScreenGraph::releaseScreen(ScreenTag tag, Screen *screen)
+{
+        // screens that are not running anymore must be rebuilt
+        if ((_maxCachedScreens == 0) || !screen->isCacheable() || !screen->isRunning())
+        {
+                delete screen;
+                return;
+        }
+        if (_cachedScreenCount == maxCachedScreens)
+                deleteCachedScreen(0);
+        _cachedScreens[_cachedScreenCount].tag = tag;
+        _cachedScreens[_cachedScreenCount].screen = screen;
+        _cachedScreenCount++;
+}
+
+
+Screen *ScreenGraph::takeCachedScreen(ScreenTag tag)
+{
+        for (uint8_t i = 0; i < _cachedScreenCount; i++)
+        {
+                if (_cachedScreens[i].tag == tag)
+                {
+                        Screen *screen = _cachedScreens[i].screen;
+                        _cachedScreens[i].screen = nullptr;
+                        deleteCachedScreen(i);
+                        return screen;
+                }
+        }
+        return nullptr;
+}
+
+
+void ScreenGraph::deleteCachedScreen(uint8_t index)
+{
+        if (_cachedScreens[index].screen)
+                delete _cachedScreens[index].screen;
+        for (uint8_t i = index + 1; i < _cachedScreenCount; i++)
+                _cachedScreens[i - 1] = _cachedScreens[i];
+        _cachedScreenCount--;
+}
+
+
+void ScreenGraph::trimScreenCache()
+{
+        // delete the least recently used screens while the cache is too large or the heap is running low
+        while ((_cachedScreenCount > 0)
+                        && ((_cachedScreenCount > _maxCachedScreens) || (xPortGetFreeHeapSize() < _minFreeHeapForCache)))
+                deleteCachedScreen(0);
 }
 
 
@@ -2,8 +2,8 @@
 #define SCREENGRAPH_H
 
 
+#include <cstddef>
 #include <cstdint>
-#include <vector>
 
 #include "Screen.h"
 
@@ -16,7 +16,7 @@ class ScreenGraph
 {
 public:
 
-        enum class ScreenTag
+        enum class ScreenTag : uint8_t
         {
                 None,
                 Previous,
@@ -52,23 +52,213 @@ public:
                 MoveBottom
         };
 
+        // number of screen tags, StepsGoal must stay the last one
+        static constexpr uint8_t screenTagCount = static_cast<uint8_t>(ScreenTag::StepsGoal) + 1;
+
+        struct Transition
+        {
+        public:
+                TransitionTrigger trigger;
+                Screen::SwipeDirection swipeDirection;
+                ScreenTag fromScreen;
+                ScreenTag toScreen;
+                uint8_t toPageNumber;
+                TransitionEffect effect;
+        };
+
+        // screen activated by the code rather than by a transition of the graph (fromScreen is None for the screens
+        // activated by DisplayApp), only used to check that all the screens can be reached
+        struct ScreenLink
+        {
+        public:
+                ScreenTag fromScreen;
+                ScreenTag toScreen;
+        };
+
+        // transitions of a graph, built at compile time and indexed by screen and trigger (the swipes by direction)
+        class TransitionTable
+        {
+        public:
+
+                struct Target
+                {
+                public:
+                        ScreenTag toScreen;
+                        uint8_t toPageNumber;
+                        TransitionEffect effect;
+                };
+
+                template <size_t N>
+                constexpr TransitionTable(const Transition (&transitions)[N])
+                        : _targets {}, _noTarget {}, _valid {true}
+                {
+                        for (size_t i = 0; i < N; i++)
+                                add(transitions[i]);
+                }
+
+                // false if a transition is invalid or if two transitions have the same screen and trigger
+                constexpr bool isValid() const { return _valid; }
+
+                // the target of the transition, or a target whose toScreen is None
+                constexpr const Target &find(ScreenTag fromScreen, TransitionTrigger trigger, Screen::SwipeDirection direction) const
+                {
+                        return hasSlot(trigger, direction) ? _targets[static_cast<uint8_t>(fromScreen)][slot(trigger, direction)] : _noTarget;
+                }
+
+                // true if every screen can be reached from the screens activated by DisplayApp, DefaultWatchFace
+                // standing for any of the watch faces
+                template <size_t W, size_t L>
+                constexpr bool reachesAllScreens(const ScreenTag (&watchFaces)[W], const ScreenLink (&links)[L]) const
+                {
+                        bool reached[screenTagCount] {};
+                        for (size_t i = 0; i < L; i++)
+                        {
+                                if (links[i].fromScreen == ScreenTag::None)
+                                        reach(reached, links[i].toScreen, watchFaces);
+                        }
+
+                        // propagate until no new screen is reached
+                        bool changed = true;
+                        while (changed)
+                        {
+                                changed = false;
+                                for (uint8_t from = 0; from < screenTagCount; from++)
+                                {
+                                        if (!reached[from])
+                                                continue;
+                                        for (uint8_t i = 0; i < slotCount; i++)
+                                                changed = reach(reached, _targets[from][i].toScreen, watchFaces) || changed;
+                                        for (size_t i = 0; i < L; i++)
+                                        {
+                                                if (static_cast<uint8_t>(links[i].fromScreen) == from)
+                                                        changed = reach(reached, links[i].toScreen, watchFaces) || changed;
+                                        }
+                                }
+                        }
+
+                        for (uint8_t tag = static_cast<uint8_t>(ScreenTag::DefaultWatchFace) + 1; tag < screenTagCount; tag++)
+                        {
+                                if (!reached[tag])
+                                        return false;
+                        }
+                        return true;
+                }
+
+        private:
+
+                // Button, Swipe (Left, Right, Up, Down), Tap, LongTap, DoubleTap, Inactivity
+                static constexpr uint8_t slotCount = 9;
+
+                Target _targets[screenTagCount][slotCount];
+                Target _noTarget;
+                bool _valid;
+
+                static constexpr bool hasSlot(TransitionTrigger trigger, Screen::SwipeDirection direction)
+                {
+                        return (trigger == TransitionTrigger::Swipe) == (direction != Screen::SwipeDirection::None);
+                }
+
+                static constexpr uint8_t slot(TransitionTrigger trigger, Screen::SwipeDirection direction)
+                {
+                        return (trigger == TransitionTrigger::Swipe)
+                                ? static_cast<uint8_t>(direction)
+                                : ((trigger == TransitionTrigger::Button) ? 0 : static_cast<uint8_t>(trigger) + 3);
+                }
+
+                constexpr void add(const Transition &transition)
+                {
+                        if ((transition.fromScreen == ScreenTag::None) || (transition.fromScreen == ScreenTag::Previous)
+                                        || (transition.toScreen == ScreenTag::None)
+                                        || !hasSlot(transition.trigger, transition.swipeDirection))
+                        {
+                                _valid = false;
+                                return;
+                        }
+                        Target &target = _targets[static_cast<uint8_t>(transition.fromScreen)][slot(transition.trigger, transition.swipeDirection)];
+                        if (target.toScreen != ScreenTag::None)
+                                _valid = false;
+                        target.toScreen = transition.toScreen;
+                        target.toPageNumber = transition.toPageNumber;
+                        target.effect = transition.effect;
+                }
+
+                template <size_t W>
+                static constexpr bool reach(bool (&reached)[screenTagCount], ScreenTag tag, const ScreenTag (&watchFaces)[W])
+                {
+                        if ((tag == ScreenTag::None) || (tag == ScreenTag::Previous))
+                                return false;
+                        if (tag == ScreenTag::DefaultWatchFace)
+                        {
+                                bool changed = false;
+                                for (size_t i = 0; i < W; i++)
+                                        changed = reach(reached, watchFaces[i], watchFaces) || changed;
+                                return changed;
+                        }
+                        if (reached[static_cast<uint8_t>(tag)])
+                                return false;
+                        reached[static_cast<uint8_t>(tag)] = true;
+                        return true;
+                }
+        };
+
+        static constexpr Transition buttonTransition(ScreenTag fromScreen, ScreenTag toScreen, TransitionEffect effect = TransitionEffect::None)
+        {
+                return buttonTransition(fromScreen, toScreen, 1, effect);
+        }
+
+        static constexpr Transition buttonTransition(ScreenTag fromScreen, ScreenTag toScreen, uint8_t toPageNumber, TransitionEffect effect = TransitionEffect::None)
+        {
+                return {TransitionTrigger::Button, Screen::SwipeDirection::None, fromScreen, toScreen, toPageNumber, effect};
+        }
+
+        static constexpr Transition swipeTransition(ScreenTag fromScreen, ScreenTag toScreen, Screen::SwipeDirection direction)
+        {
+                return swipeTransition(fromScreen, toScreen, 1, direction);
+        }
+
+        // the content moves in the direction of the swipe
+        static constexpr Transition swipeTransition(ScreenTag fromScreen, ScreenTag toScreen, uint8_t toPageNumber, Screen::SwipeDirection direction)
+        {
+                return {TransitionTrigger::Swipe,
+                        direction,
+                        fromScreen,
+                        toScreen,
+                        toPageNumber,
+                        (direction == Screen::SwipeDirection::Left)    ? TransitionEffect::MoveLeft
+                        : (direction == Screen::SwipeDirection::Right) ? TransitionEffect::MoveRight
+                        : (direction == Screen::SwipeDirection::Up)    ? TransitionEffect::MoveTop
+                        : (direction == Screen::SwipeDirection::Down)  ? TransitionEffect::MoveBottom
+                                                                       : TransitionEffect::None};
+        }
+
+        static constexpr Transition inactivityTransition(ScreenTag fromScreen, ScreenTag toScreen, TransitionEffect effect = TransitionEffect::None)
+        {
+                return inactivityTransition(fromScreen, toScreen, 1, effect);
+        }
+
+        static constexpr Transition inactivityTransition(ScreenTag fromScreen, ScreenTag toScreen, uint8_t toPageNumber, TransitionEffect effect = TransitionEffect::None)
+        {
+                return {TransitionTrigger::Inactivity, Screen::SwipeDirection::None, fromScreen, toScreen, toPageNumber, effect};
+        }
+
         Screen *currentScreen() const { return _currentScreen; }
 
-        ScreenGraph(FullRefreshProvider *refreshProvider, ComponentContainer *components);
+        ScreenGraph(FullRefreshProvider *refreshProvider, ComponentContainer *components, const TransitionTable &transitions);
         virtual ~ScreenGraph();
 
-        void addButtonTransition(ScreenTag fromScreen, ScreenTag toScreen, TransitionEffect effect = TransitionEffect::None);
-        void addButtonTransition(ScreenTag fromScreen, ScreenTag toScreen, uint8_t toPageNumber, TransitionEffect effect = TransitionEffect::None);
-        void addSwipeTransition(ScreenTag fromScreen, ScreenTag toScreen, Screen::SwipeDirection direction);
-        void addSwipeTransition(ScreenTag fromScreen, ScreenTag toScreen, uint8_t toPageNumber, Screen::SwipeDirection direction);
-        void addInactivityTransition(ScreenTag fromScreen, ScreenTag toScreen, TransitionEffect effect = TransitionEffect::None);
-        void addInactivityTransition(ScreenTag fromScreen, ScreenTag toScreen, uint8_t toPageNumber, TransitionEffect effect = TransitionEffect::None);
-
         void activateScreen(ScreenTag tag, TransitionEffect effect = TransitionEffect::None);
         void activateScreen(ScreenTag tag, uint8_t pageNumber, TransitionEffect effect = TransitionEffect::None);
 
         void setDefaultWatchFace(ScreenTag tag);
 
+        // keep up to maxScreens (at most maxCachedScreens) cacheable screens hidden instead of deleting them when
+        // switching to another screen, as long as the free heap stays above minFreeHeap bytes (the least recently used
+        // ones are deleted first)
+        void setScreenCache(uint8_t maxScreens, size_t minFreeHeap);
+
+        // the next redraw of the display is a full refresh, presented with the given effect
+        void startTransition(TransitionEffect effect);
+
         virtual void handleRefresh();
         virtual bool handleButtonPress();
         virtual bool handleTap();
@@ -79,22 +269,21 @@ public:
 
 protected:
 
-        struct Transition
+        static constexpr uint8_t maxPreviousScreens = 4;
+        static constexpr uint8_t maxCachedScreens = 4;
+
+        struct ScreenInfo
         {
         public:
-                TransitionTrigger trigger;
-                Screen::SwipeDirection swipeDirection;
-                ScreenTag fromScreen;
-                ScreenTag toScreen;
-                uint8_t toPageNumber;
-                TransitionEffect effect;
+                ScreenTag tag;
+                uint8_t pageNumber;
         };
 
-        struct ScreenInfo
+        struct CachedScreen
         {
         public:
                 ScreenTag tag;
-                uint8_t pageNumber;
+                Screen *screen;
         };
 
         FullRefreshProvider *_refreshProvider;
@@ -104,14 +293,24 @@ protected:
         uint8_t _nextPageNumber;
         TransitionEffect _nextEffect;
         Screen *_currentScreen;
-        std::vector<Transition> _transitions;
+        const TransitionTable *_transitions;
         uint32_t _lastButtonPressTicks;
-        std::vector<ScreenInfo> _previousScreens;
+        ScreenInfo _previousScreens[maxPreviousScreens];
+        uint8_t _previousScreenCount;
+        CachedScreen _cachedScreens[maxCachedScreens];   // least recently used first
+        uint8_t _cachedScreenCount;
+        uint8_t _maxCachedScreens;
+        size_t _minFreeHeapForCache;
 
         virtual ScreenTag watchFaceScreenTagByIndex(uint8_t watchFaceIndex) = 0;
 
+        bool handleTransition(TransitionTrigger trigger, Screen::SwipeDirection direction = Screen::SwipeDirection::None);
         void switchScreen(ScreenTag tag, uint8_t pageNumber, TransitionEffect effect);
         Screen *createScreen(ScreenTag tag);
+        void releaseScreen(ScreenTag tag, Screen *screen);
+        Screen *takeCachedScreen(ScreenTag tag);
+        void deleteCachedScreen(uint8_t index);
+        void trimScreenCache();
 };
 
 #endif // SCREENGRAPH_H
@@ -18,6 +18,7 @@ public:
 
         lv_color_t foregroundColor() const override;
 
+        bool isCacheable() const override { return true; }
         bool isMultiPageScreen() const override { return true; }
         uint8_t pageCount() const override { return _pages; }
 
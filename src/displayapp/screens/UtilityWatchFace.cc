@@ -1,6 +1,5 @@
 #include "UtilityWatchFace.h"
 
-#include <cmath>
 #include <lvgl/lvgl.h>
 
 #include "displayapp/fonts/font_symbols_32.h"
@@ -16,10 +15,6 @@
 using namespace Pinetime::Controllers;
 
 
-#ifndef PI
-#define PI   3.14159265358979323846
-#endif
-
 char const* WeekDays[] = {"--", "MO", "TU", "WE", "TH", "FR", "SA", "SU"};
 
 
@@ -72,30 +67,36 @@ UtilityWatchFace::UtilityWatchFace(ScreenGraph *screenGraph, ComponentContainer
 
         // add the hour hand
         _hourHandInner = lv_line_create(lv_scr_act(), nullptr);
+        _handsPlanner.addLine(_hourHandInner);
         lv_obj_set_style_local_line_width(_hourHandInner, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, 5);
         lv_obj_set_style_local_line_color(_hourHandInner, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, lv_color_hex(0xffffff));
         lv_obj_set_style_local_line_rounded(_hourHandInner, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, false);
         _hourHandOuter = lv_line_create(lv_scr_act(), nullptr);
+        _handsPlanner.addLine(_hourHandOuter);
         lv_obj_set_style_local_line_width(_hourHandOuter, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, 11);
         lv_obj_set_style_local_line_color(_hourHandOuter, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, lv_color_hex(0xffffff));
         lv_obj_set_style_local_line_rounded(_hourHandOuter, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, true);
 
         // add the minute hand
         _minuteHandInner = lv_line_create(lv_scr_act(), nullptr);
+        _handsPlanner.addLine(_minuteHandInner);
         lv_obj_set_style_local_line_width(_minuteHandInner, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, 5);
         lv_obj_set_style_local_line_color(_minuteHandInner, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, lv_color_hex(0xffffff));
         lv_obj_set_style_local_line_rounded(_minuteHandInner, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, false);
         _minuteHandOuter = lv_line_create(lv_scr_act(), nullptr);
+        _handsPlanner.addLine(_minuteHandOuter);
         lv_obj_set_style_local_line_width(_minuteHandOuter, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, 11);
         lv_obj_set_style_local_line_color(_minuteHandOuter, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, lv_color_hex(0xffffff));
         lv_obj_set_style_local_line_rounded(_minuteHandOuter, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, true);
 
         // add the second hand
         _secondHand = lv_line_create(lv_scr_act(), nullptr);
+        _handsPlanner.addLine(_secondHand);
         lv_obj_set_style_local_line_width(_secondHand, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, 3);
         lv_obj_set_style_local_line_color(_secondHand, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, lv_color_hex(0xfe3b30));
         lv_obj_set_style_local_line_rounded(_secondHand, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, true);
         _secondTail = lv_line_create(lv_scr_act(), nullptr);
+        _handsPlanner.addLine(_secondTail);
         lv_obj_set_style_local_line_width(_secondTail, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, 3);
         lv_obj_set_style_local_line_color(_secondTail, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, lv_color_hex(0xfe3b30));
         lv_obj_set_style_local_line_rounded(_secondTail, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, true);
@@ -156,62 +157,29 @@ void UtilityWatchFace::batteryPercentChanged()
 
 void UtilityWatchFace::updateHands(bool hourChanged, bool minuteChanged)
 {
-        int16_t cx = LV_HOR_RES / 2;
-        int16_t cy = LV_VER_RES / 2;
-
         // update the hour hand
         if (hourChanged || minuteChanged)
         {
-                double radians = ((static_cast<double>(hour() % 12) * 60.0) + static_cast<double>(minute())) / (12.0 * 60.0) * 2.0 * PI;
-                double sine = sin(radians);
-                double cosine = cos(radians);
-
-                _hourHandInnerPoints[0].x = cx + roundedCoord(5.0 * sine);
-                _hourHandInnerPoints[0].y = cy - roundedCoord(5.0 * cosine);
-                _hourHandInnerPoints[1].x = cx + roundedCoord(20.0 * sine);
-                _hourHandInnerPoints[1].y = cy - roundedCoord(20.0 * cosine);
-                lv_line_set_points(_hourHandInner, _hourHandInnerPoints, 2);
-
-                _hourHandOuterPoints[0].x = cx + roundedCoord(20.0 * sine);
-                _hourHandOuterPoints[0].y = cy - roundedCoord(20.0 * cosine);
-                _hourHandOuterPoints[1].x = cx + roundedCoord(60.0 * sine);
-                _hourHandOuterPoints[1].y = cy - roundedCoord(60.0 * cosine);
-                lv_line_set_points(_hourHandOuter, _hourHandOuterPoints, 2);
+                uint16_t position = HandGeometry::hourPosition(hour(), minute());
+
+                _handsPlanner.moveLine(_hourHandInner, _hourHandInnerPoints, HandGeometry::point(position, 5), HandGeometry::point(position, 20));
+                _handsPlanner.moveLine(_hourHandOuter, _hourHandOuterPoints, HandGeometry::point(position, 20), HandGeometry::point(position, 60));
         }
 
         // update the minute hand
-        double radians = ((static_cast<double>(minute()) * 60.0) + static_cast<double>(second())) / (60.0 * 60.0) * 2.0 * PI;
-        double sine = sin(radians);
-        double cosine = cos(radians);
-
-        _minuteHandInnerPoints[0].x = cx + roundedCoord(5.0 * sine);
-        _minuteHandInnerPoints[0].y = cy - roundedCoord(5.0 * cosine);
-        _minuteHandInnerPoints[1].x = cx + roundedCoord(20.0 * sine);
-        _minuteHandInnerPoints[1].y = cy - roundedCoord(20.0 * cosine);
-        lv_line_set_points(_minuteHandInner, _minuteHandInnerPoints, 2);
-
-        _minuteHandOuterPoints[0].x = cx + roundedCoord(20.0 * sine);
-        _minuteHandOuterPoints[0].y = cy - roundedCoord(20.0 * cosine);
-        _minuteHandOuterPoints[1].x = cx + roundedCoord(100.0 * sine);
-        _minuteHandOuterPoints[1].y = cy - roundedCoord(100.0 * cosine);
-        lv_line_set_points(_minuteHandOuter, _minuteHandOuterPoints, 2);
+        uint16_t position = HandGeometry::minutePosition(minute(), second());
+
+        _handsPlanner.moveLine(_minuteHandInner, _minuteHandInnerPoints, HandGeometry::point(position, 5), HandGeometry::point(position, 20));
+        _handsPlanner.moveLine(_minuteHandOuter, _minuteHandOuterPoints, HandGeometry::point(position, 20), HandGeometry::point(position, 100));
 
         // update the second hand
-        radians = static_cast<double>(second()) / 60.0 * 2.0 * PI;
-        sine = sin(radians);
-        cosine = cos(radians);
-
-        _secondHandPoints[0].x = cx + roundedCoord(4.0 * sine);
-        _secondHandPoints[0].y = cy - roundedCoord(4.0 * cosine);
-        _secondHandPoints[1].x = cx + roundedCoord(114.0 * sine);
-        _secondHandPoints[1].y = cy - roundedCoord(114.0 * cosine);
-        lv_line_set_points(_secondHand, _secondHandPoints, 2);
-
-        _secondTailPoints[0].x = cx - roundedCoord(4.0 * sine);
-        _secondTailPoints[0].y = cy + roundedCoord(4.0 * cosine);
-        _secondTailPoints[1].x = cx - roundedCoord(20.0 * sine);
-        _secondTailPoints[1].y = cy + roundedCoord(20.0 * cosine);
-        lv_line_set_points(_secondTail, _secondTailPoints, 2);
+        position = HandGeometry::secondPosition(second());
+
+        _handsPlanner.moveLine(_secondHand, _secondHandPoints, HandGeometry::point(position, 4), HandGeometry::point(position, 114));
+        _handsPlanner.moveLine(_secondTail, _secondTailPoints, HandGeometry::point(position, -4), HandGeometry::point(position, -20));
+
+        // redraw the areas of the hands that moved
+        _handsPlanner.commit();
 }
 
 
@@ -227,14 +195,6 @@ void UtilityWatchFace::updatePowerAndBleSymbols()
 }
 
 
-int16_t UtilityWatchFace::roundedCoord(double value)
-{
-        if (value < 0.0)
-                return static_cast<int16_t>(value - 0.5);
-        else
-                return static_cast<int16_t>(value + 0.5);
-}
-
 
 const char *UtilityWatchFace::dayOfWeekText()
 {
@@ -3,6 +3,8 @@
 
 
 #include "WatchFace.h"
+#include "RedrawPlanner.h"
+#include "HandGeometry.h"
 
 
 
@@ -48,10 +50,11 @@ private:
 
         lv_style_t _basicArcStyle;
 
+        RedrawPlanner _handsPlanner;
+
         void updateHands(bool hourChanged, bool minuteChanged);
         void updatePowerAndBleSymbols();
 
-        int16_t roundedCoord(double value);
 
         const char *dayOfWeekText();
 };
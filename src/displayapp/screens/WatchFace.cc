@@ -19,6 +19,7 @@ WatchFace::WatchFace(ScreenGraph *screenGraph, ComponentContainer *components)
         _hour = dateTime->Hours();
         _minute = dateTime->Minutes();
         _second = dateTime->Seconds();
+        dateTime->CheckChanges(_timeSubscription);
 
         _locked = false;
         _batteryPercent = this->components()->battery()->PercentRemaining();
@@ -38,15 +39,29 @@ void WatchFace::refresh()
                 _firstRefresh = false;
         }
 
-        // get current date and time
+        // get current date and time, if they've changed since the last call
+        uint16_t year = _year;
+        DateTime::Months month = _month;
+        DateTime::Days dayOfWeek = _dayOfWeek;
+        uint8_t dayOfMonth = _dayOfMonth;
+        uint8_t hour = _hour;
+        uint8_t minute = _minute;
+        uint8_t second = _second;
         DateTime *dateTime = this->components()->dateTime();
-        uint16_t year = dateTime->Year();
-        DateTime::Months month = dateTime->Month();
-        DateTime::Days dayOfWeek = dateTime->DayOfWeek();
-        uint8_t dayOfMonth = dateTime->Day();
-        uint8_t hour = dateTime->Hours();
-        uint8_t minute = dateTime->Minutes();
-        uint8_t second = dateTime->Seconds();
+        uint8_t dateTimeChanges = dateTime->CheckChanges(_timeSubscription);
+        if (dateTimeChanges & BrokenDownTime::Day)
+        {
+                year = dateTime->Year();
+                month = dateTime->Month();
+                dayOfWeek = dateTime->DayOfWeek();
+                dayOfMonth = dateTime->Day();
+        }
+        if (dateTimeChanges != BrokenDownTime::None)
+        {
+                hour = dateTime->Hours();
+                minute = dateTime->Minutes();
+                second = dateTime->Seconds();
+        }
 
         // get current power / connection status
         uint8_t batteryPercent = this->components()->battery()->PercentRemaining();
@@ -18,6 +18,8 @@ public:
 
         void refresh() override;
 
+        bool isCacheable() const override { return true; }
+
         uint16_t year() const { return _year; }
         DateTime::Months month() const { return _month; }
         DateTime::Days dayOfWeek() const { return _dayOfWeek; }
@@ -59,6 +61,7 @@ private:
         uint8_t _hour;
         uint8_t _minute;
         uint8_t _second;
+        DateTime::Subscription _timeSubscription;
 
         bool _locked;
         uint8_t _batteryPercent;
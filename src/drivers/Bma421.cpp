@@ -22,6 +22,10 @@ namespace {
   void user_delay(uint32_t period_us, void* /*intf_ptr*/) {
     nrf_delay_us(period_us);
   }
+
+  // 100Hz / 2^3 = 12.5Hz
+  constexpr uint8_t fifoDownSampling = 3;
+  constexpr uint8_t fifoFlushCommand = 0xb0;
 }
 
 Bma421::Bma421(TwiMaster& twiMaster, uint8_t twiAddress) : twiMaster {twiMaster}, deviceAddress {twiAddress} {
@@ -83,6 +87,25 @@ void Bma421::Init() {
   if (ret != BMA4_OK)
     return;
 
+  // Headerless FIFO containing only the accelerometer frames (6 bytes each)
+  ret = bma4_set_fifo_config(BMA4_FIFO_HEADER, BMA4_DISABLE, &bma);
+  if (ret != BMA4_OK)
+    return;
+
+  ret = bma4_set_fifo_config(BMA4_FIFO_ACCEL, BMA4_ENABLE, &bma);
+  if (ret != BMA4_OK)
+    return;
+
+  ret = bma4_set_accel_fifo_filter_data(BMA4_ENABLE, &bma);
+  if (ret != BMA4_OK)
+    return;
+
+  ret = bma4_set_fifo_down_accel(fifoDownSampling, &bma);
+  if (ret != BMA4_OK)
+    return;
+
+  FlushFifo();
+
   isOk = true;
 }
 
@@ -119,6 +142,58 @@ Bma421::Values Bma421::Process() {
   return {steps, data.y, data.x, data.z};
 }
 
+bool Bma421::ProcessFifo(FifoValues& values) {
+  values.steps = 0;
+  values.nbSamples = 0;
+  if (not isOk)
+    return false;
+
+  // The step counter and the FIFO length are read in a single batch, as bma423_step_counter_output() and
+  // bma4_get_fifo_length() would
+  uint8_t stepCounter[4];
+  uint8_t fifoLength[2];
+  const TwiMaster::ReadRequest reads[] = {
+    {deviceAddress, BMA4_STEP_CNT_OUT_0_ADDR, stepCounter, sizeof(stepCounter)},
+    {deviceAddress, BMA4_FIFO_LENGTH_0_ADDR, fifoLength, sizeof(fifoLength)},
+  };
+  if (twiMaster.Read(reads, sizeof(reads) / sizeof(reads[0])) != TwiMaster::ErrorCodes::NoError)
+    return false;
+
+  values.steps = stepCounter[0] | (stepCounter[1] << 8) | (stepCounter[2] << 16) | (static_cast<uint32_t>(stepCounter[3]) << 24);
+  uint16_t length = ((fifoLength[1] & BMA4_FIFO_BYTE_COUNTER_MSB_MSK) << 8) | fifoLength[0];
+
+  if (length > sizeof(fifoBuffer)) {
+    // Stale samples, only keep the current acceleration
+    FlushFifo();
+    struct bma4_accel data;
+    if (bma4_read_accel_xyz(&data, &bma) == BMA4_OK) {
+      values.samples[0] = {data.y, data.x, data.z};
+      values.nbSamples = 1;
+    }
+    return true;
+  }
+
+  struct bma4_fifo_frame fifo {};
+  fifo.data = fifoBuffer;
+  fifo.length = length - (length % BMA4_FIFO_A_LENGTH);
+  if (fifo.length == 0 || bma4_read_fifo_data(&fifo, &bma) != BMA4_OK)
+    return true;
+
+  uint16_t nbSamples = maxFifoSamples;
+  bma4_extract_accel(fifoSamples, &nbSamples, &fifo, &bma);
+
+  for (uint16_t i = 0; i < nbSamples; i++) {
+    // X and Y axis are swapped because of the way the sensor is mounted in the PineTime
+    values.samples[i] = {fifoSamples[i].y, fifoSamples[i].x, fifoSamples[i].z};
+  }
+  values.nbSamples = nbSamples;
+  return true;
+}
+
+void Bma421::FlushFifo() {
+  bma4_set_command_register(fifoFlushCommand, &bma);
+}
+
 bool Bma421::IsOk() const {
   return isOk;
 }
@@ -1,4 +1,5 @@
 #pragma once
+#include <array>
 #include <drivers/Bma421_C/bma4_defs.h>
 
 namespace Pinetime {
@@ -16,6 +17,22 @@ namespace Pinetime {
         int16_t z;
       };
 
+      struct Sample {
+        int16_t x;
+        int16_t y;
+        int16_t z;
+      };
+
+      /// The FIFO is filled with the filtered data down-sampled from the 100Hz ODR to 12.5Hz
+      static constexpr uint32_t fifoSamplePeriodMs = 80;
+      static constexpr size_t maxFifoSamples = 20;
+
+      struct FifoValues {
+        uint32_t steps;
+        size_t nbSamples;
+        std::array<Sample, maxFifoSamples> samples; // Oldest first
+      };
+
       Bma421(TwiMaster& twiMaster, uint8_t twiAddress);
       Bma421(const Bma421&) = delete;
       Bma421& operator=(const Bma421&) = delete;
@@ -27,6 +44,10 @@ namespace Pinetime {
       void SoftReset();
       void Init();
       Values Process();
+      /// Drains the samples buffered in the FIFO with a single burst read. If the FIFO holds more than maxFifoSamples
+      /// samples (it was not read for a long time), they are dropped and only the current acceleration is returned.
+      /// Returns false, with no steps and no samples, if the step counter and the FIFO length could not be read.
+      bool ProcessFifo(FifoValues& values);
       void ResetStepCounter();
 
       void Read(uint8_t registerAddress, uint8_t* buffer, size_t size);
@@ -37,6 +58,7 @@ namespace Pinetime {
 
     private:
       void Reset();
+      void FlushFifo();
 
       TwiMaster& twiMaster;
       uint8_t deviceAddress = 0x18;
@@ -44,6 +66,8 @@ namespace Pinetime {
       bool isOk = false;
       bool isResetOk = false;
       DeviceTypes deviceType = DeviceTypes::Unknown;
+      uint8_t fifoBuffer[maxFifoSamples * BMA4_FIFO_A_LENGTH];
+      struct bma4_accel fifoSamples[maxFifoSamples];
     };
   }
 }
\ No newline at end of file
@@ -67,18 +67,25 @@ void Hrs3300::Disable() {
   WriteRegister(static_cast<uint8_t>(Registers::PDriver), 0);
 }
 
-uint32_t Hrs3300::ReadHrs() {
-  auto m = ReadRegister(static_cast<uint8_t>(Registers::C0DataM));
-  auto h = ReadRegister(static_cast<uint8_t>(Registers::C0DataH));
-  auto l = ReadRegister(static_cast<uint8_t>(Registers::C0dataL));
-  return ((l & 0x30) << 12) | (m << 8) | ((h & 0x0f) << 4) | (l & 0x0f);
-}
+// The data registers span C1dataM to C0dataL and are read in a single burst, the device incrementing the register
+// address after each byte: the task waits for the bus once per sample, and the bus is started and stopped once
+bool Hrs3300::ReadSample(Sample& sample) {
+  constexpr uint8_t firstRegister = static_cast<uint8_t>(Registers::C1dataM);
+  constexpr uint8_t lastRegister = static_cast<uint8_t>(Registers::C0dataL);
+  uint8_t data[lastRegister - firstRegister + 1] = {0};
+  if (twiMaster.Read(twiAddress, firstRegister, data, sizeof(data)) != TwiMaster::ErrorCodes::NoError) {
+    NRF_LOG_INFO("READ ERROR");
+    sample = {0, 0};
+    return false;
+  }
 
-uint32_t Hrs3300::ReadAls() {
-  auto m = ReadRegister(static_cast<uint8_t>(Registers::C1dataM));
-  auto h = ReadRegister(static_cast<uint8_t>(Registers::C1dataH));
-  auto l = ReadRegister(static_cast<uint8_t>(Registers::C1dataL));
-  return ((h & 0x3f) << 11) | (m << 3) | (l & 0x07);
+  auto value = [&data](Registers reg) {
+    return static_cast<uint32_t>(data[static_cast<uint8_t>(reg) - firstRegister]);
+  };
+  sample.hrs = ((value(Registers::C0dataL) & 0x30) << 12) | (value(Registers::C0DataM) << 8) |
+               ((value(Registers::C0DataH) & 0x0f) << 4) | (value(Registers::C0dataL) & 0x0f);
+  sample.als = ((value(Registers::C1dataH) & 0x3f) << 11) | (value(Registers::C1dataM) << 3) | (value(Registers::C1dataL) & 0x07);
+  return true;
 }
 
 void Hrs3300::SetGain(uint8_t gain) {
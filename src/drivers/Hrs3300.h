@@ -21,6 +21,11 @@ namespace Pinetime {
         Hgain = 0x17
       };
 
+      struct Sample {
+        uint32_t hrs;
+        uint32_t als;
+      };
+
       Hrs3300(TwiMaster& twiMaster, uint8_t twiAddress);
       Hrs3300(const Hrs3300&) = delete;
       Hrs3300& operator=(const Hrs3300&) = delete;
@@ -30,8 +35,8 @@ namespace Pinetime {
       void Init();
       void Enable();
       void Disable();
-      uint32_t ReadHrs();
-      uint32_t ReadAls();
+      // Returns false, with a zero sample, if the registers could not be read
+      bool ReadSample(Sample& sample);
       void SetGain(uint8_t gain);
       void SetDrive(uint8_t drive);
 
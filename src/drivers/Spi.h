@@ -7,7 +7,7 @@ namespace Pinetime {
   namespace Drivers {
     class Spi {
     public:
-      Spi(SpiMaster& spiMaster, uint8_t pinCsn);
+      Spi(SpiMaster& spiMaster, uint8_t pinCsn, SpiMaster::Clients client);
       Spi(const Spi&) = delete;
       Spi& operator=(const Spi&) = delete;
       Spi(Spi&&) = delete;
@@ -17,12 +17,16 @@ namespace Pinetime {
       bool Write(const uint8_t* data, size_t size);
       bool Read(uint8_t* cmd, size_t cmdSize, uint8_t* data, size_t dataSize);
       bool WriteCmdAndBuffer(const uint8_t* cmd, size_t cmdSize, const uint8_t* data, size_t dataSize);
+      // Same transfers, on behalf of another client than the one of the device (flash programs)
+      bool Read(uint8_t* cmd, size_t cmdSize, uint8_t* data, size_t dataSize, SpiMaster::Clients client);
+      bool WriteCmdAndBuffer(const uint8_t* cmd, size_t cmdSize, const uint8_t* data, size_t dataSize, SpiMaster::Clients client);
       void Sleep();
       void Wakeup();
 
     private:
       SpiMaster& spiMaster;
       uint8_t pinCsn;
+      SpiMaster::Clients client;
     };
   }
 }
@@ -1,20 +1,23 @@
 #include "drivers/SpiMaster.h"
 #include <hal/nrf_gpio.h>
+#include <hal/nrf_rtc.h>
 #include <hal/nrf_spim.h>
 #include <nrfx_log.h>
 #include <algorithm>
 
 using namespace Pinetime::Drivers;
 
+namespace {
+  // DWT->CYCCNT counts at the CPU clock (64MHz), but stops while the CPU sleeps
+  constexpr uint32_t cyclesPerUs = 64;
+  // RTC1 (the FreeRTOS tick) is a 24 bits counter at 1024Hz, which keeps running in sleep
+  constexpr uint32_t rtcMask = 0x00ffffff;
+}
+
 SpiMaster::SpiMaster(const SpiMaster::SpiModule spi, const SpiMaster::Parameters& params) : spi {spi}, params {params} {
 }
 
 bool SpiMaster::Init() {
-  if (mutex == nullptr) {
-    mutex = xSemaphoreCreateBinary();
-    ASSERT(mutex != nullptr);
-  }
-
   /* Configure GPIO pins used for pselsck, pselmosi, pselmiso and pselss for SPI0 */
   nrf_gpio_pin_set(params.pinSCK);
   nrf_gpio_cfg_output(params.pinSCK);
@@ -90,7 +93,18 @@ bool SpiMaster::Init() {
   NRFX_IRQ_PRIORITY_SET(SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn, 2);
   NRFX_IRQ_ENABLE(SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn);
 
-  xSemaphoreGive(mutex);
+  // TIMER3 counts the END events of the chained segments and raises the interrupt at the end of the chain
+  NRF_TIMER3->TASKS_STOP = 1;
+  NRF_TIMER3->MODE = TIMER_MODE_MODE_LowPowerCounter << TIMER_MODE_MODE_Pos;
+  NRF_TIMER3->BITMODE = TIMER_BITMODE_BITMODE_16Bit << TIMER_BITMODE_BITMODE_Pos;
+  NRF_TIMER3->INTENSET = TIMER_INTENSET_COMPARE1_Msk;
+  NRFX_IRQ_PRIORITY_SET(TIMER3_IRQn, 2);
+  NRFX_IRQ_ENABLE(TIMER3_IRQn);
+
+  // The cycle counter measures the short waits for the bus
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
   return true;
 }
 
@@ -127,10 +141,22 @@ void SpiMaster::OnEndEvent() {
     return;
   }
 
+  if (currentBufferSize == 0 && dataPhaseSize > 0) {
+    // The command of a read or of a command + buffer write has been sent: continue with the data
+    currentBufferAddr = dataPhaseAddr;
+    currentBufferSize = dataPhaseSize;
+    receiving = dataPhaseReceive;
+    dataPhaseSize = 0;
+  }
+
   auto s = currentBufferSize;
   if (s > 0) {
     auto currentSize = std::min((size_t) 255, s);
-    PrepareTx(currentBufferAddr, currentSize);
+    if (receiving) {
+      PrepareRx(currentBufferAddr, currentSize);
+    } else {
+      PrepareTx(currentBufferAddr, currentSize);
+    }
     currentBufferAddr += currentSize;
     currentBufferSize -= currentSize;
 
@@ -139,20 +165,82 @@ void SpiMaster::OnEndEvent() {
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     if (taskToNotify != nullptr) {
       vTaskNotifyGiveFromISR(taskToNotify, &xHigherPriorityTaskWoken);
-      portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+    Transfer* transfer = currentTransfer;
+    if (transfer != nullptr) {
+      currentTransfer = nullptr;
+      transfer->completed = true;
+      vTaskNotifyGiveFromISR(transfer->task, &xHigherPriorityTaskWoken);
     }
 
     nrf_gpio_pin_set(this->pinCsn);
     currentBufferAddr = 0;
-    BaseType_t xHigherPriorityTaskWoken2 = pdFALSE;
-    xSemaphoreGiveFromISR(mutex, &xHigherPriorityTaskWoken2);
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken | xHigherPriorityTaskWoken2);
+
+    UBaseType_t interruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    Transfer* next = Next();
+    taskEXIT_CRITICAL_FROM_ISR(interruptStatus);
+    Dispatch(next, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
   }
 }
 
 void SpiMaster::OnStartedEvent() {
 }
 
+// All the chained segments have been sent: send the remainder, if any, or end the transfer
+void SpiMaster::OnChainEndEvent() {
+  StopChain();
+  OnEndEvent();
+}
+
+void SpiMaster::StartChain(const SpimSegments& segments) {
+  // Only the TIMER interrupt is raised during the chain
+  spiBaseAddress->INTENCLR = (1 << 6);
+  spiBaseAddress->INTENCLR = (1 << 19);
+
+  NRF_TIMER3->TASKS_STOP = 1;
+  NRF_TIMER3->TASKS_CLEAR = 1;
+  NRF_TIMER3->CC[0] = segments.UnchainCompare();
+  NRF_TIMER3->CC[1] = segments.EndCompare();
+  NRF_TIMER3->EVENTS_COMPARE[0] = 0;
+  NRF_TIMER3->EVENTS_COMPARE[1] = 0;
+
+  // END -> START, in a group so that it can be disabled by the TIMER
+  NRF_PPI->CH[ppiChannelChain].EEP = (uint32_t) &spiBaseAddress->EVENTS_END;
+  NRF_PPI->CH[ppiChannelChain].TEP = (uint32_t) &spiBaseAddress->TASKS_START;
+  NRF_PPI->CHG[ppiGroupChain] = 1U << ppiChannelChain;
+  // END -> COUNT
+  NRF_PPI->CH[ppiChannelCount].EEP = (uint32_t) &spiBaseAddress->EVENTS_END;
+  NRF_PPI->CH[ppiChannelCount].TEP = (uint32_t) &NRF_TIMER3->TASKS_COUNT;
+  // COMPARE[0] (the last segment is being sent) -> stop chaining
+  NRF_PPI->CH[ppiChannelUnchain].EEP = (uint32_t) &NRF_TIMER3->EVENTS_COMPARE[0];
+  NRF_PPI->CH[ppiChannelUnchain].TEP = (uint32_t) &NRF_PPI->TASKS_CHG[ppiGroupChain].DIS;
+  NRF_PPI->CHENSET = (1U << ppiChannelChain) | (1U << ppiChannelCount) | (1U << ppiChannelUnchain);
+  NRF_TIMER3->TASKS_START = 1;
+
+  spiBaseAddress->TXD.PTR = currentBufferAddr;
+  spiBaseAddress->TXD.MAXCNT = segments.segmentSize;
+  spiBaseAddress->TXD.LIST = SPIM_TXD_LIST_LIST_ArrayList << SPIM_TXD_LIST_LIST_Pos;
+  spiBaseAddress->RXD.PTR = 0;
+  spiBaseAddress->RXD.MAXCNT = 0;
+  spiBaseAddress->RXD.LIST = 0;
+  spiBaseAddress->EVENTS_END = 0;
+
+  currentBufferAddr += segments.segmentSize * segments.chainedSegments;
+  currentBufferSize = segments.remainderSize;
+  spiBaseAddress->TASKS_START = 1;
+}
+
+void SpiMaster::StopChain() {
+  NRF_PPI->CHENCLR = (1U << ppiChannelChain) | (1U << ppiChannelCount) | (1U << ppiChannelUnchain);
+  NRF_TIMER3->TASKS_STOP = 1;
+  // The events of the chained segments must not raise an interrupt when the interrupts are enabled again
+  spiBaseAddress->EVENTS_END = 0;
+  spiBaseAddress->EVENTS_STARTED = 0;
+  spiBaseAddress->INTENSET = (1 << 6);
+  spiBaseAddress->INTENSET = (1 << 19);
+}
+
 void SpiMaster::PrepareTx(const volatile uint32_t bufferAddress, const volatile size_t size) {
   spiBaseAddress->TXD.PTR = bufferAddress;
   spiBaseAddress->TXD.MAXCNT = size;
@@ -173,12 +261,19 @@ void SpiMaster::PrepareRx(const volatile uint32_t bufferAddress, const volatile
   spiBaseAddress->EVENTS_END = 0;
 }
 
-bool SpiMaster::Write(uint8_t pinCsn, const uint8_t* data, size_t size) {
+bool SpiMaster::Write(uint8_t pinCsn, const uint8_t* data, size_t size, Clients client) {
   if (data == nullptr)
     return false;
-  auto ok = xSemaphoreTake(mutex, portMAX_DELAY);
-  ASSERT(ok == true);
+  Transfer transfer {};
+  transfer.client = client;
+  transfer.ownerOnly = true;
+  if (!Acquire(transfer)) {
+    WaitCompleted(transfer);
+  }
   taskToNotify = xTaskGetCurrentTaskHandle();
+  currentTransfer = nullptr;
+  receiving = false;
+  dataPhaseSize = 0;
 
   this->pinCsn = pinCsn;
 
@@ -193,6 +288,12 @@ bool SpiMaster::Write(uint8_t pinCsn, const uint8_t* data, size_t size) {
   currentBufferAddr = (uint32_t) data;
   currentBufferSize = size;
 
+  const auto segments = SpimSegments::Plan(size);
+  if (segments.IsChained()) {
+    StartChain(segments);
+    return true;
+  }
+
   auto currentSize = std::min((size_t) 255, (size_t) currentBufferSize);
   PrepareTx(currentBufferAddr, currentSize);
   currentBufferSize -= currentSize;
@@ -207,43 +308,18 @@ bool SpiMaster::Write(uint8_t pinCsn, const uint8_t* data, size_t size) {
 
     DisableWorkaroundForFtpan58(spiBaseAddress, 0, 0);
 
-    xSemaphoreGive(mutex);
+    Release();
   }
 
   return true;
 }
 
-bool SpiMaster::Read(uint8_t pinCsn, uint8_t* cmd, size_t cmdSize, uint8_t* data, size_t dataSize) {
-  xSemaphoreTake(mutex, portMAX_DELAY);
-
-  taskToNotify = nullptr;
-
-  this->pinCsn = pinCsn;
-  DisableWorkaroundForFtpan58(spiBaseAddress, 0, 0);
-  spiBaseAddress->INTENCLR = (1 << 6);
-  spiBaseAddress->INTENCLR = (1 << 1);
-  spiBaseAddress->INTENCLR = (1 << 19);
-
-  nrf_gpio_pin_clear(this->pinCsn);
-
-  currentBufferAddr = 0;
-  currentBufferSize = 0;
-
-  PrepareTx((uint32_t) cmd, cmdSize);
-  spiBaseAddress->TASKS_START = 1;
-  while (spiBaseAddress->EVENTS_END == 0)
-    ;
-
-  PrepareRx((uint32_t) data, dataSize);
-  spiBaseAddress->TASKS_START = 1;
-
-  while (spiBaseAddress->EVENTS_END == 0)
-    ;
-  nrf_gpio_pin_set(this->pinCsn);
-
-  xSemaphoreGive(mutex);
-
-  return true;
+bool SpiMaster::Read(uint8_t pinCsn, uint8_t* cmd, size_t cmdSize, uint8_t* data, size_t dataSize, Clients client) {
+  if (cmd == nullptr || cmdSize == 0)
+    return false;
+  Transfer transfer {
+    client, pinCsn, cmd, cmdSize, (uint32_t) data, (data != nullptr) ? dataSize : 0, true, false, nullptr, false, 0, 0, nullptr};
+  return Execute(transfer);
 }
 
 void SpiMaster::Sleep() {
@@ -262,35 +338,139 @@ void SpiMaster::Wakeup() {
   NRF_LOG_INFO("[SPIMASTER] Wakeup");
 }
 
-bool SpiMaster::WriteCmdAndBuffer(uint8_t pinCsn, const uint8_t* cmd, size_t cmdSize, const uint8_t* data, size_t dataSize) {
-  xSemaphoreTake(mutex, portMAX_DELAY);
+bool SpiMaster::WriteCmdAndBuffer(
+  uint8_t pinCsn, const uint8_t* cmd, size_t cmdSize, const uint8_t* data, size_t dataSize, Clients client) {
+  if (cmd == nullptr || cmdSize == 0)
+    return false;
+  Transfer transfer {
+    client, pinCsn, cmd, cmdSize, (uint32_t) data, (data != nullptr) ? dataSize : 0, false, false, nullptr, false, 0, 0, nullptr};
+  return Execute(transfer);
+}
 
-  taskToNotify = nullptr;
+// Takes the bus if it is free, else queues the transfer behind the waiting ones of the same or of a higher priority
+bool SpiMaster::Acquire(Transfer& transfer) {
+  transfer.task = xTaskGetCurrentTaskHandle();
+  transfer.completed = false;
+  transfer.requestCycles = DWT->CYCCNT;
+  transfer.requestRtcTicks = nrf_rtc_counter_get(portNRF_RTC_REG);
+  transfer.next = nullptr;
+
+  taskENTER_CRITICAL();
+  const bool granted = !busy;
+  if (granted) {
+    busy = true;
+    latencies[static_cast<uint8_t>(transfer.client)].buckets[0]++;
+  } else {
+    Transfer** position = &waiting;
+    while (*position != nullptr && (*position)->client <= transfer.client) {
+      position = &(*position)->next;
+    }
+    transfer.next = *position;
+    *position = &transfer;
+  }
+  taskEXIT_CRITICAL();
+  return granted;
+}
 
-  this->pinCsn = pinCsn;
+// Hands the bus to the first waiting transfer, or frees it. Called with the SPIM interrupt masked.
+SpiMaster::Transfer* SpiMaster::Next() {
+  Transfer* transfer = waiting;
+  if (transfer == nullptr) {
+    busy = false;
+    return nullptr;
+  }
+  waiting = transfer->next;
+  RecordLatency(*transfer);
+  return transfer;
+}
+
+void SpiMaster::RecordLatency(const Transfer& transfer) {
+  // Both counters give a lower bound of the wait: the cycles miss the time the CPU slept, the RTC ticks are only
+  // known to have lasted a full period once one more has started. The cycles are exact for the short waits, during
+  // which the CPU rarely sleeps, and the RTC within a tick (~1ms) for the long ones.
+  const uint32_t cyclesUs = (DWT->CYCCNT - transfer.requestCycles) / cyclesPerUs;
+  const uint32_t rtcTicks = (nrf_rtc_counter_get(portNRF_RTC_REG) - transfer.requestRtcTicks) & rtcMask;
+  const uint32_t rtcUs = (rtcTicks > 1) ? static_cast<uint32_t>((rtcTicks - 1) * 1000000ull / 1024) : 0;
+  const uint32_t latencyUs = std::max(cyclesUs, rtcUs);
+  uint8_t bucket = 0;
+  while (bucket < nbLatencyBuckets - 1 && latencyUs >= (8u << bucket)) {
+    bucket++;
+  }
+  latencies[static_cast<uint8_t>(transfer.client)].buckets[bucket]++;
+}
+
+SpiMaster::LatencyHistogram SpiMaster::GetLatencyHistogram(Clients client) const {
+  taskENTER_CRITICAL();
+  LatencyHistogram histogram = latencies[static_cast<uint8_t>(client)];
+  taskEXIT_CRITICAL();
+  return histogram;
+}
+
+// End of a transfer run by the calling task (single byte writes)
+void SpiMaster::Release() {
+  taskENTER_CRITICAL();
+  Transfer* next = Next();
+  taskEXIT_CRITICAL();
+  Dispatch(next, nullptr);
+}
+
+// Starts the transfer that has been granted the bus, or wakes up its task if it runs the transfer itself.
+// higherPriorityTaskWoken is null when called from a task.
+void SpiMaster::Dispatch(Transfer* transfer, BaseType_t* higherPriorityTaskWoken) {
+  if (transfer == nullptr) {
+    return;
+  }
+  if (!transfer->ownerOnly) {
+    Start(*transfer);
+    return;
+  }
+  transfer->completed = true;
+  if (higherPriorityTaskWoken != nullptr) {
+    vTaskNotifyGiveFromISR(transfer->task, higherPriorityTaskWoken);
+  } else {
+    xTaskNotifyGive(transfer->task);
+  }
+}
+
+// Sends the command, the data phase and the end of the transfer are handled by OnEndEvent()
+void SpiMaster::Start(Transfer& transfer) {
+  currentTransfer = &transfer;
+  taskToNotify = nullptr;
+  this->pinCsn = transfer.pinCsn;
   DisableWorkaroundForFtpan58(spiBaseAddress, 0, 0);
-  spiBaseAddress->INTENCLR = (1 << 6);
-  spiBaseAddress->INTENCLR = (1 << 1);
-  spiBaseAddress->INTENCLR = (1 << 19);
 
   nrf_gpio_pin_clear(this->pinCsn);
 
-  currentBufferAddr = 0;
-  currentBufferSize = 0;
-
-  PrepareTx((uint32_t) cmd, cmdSize);
-  spiBaseAddress->TASKS_START = 1;
-  while (spiBaseAddress->EVENTS_END == 0)
-    ;
+  dataPhaseAddr = transfer.dataAddress;
+  dataPhaseSize = transfer.dataSize;
+  dataPhaseReceive = transfer.receiveData;
+  receiving = false;
 
-  PrepareTx((uint32_t) data, dataSize);
+  auto currentSize = std::min((size_t) 255, transfer.commandSize);
+  PrepareTx((uint32_t) transfer.command, currentSize);
+  currentBufferAddr = (uint32_t) transfer.command + currentSize;
+  currentBufferSize = transfer.commandSize - currentSize;
   spiBaseAddress->TASKS_START = 1;
+}
 
-  while (spiBaseAddress->EVENTS_END == 0)
-    ;
-  nrf_gpio_pin_set(this->pinCsn);
-
-  xSemaphoreGive(mutex);
+// Blocks the calling task until the END interrupt completes the transfer (or grants the bus, for ownerOnly).
+// The notification count is shared with the end of the asynchronous writes of the task, that
+// LittleVgl::FlushDisplay() waits for: the notifications taken in excess are given back.
+void SpiMaster::WaitCompleted(Transfer& transfer) {
+  uint32_t taken = 0;
+  do {
+    ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+    taken++;
+  } while (!transfer.completed);
+  while (--taken > 0) {
+    xTaskNotifyGive(transfer.task);
+  }
+}
 
+bool SpiMaster::Execute(Transfer& transfer) {
+  if (Acquire(transfer)) {
+    Start(transfer);
+  }
+  WaitCompleted(transfer);
   return true;
 }
@@ -3,8 +3,8 @@
 #include <cstdint>
 
 #include <FreeRTOS.h>
-#include <semphr.h>
 #include <task.h>
+#include "drivers/SpimSegments.h"
 
 namespace Pinetime {
   namespace Drivers {
@@ -24,6 +24,19 @@ namespace Pinetime {
         uint8_t pinMISO;
       };
 
+      // Clients of the bus, by decreasing priority: when the bus is released, a waiting display transfer is started
+      // before the flash reads, which are started before the flash programs and erases.
+      enum class Clients : uint8_t { Display, FlashRead, FlashProgram };
+      static constexpr uint8_t nbClients = 3;
+
+      // Time waited for the bus by the transfers of a client, between the request and the start of the transfer.
+      // Bucket 0 counts the transfers that waited less than 8us, bucket i those that waited less than 8us << i, and
+      // the last bucket all the others. The waits longer than a few ms are measured with the RTC, to within ~1ms.
+      static constexpr uint8_t nbLatencyBuckets = 14;
+      struct LatencyHistogram {
+        uint32_t buckets[nbLatencyBuckets];
+      };
+
       SpiMaster(const SpiModule spi, const Parameters& params);
       SpiMaster(const SpiMaster&) = delete;
       SpiMaster& operator=(const SpiMaster&) = delete;
@@ -31,22 +44,62 @@ namespace Pinetime {
       SpiMaster& operator=(SpiMaster&&) = delete;
 
       bool Init();
-      bool Write(uint8_t pinCsn, const uint8_t* data, size_t size);
-      bool Read(uint8_t pinCsn, uint8_t* cmd, size_t cmdSize, uint8_t* data, size_t dataSize);
+      bool Write(uint8_t pinCsn, const uint8_t* data, size_t size, Clients client);
+      bool Read(uint8_t pinCsn, uint8_t* cmd, size_t cmdSize, uint8_t* data, size_t dataSize, Clients client);
 
-      bool WriteCmdAndBuffer(uint8_t pinCsn, const uint8_t* cmd, size_t cmdSize, const uint8_t* data, size_t dataSize);
+      bool WriteCmdAndBuffer(
+        uint8_t pinCsn, const uint8_t* cmd, size_t cmdSize, const uint8_t* data, size_t dataSize, Clients client);
+
+      LatencyHistogram GetLatencyHistogram(Clients client) const;
 
       void OnStartedEvent();
       void OnEndEvent();
+      void OnChainEndEvent();
 
       void Sleep();
       void Wakeup();
 
     private:
+      // Transfer waiting for the bus, queued by priority of its client, then in the order of the requests. Reads and
+      // command + buffer writes are started by the END interrupt of the previous transfer; the other writes only wait
+      // for the bus to be granted.
+      struct Transfer {
+        Clients client;
+        uint8_t pinCsn;
+        const uint8_t* command;
+        size_t commandSize;
+        uint32_t dataAddress;
+        size_t dataSize;
+        bool receiveData;
+        bool ownerOnly;
+        TaskHandle_t task;
+        volatile bool completed;
+        uint32_t requestCycles;
+        uint32_t requestRtcTicks;
+        Transfer* next;
+      };
+
+      bool Acquire(Transfer& transfer);
+      Transfer* Next();
+      void Release();
+      void Dispatch(Transfer* transfer, BaseType_t* higherPriorityTaskWoken);
+      void RecordLatency(const Transfer& transfer);
+      void Start(Transfer& transfer);
+      void WaitCompleted(Transfer& transfer);
+      bool Execute(Transfer& transfer);
+
       void SetupWorkaroundForFtpan58(NRF_SPIM_Type* spim, uint32_t ppi_channel, uint32_t gpiote_channel);
       void DisableWorkaroundForFtpan58(NRF_SPIM_Type* spim, uint32_t ppi_channel, uint32_t gpiote_channel);
       void PrepareTx(const volatile uint32_t bufferAddress, const volatile size_t size);
       void PrepareRx(const volatile uint32_t bufferAddress, const volatile size_t size);
+      void StartChain(const SpimSegments& segments);
+      void StopChain();
+
+      // Resources used to chain the segments of large writes (see SpimSegments)
+      static constexpr uint8_t ppiChannelChain = 1;
+      static constexpr uint8_t ppiChannelCount = 2;
+      static constexpr uint8_t ppiChannelUnchain = 3;
+      static constexpr uint8_t ppiGroupChain = 0;
 
       NRF_SPIM_Type* spiBaseAddress;
       uint8_t pinCsn;
@@ -56,8 +109,17 @@ namespace Pinetime {
 
       volatile uint32_t currentBufferAddr = 0;
       volatile size_t currentBufferSize = 0;
+      volatile bool receiving = false;
+      volatile uint32_t dataPhaseAddr = 0;
+      volatile size_t dataPhaseSize = 0;
+      volatile bool dataPhaseReceive = false;
       volatile TaskHandle_t taskToNotify;
-      SemaphoreHandle_t mutex = nullptr;
+      Transfer* volatile currentTransfer = nullptr;
+
+      // The bus is owned from Acquire() until the end of the transfer, then handed to the head of the queue
+      bool busy = false;
+      Transfer* waiting = nullptr;
+      LatencyHistogram latencies[nbClients] = {};
     };
   }
 }
@@ -3,6 +3,7 @@
 #include <libraries/delay/nrf_delay.h>
 #include <libraries/log/nrf_log.h>
 #include "drivers/Spi.h"
+#include <algorithm>
 
 using namespace Pinetime::Drivers;
 
@@ -21,6 +22,7 @@ void SpiNorFlash::Uninit() {
 }
 
 void SpiNorFlash::Sleep() {
+  WaitWriteCompleted();
   auto cmd = static_cast<uint8_t>(Commands::DeepPowerDown);
   spi.Write(&cmd, sizeof(uint8_t));
   NRF_LOG_INFO("[SpiNorFlash] Sleep")
@@ -71,17 +73,25 @@ uint8_t SpiNorFlash::ReadConfigurationRegister() {
 }
 
 void SpiNorFlash::Read(uint32_t address, uint8_t* buffer, size_t size) {
-  static constexpr uint8_t cmdSize = 4;
-  uint8_t cmd[cmdSize] = {static_cast<uint8_t>(Commands::Read),
-                          static_cast<uint8_t>(address >> 16U),
-                          static_cast<uint8_t>(address >> 8U),
-                          static_cast<uint8_t>(address)};
-  spi.Read(reinterpret_cast<uint8_t*>(&cmd), cmdSize, buffer, size);
+  WaitWriteCompleted();
+  // One transfer per page, so that a display transfer can take the bus between the pages of a long read
+  while (size > 0) {
+    const size_t length = std::min(size, static_cast<size_t>(pageSize - (address & (pageSize - 1u))));
+    static constexpr uint8_t cmdSize = 4;
+    uint8_t cmd[cmdSize] = {static_cast<uint8_t>(Commands::Read),
+                            static_cast<uint8_t>(address >> 16U),
+                            static_cast<uint8_t>(address >> 8U),
+                            static_cast<uint8_t>(address)};
+    spi.Read(reinterpret_cast<uint8_t*>(&cmd), cmdSize, buffer, length);
+    address += length;
+    buffer += length;
+    size -= length;
+  }
 }
 
 void SpiNorFlash::WriteEnable() {
   auto cmd = static_cast<uint8_t>(Commands::WriteEnable);
-  spi.Read(&cmd, sizeof(cmd), nullptr, 0);
+  spi.Read(&cmd, sizeof(cmd), nullptr, 0, SpiMaster::Clients::FlashProgram);
 }
 
 void SpiNorFlash::SectorErase(uint32_t sectorAddress) {
@@ -91,11 +101,12 @@ void SpiNorFlash::SectorErase(uint32_t sectorAddress) {
                           static_cast<uint8_t>(sectorAddress >> 8U),
                           static_cast<uint8_t>(sectorAddress)};
 
+  WaitWriteCompleted();
   WriteEnable();
   while (!WriteEnabled())
     vTaskDelay(1);
 
-  spi.Read(reinterpret_cast<uint8_t*>(&cmd), cmdSize, nullptr, 0);
+  spi.Read(reinterpret_cast<uint8_t*>(&cmd), cmdSize, nullptr, 0, SpiMaster::Clients::FlashProgram);
 
   while (WriteInProgress())
     vTaskDelay(1);
@@ -117,8 +128,6 @@ bool SpiNorFlash::EraseFailed() {
 }
 
 void SpiNorFlash::Write(uint32_t address, const uint8_t* buffer, size_t size) {
-  static constexpr uint8_t cmdSize = 4;
-
   size_t len = size;
   uint32_t addr = address;
   const uint8_t* b = buffer;
@@ -126,22 +135,36 @@ void SpiNorFlash::Write(uint32_t address, const uint8_t* buffer, size_t size) {
     uint32_t pageLimit = (addr & ~(pageSize - 1u)) + pageSize;
     uint32_t toWrite = pageLimit - addr > len ? len : pageLimit - addr;
 
-    uint8_t cmd[cmdSize] = {static_cast<uint8_t>(Commands::PageProgram),
-                            static_cast<uint8_t>(addr >> 16U),
-                            static_cast<uint8_t>(addr >> 8U),
-                            static_cast<uint8_t>(addr)};
-
-    WriteEnable();
-    while (!WriteEnabled())
-      vTaskDelay(1);
-
-    spi.WriteCmdAndBuffer(cmd, cmdSize, b, toWrite);
-
-    while (WriteInProgress())
-      vTaskDelay(1);
+    StartPageProgram(addr, b, toWrite);
+    WaitWriteCompleted();
 
     addr += toWrite;
     b += toWrite;
     len -= toWrite;
   }
 }
+
+void SpiNorFlash::StartPageProgram(uint32_t address, const uint8_t* buffer, size_t size) {
+  static constexpr uint8_t cmdSize = 4;
+  uint8_t cmd[cmdSize] = {static_cast<uint8_t>(Commands::PageProgram),
+                          static_cast<uint8_t>(address >> 16U),
+                          static_cast<uint8_t>(address >> 8U),
+                          static_cast<uint8_t>(address)};
+
+  WaitWriteCompleted();
+  WriteEnable();
+  while (!WriteEnabled())
+    vTaskDelay(1);
+
+  spi.WriteCmdAndBuffer(cmd, cmdSize, buffer, size, SpiMaster::Clients::FlashProgram);
+  pageProgramPending = true;
+}
+
+void SpiNorFlash::WaitWriteCompleted() {
+  if (!pageProgramPending) {
+    return;
+  }
+  while (WriteInProgress())
+    vTaskDelay(1);
+  pageProgramPending = false;
+}
@@ -27,6 +27,11 @@ namespace Pinetime {
       uint8_t ReadConfigurationRegister();
       void Read(uint32_t address, uint8_t* buffer, size_t size);
       void Write(uint32_t address, const uint8_t* buffer, size_t size);
+      // Sends the data of a page program (size bytes in a single page) and returns without waiting for the flash to
+      // program them: the page is programmed while the caller prepares the next one. The next operation on the flash
+      // waits for the program to be completed.
+      void StartPageProgram(uint32_t address, const uint8_t* buffer, size_t size);
+      void WaitWriteCompleted();
       void WriteEnable();
       void SectorErase(uint32_t sectorAddress);
       uint8_t ReadSecurityRegister();
@@ -56,6 +61,7 @@ namespace Pinetime {
 
       Spi& spi;
       Identification device_id;
+      bool pageProgramPending = false;
     };
   }
 }
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Drivers {
+    // Split of a SPIM transfer into EasyDMA segments.
+    //
+    // The MAXCNT registers of the nRF52832 SPIM are 8 bits wide: larger buffers are sent as segments of the same size
+    // in ArrayList mode (TXD.PTR is incremented by MAXCNT after each segment), chained by PPI (END -> START) and
+    // counted by a TIMER in counter mode, so that a single interrupt is raised at the end of the chain. The bytes that
+    // do not fit in the chain (remainderSize, smaller than a segment) are sent by a last, regular transfer.
+    struct SpimSegments {
+      static constexpr size_t maxSegmentSize = 255;
+
+      size_t segmentSize;
+      size_t chainedSegments;
+      size_t remainderSize;
+
+      // Segments of equal size when possible, using at most twice the minimum number of segments (a 240x4 pixels
+      // LVGL flush is 8 segments of 240 bytes), else as many segments of maxSegmentSize as possible.
+      static constexpr SpimSegments Plan(size_t size) {
+        if (size <= maxSegmentSize) {
+          return {size, 1, 0};
+        }
+        const size_t minCount = (size + maxSegmentSize - 1) / maxSegmentSize;
+        for (size_t count = minCount; count <= 2 * minCount; count++) {
+          if (size % count == 0) {
+            return {size / count, count, 0};
+          }
+        }
+        return {maxSegmentSize, size / maxSegmentSize, size % maxSegmentSize};
+      }
+
+      // The chain only needs the PPI/TIMER setup when it has more than one segment
+      constexpr bool IsChained() const {
+        return chainedSegments > 1;
+      }
+
+      // Number of END events after which the END -> START channel is disabled: the last segment has just been started
+      constexpr uint32_t UnchainCompare() const {
+        return chainedSegments - 1;
+      }
+
+      // Number of END events at the end of the chain, raising the completion interrupt
+      constexpr uint32_t EndCompare() const {
+        return chainedSegments;
+      }
+    };
+  }
+}
@@ -1,13 +1,11 @@
 #include "drivers/TwiMaster.h"
+#include <algorithm>
 #include <cstring>
 #include <hal/nrf_gpio.h>
 #include <nrfx_log.h>
 
 using namespace Pinetime::Drivers;
 
-// TODO use shortcut to automatically send STOP when receive LastTX, for example
-// TODO use DMA/IRQ
-
 TwiMaster::TwiMaster(NRF_TWIM_Type* module, uint32_t frequency, uint8_t pinSda, uint8_t pinScl)
   : module {module}, frequency {frequency}, pinSda {pinSda}, pinScl {pinScl} {
 }
@@ -23,10 +21,6 @@ void TwiMaster::ConfigurePins() const {
 }
 
 void TwiMaster::Init() {
-  if (mutex == nullptr) {
-    mutex = xSemaphoreCreateBinary();
-  }
-
   ConfigurePins();
 
   twiBaseAddress = module;
@@ -43,116 +37,209 @@ void TwiMaster::Init() {
   twiBaseAddress->EVENTS_SUSPENDED = 0;
   twiBaseAddress->EVENTS_TXSTARTED = 0;
 
+  twiBaseAddress->INTENSET = TWIM_INTENSET_STOPPED_Msk | TWIM_INTENSET_ERROR_Msk;
+
   twiBaseAddress->ENABLE = (TWIM_ENABLE_ENABLE_Enabled << TWIM_ENABLE_ENABLE_Pos);
 
-  xSemaphoreGive(mutex);
+  NRFX_IRQ_PRIORITY_SET(nrfx_get_irq_number(twiBaseAddress), 2);
+  NRFX_IRQ_ENABLE(nrfx_get_irq_number(twiBaseAddress));
 }
 
 TwiMaster::ErrorCodes TwiMaster::Read(uint8_t deviceAddress, uint8_t registerAddress, uint8_t* data, size_t size) {
-  xSemaphoreTake(mutex, portMAX_DELAY);
-  Wakeup();
-  auto ret = Write(deviceAddress, &registerAddress, 1, false);
-  ret = Read(deviceAddress, data, size, true);
-  Sleep();
-  xSemaphoreGive(mutex);
-  return ret;
+  const ReadRequest request {deviceAddress, registerAddress, data, size};
+  return Read(&request, 1);
+}
+
+TwiMaster::ErrorCodes TwiMaster::Read(const ReadRequest* requests, size_t count) {
+  if (count == 0) {
+    return ErrorCodes::NoError;
+  }
+  Transaction transaction;
+  transaction.reads = requests;
+  transaction.nbReads = count;
+  transaction.readIndex = 0;
+  return Execute(transaction);
 }
 
 TwiMaster::ErrorCodes TwiMaster::Write(uint8_t deviceAddress, uint8_t registerAddress, const uint8_t* data, size_t size) {
   ASSERT(size <= maxDataSize);
-  xSemaphoreTake(mutex, portMAX_DELAY);
-  Wakeup();
-  internalBuffer[0] = registerAddress;
-  std::memcpy(internalBuffer + 1, data, size);
-  auto ret = Write(deviceAddress, internalBuffer, size + 1, true);
-  Sleep();
-  xSemaphoreGive(mutex);
-  return ret;
+  Transaction transaction;
+  transaction.deviceAddress = deviceAddress;
+  transaction.txData[0] = registerAddress;
+  std::memcpy(transaction.txData + registerSize, data, size);
+  transaction.txSize = registerSize + size;
+  transaction.reads = nullptr;
+  transaction.nbReads = 0;
+  transaction.readIndex = 0;
+  return Execute(transaction);
 }
 
-TwiMaster::ErrorCodes TwiMaster::Read(uint8_t deviceAddress, uint8_t* buffer, size_t size, bool stop) {
-  twiBaseAddress->ADDRESS = deviceAddress;
-  twiBaseAddress->TASKS_RESUME = 0x1UL;
-  twiBaseAddress->RXD.PTR = (uint32_t) buffer;
-  twiBaseAddress->RXD.MAXCNT = size;
-
-  twiBaseAddress->TASKS_STARTRX = 1;
-
-  while (!twiBaseAddress->EVENTS_RXSTARTED && !twiBaseAddress->EVENTS_ERROR)
-    ;
-  twiBaseAddress->EVENTS_RXSTARTED = 0x0UL;
+// Blocks the calling task until the transaction has been run. A NACK from the device ends the transaction but, as
+// with the previous polled implementation, is not reported: only a frozen peripheral fails the transaction.
+TwiMaster::ErrorCodes TwiMaster::Execute(Transaction& transaction) {
+  if (Acquire(transaction)) {
+    Start(transaction);
+  }
+  WaitCompleted(transaction);
+  return transaction.failed ? ErrorCodes::TransactionFailed : ErrorCodes::NoError;
+}
 
-  txStartedCycleCount = DWT->CYCCNT;
-  uint32_t currentCycleCount;
-  while (!twiBaseAddress->EVENTS_LASTRX && !twiBaseAddress->EVENTS_ERROR) {
-    currentCycleCount = DWT->CYCCNT;
-    if ((currentCycleCount - txStartedCycleCount) > HwFreezedDelay) {
-      FixHwFreezed();
-      return ErrorCodes::TransactionFailed;
+bool TwiMaster::Acquire(Transaction& transaction) {
+  transaction.task = xTaskGetCurrentTaskHandle();
+  transaction.completed = false;
+  transaction.failed = false;
+  transaction.next = nullptr;
+
+  taskENTER_CRITICAL();
+  const bool granted = (currentTransaction == nullptr);
+  if (granted) {
+    currentTransaction = &transaction;
+    transaction.startTicks = xTaskGetTickCount();
+  } else {
+    Transaction** position = &waiting;
+    while (*position != nullptr) {
+      position = &(*position)->next;
     }
+    *position = &transaction;
   }
-  twiBaseAddress->EVENTS_LASTRX = 0x0UL;
+  taskEXIT_CRITICAL();
+  return granted;
+}
 
-  if (stop || twiBaseAddress->EVENTS_ERROR) {
-    twiBaseAddress->TASKS_STOP = 0x1UL;
-    while (!twiBaseAddress->EVENTS_STOPPED)
-      ;
-    twiBaseAddress->EVENTS_STOPPED = 0x0UL;
-  } else {
-    twiBaseAddress->TASKS_SUSPEND = 0x1UL;
-    while (!twiBaseAddress->EVENTS_SUSPENDED)
-      ;
-    twiBaseAddress->EVENTS_SUSPENDED = 0x0UL;
+// Hands the bus to the first waiting transaction, or frees it. Called with the TWIM interrupt masked.
+TwiMaster::Transaction* TwiMaster::Next() {
+  Transaction* transaction = waiting;
+  if (transaction != nullptr) {
+    waiting = transaction->next;
+    transaction->startTicks = xTaskGetTickCountFromISR();
   }
+  currentTransaction = transaction;
+  return transaction;
+}
 
-  if (twiBaseAddress->EVENTS_ERROR) {
-    twiBaseAddress->EVENTS_ERROR = 0x0UL;
+// Starts the write, or the current read of the batch
+void TwiMaster::Start(Transaction& transaction) {
+  Wakeup();
+  if (transaction.nbReads > 0) {
+    const ReadRequest& read = transaction.reads[transaction.readIndex];
+    // EasyDMA only reads from RAM: the register address is copied in the transaction
+    transaction.txData[0] = read.registerAddress;
+    twiBaseAddress->ADDRESS = read.deviceAddress;
+    twiBaseAddress->TXD.PTR = (uint32_t) transaction.txData;
+    twiBaseAddress->TXD.MAXCNT = registerSize;
+    twiBaseAddress->RXD.PTR = (uint32_t) read.buffer;
+    twiBaseAddress->RXD.MAXCNT = read.size;
+    twiBaseAddress->SHORTS = TWIM_SHORTS_LASTTX_STARTRX_Msk | TWIM_SHORTS_LASTRX_STOP_Msk;
+  } else {
+    twiBaseAddress->ADDRESS = transaction.deviceAddress;
+    twiBaseAddress->TXD.PTR = (uint32_t) transaction.txData;
+    twiBaseAddress->TXD.MAXCNT = transaction.txSize;
+    twiBaseAddress->SHORTS = TWIM_SHORTS_LASTTX_STOP_Msk;
   }
-  return ErrorCodes::NoError;
+  twiBaseAddress->TASKS_STARTTX = 1;
 }
 
-TwiMaster::ErrorCodes TwiMaster::Write(uint8_t deviceAddress, const uint8_t* data, size_t size, bool stop) {
-  twiBaseAddress->ADDRESS = deviceAddress;
-  twiBaseAddress->TASKS_RESUME = 0x1UL;
-  twiBaseAddress->TXD.PTR = (uint32_t) data;
-  twiBaseAddress->TXD.MAXCNT = size;
+// The bus has been stopped, at the end of a transfer or after an error
+void TwiMaster::OnStoppedEvent() {
+  Transaction* transaction = currentTransaction;
+  if (transaction == nullptr) {
+    return;
+  }
+  if (transaction->readIndex + 1 < transaction->nbReads) {
+    transaction->readIndex++;
+    transaction->startTicks = xTaskGetTickCountFromISR();
+    Start(*transaction);
+    return;
+  }
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  transaction->completed = true;
+  vTaskNotifyGiveFromISR(transaction->task, &xHigherPriorityTaskWoken);
+
+  UBaseType_t interruptStatus = taskENTER_CRITICAL_FROM_ISR();
+  Transaction* next = Next();
+  taskEXIT_CRITICAL_FROM_ISR(interruptStatus);
+  if (next != nullptr) {
+    Start(*next);
+  } else {
+    Sleep();
+  }
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
 
-  twiBaseAddress->TASKS_STARTTX = 1;
+// NACK or overrun: the shortcuts do not apply anymore, the bus must be stopped explicitly
+void TwiMaster::OnErrorEvent() {
+  uint32_t error = twiBaseAddress->ERRORSRC;
+  twiBaseAddress->ERRORSRC = error;
+  twiBaseAddress->TASKS_STOP = 1;
+}
 
-  while (!twiBaseAddress->EVENTS_TXSTARTED && !twiBaseAddress->EVENTS_ERROR)
-    ;
-  twiBaseAddress->EVENTS_TXSTARTED = 0x0UL;
-
-  txStartedCycleCount = DWT->CYCCNT;
-  uint32_t currentCycleCount;
-  while (!twiBaseAddress->EVENTS_LASTTX && !twiBaseAddress->EVENTS_ERROR) {
-    currentCycleCount = DWT->CYCCNT;
-    if ((currentCycleCount - txStartedCycleCount) > HwFreezedDelay) {
-      FixHwFreezed();
-      return ErrorCodes::TransactionFailed;
+// Blocks the calling task until the STOPPED interrupt completes the transaction. The task wakes up periodically to
+// check that the peripheral is not frozen, against the tick count, which keeps counting while the CPU sleeps. The
+// notification count is shared with the other drivers used by the task (SpiMaster): the notifications taken in excess
+// are given back.
+void TwiMaster::WaitCompleted(Transaction& transaction) {
+  uint32_t taken = 0;
+  bool recovered = false;
+  while (!transaction.completed) {
+    if (ulTaskNotifyTake(pdFALSE, hwFreezedCheckPeriod) > 0) {
+      taken++;
+    } else {
+      recovered = RecoverIfFrozen(transaction);
+    }
+  }
+  if (!recovered) {
+    if (taken > 0) {
+      // Given by OnStoppedEvent()
+      taken--;
+    } else {
+      // The transaction completed right after the last wait timed out: the notification of OnStoppedEvent() is
+      // already pending, it must not end the next wait of the task
+      ulTaskNotifyTake(pdFALSE, 0);
     }
   }
-  twiBaseAddress->EVENTS_LASTTX = 0x0UL;
+  while (taken-- > 0) {
+    xTaskNotifyGive(transaction.task);
+  }
+}
 
-  if (stop || twiBaseAddress->EVENTS_ERROR) {
-    twiBaseAddress->TASKS_STOP = 0x1UL;
-    while (!twiBaseAddress->EVENTS_STOPPED)
-      ;
-    twiBaseAddress->EVENTS_STOPPED = 0x0UL;
-  } else {
-    twiBaseAddress->TASKS_SUSPEND = 0x1UL;
-    while (!twiBaseAddress->EVENTS_SUSPENDED)
-      ;
-    twiBaseAddress->EVENTS_SUSPENDED = 0x0UL;
+// Returns true if the transaction was running for too long on a frozen peripheral, and has been ended by a reset of
+// the peripheral
+bool TwiMaster::RecoverIfFrozen(Transaction& transaction) {
+  Transaction* next = nullptr;
+  bool frozen = false;
+
+  taskENTER_CRITICAL();
+  if (currentTransaction == &transaction && !transaction.completed &&
+      xTaskGetTickCount() - transaction.startTicks > FreezeTimeout(transaction)) {
+    frozen = true;
+    FixHwFreezed();
+    transaction.failed = true;
+    transaction.completed = true;
+    next = Next();
   }
+  taskEXIT_CRITICAL();
 
-  if (twiBaseAddress->EVENTS_ERROR) {
-    twiBaseAddress->EVENTS_ERROR = 0x0UL;
-    uint32_t error = twiBaseAddress->ERRORSRC;
-    twiBaseAddress->ERRORSRC = error;
+  if (next != nullptr) {
+    Start(*next);
   }
+  return frozen;
+}
 
-  return ErrorCodes::NoError;
+// Ticks after which the current transfer of the transaction is considered frozen: hwFreezedTimeout per sequence, plus
+// twice the time the bytes of the transfer take on the bus
+TickType_t TwiMaster::FreezeTimeout(const Transaction& transaction) const {
+  // Address and register bytes, then the data of the current read (after a repeated start), or the register and the
+  // data of the write
+  uint32_t sequences = 1;
+  uint32_t bytes = 1 + transaction.txSize;
+  if (transaction.nbReads > 0) {
+    sequences = 2;
+    bytes = 2 + registerSize + transaction.reads[transaction.readIndex].size;
+  }
+  // FREQUENCY is the bit rate in units of 16MHz / 2^32, and each byte takes 9 clock cycles (data and acknowledgment)
+  const uint32_t bitRate = std::max<uint32_t>(1, static_cast<uint64_t>(frequency) * 16000000 >> 32);
+  const uint32_t busTicks = (bytes * 9 * configTICK_RATE_HZ + bitRate - 1) / bitRate;
+  return sequences * hwFreezedTimeout + 2 * busTicks;
 }
 
 void TwiMaster::Sleep() {
@@ -164,16 +251,22 @@ void TwiMaster::Wakeup() {
 }
 
 /* Sometimes, the TWIM device just freeze and never set the event EVENTS_LASTTX.
- * This method disable and re-enable the peripheral so that it works again.
+ * This method disables the peripheral and clears its events, so that it works again when the next transaction
+ * enables it.
  * This is just a workaround, and it would be better if we could find a way to prevent
  * this issue from happening.
  * */
 void TwiMaster::FixHwFreezed() {
   NRF_LOG_INFO("I2C device frozen, reinitializing it!");
 
-  uint32_t twi_state = NRF_TWI1->ENABLE;
-
   Sleep();
 
-  twiBaseAddress->ENABLE = twi_state;
+  twiBaseAddress->SHORTS = 0;
+  twiBaseAddress->EVENTS_STOPPED = 0;
+  twiBaseAddress->EVENTS_ERROR = 0;
+  twiBaseAddress->EVENTS_LASTTX = 0;
+  twiBaseAddress->EVENTS_LASTRX = 0;
+  twiBaseAddress->EVENTS_TXSTARTED = 0;
+  twiBaseAddress->EVENTS_RXSTARTED = 0;
+  twiBaseAddress->EVENTS_SUSPENDED = 0;
 }
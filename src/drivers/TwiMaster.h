@@ -1,6 +1,6 @@
 #pragma once
 #include <FreeRTOS.h>
-#include <semphr.h>
+#include <task.h>
 #include <drivers/include/nrfx_twi.h> // NRF_TWIM_Type
 #include <cstdint>
 
@@ -10,32 +10,74 @@ namespace Pinetime {
     public:
       enum class ErrorCodes { NoError, TransactionFailed };
 
+      // Register read of a batch
+      struct ReadRequest {
+        uint8_t deviceAddress;
+        uint8_t registerAddress;
+        uint8_t* buffer;
+        size_t size;
+      };
+
       TwiMaster(NRF_TWIM_Type* module, uint32_t frequency, uint8_t pinSda, uint8_t pinScl);
 
       void Init();
       ErrorCodes Read(uint8_t deviceAddress, uint8_t registerAddress, uint8_t* buffer, size_t size);
+      // Runs the reads one after the other, without waking the calling task up until the end of the last one
+      ErrorCodes Read(const ReadRequest* requests, size_t count);
       ErrorCodes Write(uint8_t deviceAddress, uint8_t registerAddress, const uint8_t* data, size_t size);
 
+      void OnStoppedEvent();
+      void OnErrorEvent();
+
       void Sleep();
       void Wakeup();
 
     private:
-      ErrorCodes Read(uint8_t deviceAddress, uint8_t* buffer, size_t size, bool stop);
-      ErrorCodes Write(uint8_t deviceAddress, const uint8_t* data, size_t size, bool stop);
+      static constexpr uint8_t maxDataSize {16};
+      static constexpr uint8_t registerSize {1};
+
+      // Transaction waiting for the bus, queued in the order of the requests: a write, or a batch of reads. The
+      // register address (and the data of a write) is sent, then the data of a read is received after a repeated
+      // start, and the bus is stopped: each sequence runs with EasyDMA and the LASTTX/LASTRX shortcuts, the STOPPED
+      // interrupt starts the next read of the batch or ends the transaction.
+      struct Transaction {
+        uint8_t deviceAddress;
+        uint8_t txData[registerSize + maxDataSize];
+        size_t txSize;
+        const ReadRequest* reads;
+        size_t nbReads;
+        size_t readIndex;
+        TaskHandle_t task;
+        TickType_t startTicks;
+        volatile bool completed;
+        bool failed;
+        Transaction* next;
+      };
+
+      ErrorCodes Execute(Transaction& transaction);
+      bool Acquire(Transaction& transaction);
+      Transaction* Next();
+      void Start(Transaction& transaction);
+      void WaitCompleted(Transaction& transaction);
+      bool RecoverIfFrozen(Transaction& transaction);
+      TickType_t FreezeTimeout(const Transaction& transaction) const;
       void FixHwFreezed();
       void ConfigurePins() const;
 
       NRF_TWIM_Type* twiBaseAddress;
-      SemaphoreHandle_t mutex = nullptr;
       NRF_TWIM_Type* module;
       uint32_t frequency;
       uint8_t pinSda;
       uint8_t pinScl;
-      static constexpr uint8_t maxDataSize {16};
-      static constexpr uint8_t registerSize {1};
-      uint8_t internalBuffer[maxDataSize + registerSize];
-      uint32_t txStartedCycleCount = 0;
-      static constexpr uint32_t HwFreezedDelay {161000};
+
+      // The transaction on the bus, then the transactions waiting for it
+      Transaction* volatile currentTransaction = nullptr;
+      Transaction* waiting = nullptr;
+
+      // Margin given to each sequence of a transfer before the peripheral is considered frozen (~3ms, see
+      // FreezeTimeout()), and the period at which the waiting task checks it
+      static constexpr TickType_t hwFreezedTimeout {3};
+      static constexpr TickType_t hwFreezedCheckPeriod {3};
     };
   }
 }
@@ -70,7 +70,12 @@ void HeartRateTask::Work() {
     }
 
     if (measurementStarted) {
-      int8_t ambient = ppg.Preprocess(heartRateSensor.ReadHrs(), heartRateSensor.ReadAls());
+      Drivers::Hrs3300::Sample sample;
+      if (!heartRateSensor.ReadSample(sample)) {
+        // A failed read is not a sample of the sensor, the PPG only processes actual measurements
+        continue;
+      }
+      int8_t ambient = ppg.Preprocess(sample.hrs, sample.als);
       int bpm = ppg.HeartRate();
 
       // If ambient light detected or a reset requested (bpm < 0)
@@ -1,4 +1,6 @@
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <FreeRTOS.h>
 
 // Override malloc() and free() to use the memory manager from FreeRTOS.
@@ -6,22 +8,54 @@
 // calloc and realloc.
 // See https://www.gnu.org/software/libc/manual/html_node/Replacing-malloc.html
 
+#ifdef HEAP_TRACKING
+  #include "FreeRTOS/heap_tracking.h"
+
+// The allocations are charged to the caller of malloc(), calloc() and realloc()
+void* malloc(size_t size) {
+  return pvPortMallocFrom(size, __builtin_return_address(0));
+}
+#else
 void* malloc(size_t size) {
   return pvPortMalloc(size);
 }
+#endif
 
 void free(void* ptr) {
   vPortFree(ptr);
 }
 
+#ifdef HEAP_TRACKING
 void* calloc(size_t num, size_t size) {
-  (void)(num);
-  (void)(size);
-  // Not supported
-  return NULL;
+  if (size != 0 && num > SIZE_MAX / size) {
+    return NULL;
+  }
+  void* ptr = pvPortMallocFrom(num * size, __builtin_return_address(0));
+  if (ptr != NULL) {
+    memset(ptr, 0, num * size);
+  }
+  return ptr;
 }
+#else
+void* calloc(size_t num, size_t size) {
+  if (size != 0 && num > SIZE_MAX / size) {
+    return NULL;
+  }
+  void* ptr = pvPortMalloc(num * size);
+  if (ptr != NULL) {
+    memset(ptr, 0, num * size);
+  }
+  return ptr;
+}
+#endif
 
+#ifdef HEAP_TRACKING
+void* realloc(void* ptr, size_t newSize) {
+  return pvPortReallocFrom(ptr, newSize, __builtin_return_address(0));
+}
+#else
 void *pvPortRealloc(void *ptr, size_t xWantedSize);
 void* realloc( void *ptr, size_t newSize) {
   return pvPortRealloc(ptr, newSize);
 }
+#endif
@@ -22,6 +22,7 @@ namespace Pinetime {
       OnNewDay,
       OnNewHour,
       OnNewHalfHour,
+      TimeEventTimerExpired,
       OnChargingEvent,
       OnPairing,
       SetOffAlarm,
@@ -29,7 +30,8 @@ namespace Pinetime {
       BatteryPercentageUpdated,
       StartFileTransfer,
       StopFileTransfer,
-      BleRadioEnableToggle
+      BleRadioEnableToggle,
+      BleDiscoveryTimerExpired
     };
   }
 }
@@ -1,4 +1,4 @@
-#include "systemtask/SystemTask.h"
+#include "systemtask/SystemMonitor.h"
 #if configUSE_TRACE_FACILITY == 1
   // FreeRtosMonitor
   #include <FreeRTOS.h>
@@ -7,7 +7,7 @@
 
 void Pinetime::System::SystemMonitor::Process() {
   if (xTaskGetTickCount() - lastTick > 10000) {
-    NRF_LOG_INFO("---------------------------------------\nFree heap : %d", xPortGetFreeHeapSize());
+    NRF_LOG_INFO("---------------------------------------\nFree heap : %d", static_cast<int>(xPortGetFreeHeapSize()));
     TaskStatus_t tasksStatus[10];
     auto nb = uxTaskGetSystemState(tasksStatus, 10, nullptr);
     for (uint32_t i = 0; i < nb; i++) {
@@ -17,6 +17,9 @@ void Pinetime::System::SystemMonitor::Process() {
                      tasksStatus[i].pcTaskName,
                      tasksStatus[i].usStackHighWaterMark * 4);
     }
+  #ifdef HEAP_TRACKING
+    LogHeapReport();
+  #endif
     lastTick = xTaskGetTickCount();
   }
 }
@@ -25,3 +28,48 @@ void Pinetime::System::SystemMonitor::Process() {
 void Pinetime::System::SystemMonitor::Process() {
 }
 #endif
+
+#ifdef HEAP_TRACKING
+  #include <algorithm>
+  #include <nrf_log.h>
+  #include "FreeRTOS/heap_tracking.h"
+
+void Pinetime::System::SystemMonitor::LogHeapReport() {
+  HeapReport_t report;
+  vPortGetHeapReport(&report);
+  NRF_LOG_INFO("Heap : live %u B (peak %u B), %u allocations, %u frees, %u failed",
+               static_cast<unsigned>(report.xLiveBytes),
+               static_cast<unsigned>(report.xPeakBytes),
+               static_cast<unsigned>(report.ulAllocations),
+               static_cast<unsigned>(report.ulFrees),
+               static_cast<unsigned>(report.ulFailedAllocations));
+  NRF_LOG_INFO("Heap : free %u B (min %u B) in %u blocks, largest %u B",
+               static_cast<unsigned>(report.xFreeBytes),
+               static_cast<unsigned>(report.xMinimumEverFreeBytes),
+               static_cast<unsigned>(report.xNumberOfFreeBlocks),
+               static_cast<unsigned>(report.xLargestFreeBlock));
+  for (unsigned bucket = 0; bucket < heapTRACKING_HISTOGRAM_BUCKETS; bucket++) {
+    if (report.usFreeBlockHistogram[bucket] != 0) {
+      NRF_LOG_INFO("Free blocks >= %u B : %u",
+                   (bucket == 0) ? 0u : (16u << bucket),
+                   static_cast<unsigned>(report.usFreeBlockHistogram[bucket]));
+    }
+  }
+
+  // Static: the table does not fit in the stack of SystemTask
+  static HeapCallSite_t callSites[heapTRACKING_MAX_CALL_SITES];
+  auto nb = xPortGetHeapCallSites(callSites, heapTRACKING_MAX_CALL_SITES);
+  std::sort(callSites, callSites + nb, [](const HeapCallSite_t& a, const HeapCallSite_t& b) {
+    return a.xLiveBytes > b.xLiveBytes;
+  });
+  for (size_t i = 0; i < nb; i++) {
+    // The call site 0x00000000 collects the allocations of the call sites that did not fit in the table
+    NRF_LOG_INFO("Call site 0x%08x : live %u B (peak %u B), %u allocations, %u frees",
+                 static_cast<unsigned>(reinterpret_cast<uintptr_t>(callSites[i].pvCallSite)),
+                 static_cast<unsigned>(callSites[i].xLiveBytes),
+                 static_cast<unsigned>(callSites[i].xPeakBytes),
+                 static_cast<unsigned>(callSites[i].ulAllocations),
+                 static_cast<unsigned>(callSites[i].ulFrees));
+  }
+}
+#endif
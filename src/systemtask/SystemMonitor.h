@@ -7,6 +7,10 @@ namespace Pinetime {
     class SystemMonitor {
     public:
       void Process();
+#ifdef HEAP_TRACKING
+      // Logs the counters of the heap, the histogram of its free blocks and the bytes allocated by each call site
+      static void LogHeapReport();
+#endif
 #if configUSE_TRACE_FACILITY == 1
     private:
       mutable TickType_t lastTick = 0;
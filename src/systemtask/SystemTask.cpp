@@ -17,6 +17,7 @@
 #include "main.h"
 #include "BootErrors.h"
 
+#include <algorithm>
 #include <memory>
 
 using namespace Pinetime::System;
@@ -32,6 +33,11 @@ void MeasureBatteryTimerCallback(TimerHandle_t xTimer) {
   sysTask->PushMessage(Pinetime::System::Messages::MeasureBatteryTimerExpired);
 }
 
+void BleDiscoveryTimerCallback(TimerHandle_t xTimer) {
+  auto* sysTask = static_cast<SystemTask*>(pvTimerGetTimerID(xTimer));
+  sysTask->PushMessage(Pinetime::System::Messages::BleDiscoveryTimerExpired);
+}
+
 SystemTask::SystemTask(Drivers::SpiMaster& spi,
                        Pinetime::Drivers::SpiNorFlash& spiNorFlash,
                        Drivers::TwiMaster& twiMaster,
@@ -51,7 +57,8 @@ SystemTask::SystemTask(Drivers::SpiMaster& spi,
                        Pinetime::Applications::HeartRateTask& heartRateApp,
                        Pinetime::Controllers::FS& fs,
                        Pinetime::Controllers::TouchHandler& touchHandler,
-                       Pinetime::Controllers::ButtonHandler& buttonHandler)
+                       Pinetime::Controllers::ButtonHandler& buttonHandler,
+                       Pinetime::Controllers::FrameProfiler& frameProfiler)
   : spi {spi},
     spiNorFlash {spiNorFlash},
     twiMaster {twiMaster},
@@ -80,7 +87,9 @@ SystemTask::SystemTask(Drivers::SpiMaster& spi,
                      spiNorFlash,
                      heartRateController,
                      motionController,
-                     fs) {
+                     fs,
+                     frameProfiler,
+                     spi) {
 }
 
 void SystemTask::Start() {
@@ -175,13 +184,17 @@ void SystemTask::Work() {
   measureBatteryTimer = xTimerCreate("measureBattery", batteryMeasurementPeriod, pdTRUE, this, MeasureBatteryTimerCallback);
   xTimerStart(measureBatteryTimer, portMAX_DELAY);
 
+  // Services discovery is deferred after the connection to avoid the conflicts between the host communicating with the
+  // target and vice-versa. I'm not sure if this is the right way to handle this...
+  bleDiscoveryTimer = xTimerCreate("bleDiscovery", bleDiscoveryDelay, pdFALSE, this, BleDiscoveryTimerCallback);
+
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "EndlessLoop"
   while (true) {
-    UpdateMotion();
-
+    // Block until a message is received or until the next periodic job is due. With tickless idle, the MCU stays
+    // in System ON sleep until then (the RTC compare event that ends the idle period is the wake up source).
     Messages msg;
-    if (xQueueReceive(systemTasksMsgQueue, &msg, 100) == pdTRUE) {
+    if (xQueueReceive(systemTasksMsgQueue, &msg, TicksToNextJob()) == pdTRUE) {
       switch (msg) {
         case Messages::EnableSleeping:
           // Make sure that exiting an app doesn't enable sleeping,
@@ -261,8 +274,10 @@ void SystemTask::Work() {
           break;
         case Messages::BleConnected:
           displayApp.PushMessage(Pinetime::Applications::Display::Messages::RestoreBrightness);
-          isBleDiscoveryTimerRunning = true;
-          bleDiscoveryTimer = 5;
+          xTimerStart(bleDiscoveryTimer, 0);
+          break;
+        case Messages::BleDiscoveryTimerExpired:
+          nimbleController.StartDiscovery();
           break;
         case Messages::BleFirmwareUpdateStarted:
           doNotGoToSleep = true;
@@ -301,6 +316,8 @@ void SystemTask::Work() {
             action = buttonHandler.HandleEvent(Controllers::ButtonHandler::Events::Release);
           } else {
             action = buttonHandler.HandleEvent(Controllers::ButtonHandler::Events::Press);
+            // The watchdog is not reloaded while the button is held: start counting its timeout from the press
+            watchdog.Reload();
             // This is for faster wakeup, sacrificing special longpress and doubleclick handling while sleeping
             if (IsSleeping()) {
               fastWakeUpDone = true;
@@ -356,6 +373,9 @@ void SystemTask::Work() {
             }
           }
           break;
+        case Messages::TimeEventTimerExpired:
+          // The time events are emitted by DateTime::UpdateTime() in RunPeriodicJobs()
+          break;
         case Messages::OnChargingEvent:
           batteryController.ReadPowerState();
           displayApp.PushMessage(Applications::Display::Messages::OnChargingEvent);
@@ -387,55 +407,93 @@ void SystemTask::Work() {
       }
     }
 
-    if (isBleDiscoveryTimerRunning) {
-      if (bleDiscoveryTimer == 0) {
-        isBleDiscoveryTimerRunning = false;
-        // Services discovery is deferred from 3 seconds to avoid the conflicts between the host communicating with the
-        // target and vice-versa. I'm not sure if this is the right way to handle this...
-        nimbleController.StartDiscovery();
-      } else {
-        bleDiscoveryTimer--;
-      }
-    }
-
-    monitor.Process();
-    uint32_t systick_counter = nrf_rtc_counter_get(portNRF_RTC_REG);
-    dateTimeController.UpdateTime(systick_counter);
-    NoInit_BackUpTime = dateTimeController.CurrentDateTime();
-    if (nrf_gpio_pin_read(PinMap::Button) == 0) {
-      watchdog.Reload();
-    }
+    RunPeriodicJobs();
   }
 #pragma clang diagnostic pop
 }
 
-void SystemTask::UpdateMotion() {
-  if (state == SystemTaskState::GoingToSleep || state == SystemTaskState::WakingUp) {
-    return;
+void SystemTask::RunPeriodicJobs() {
+  TickType_t now = xTaskGetTickCount();
+  if (IsMotionPollingNeeded() && now - lastMotionUpdate >= motionPollingPeriod) {
+    lastMotionUpdate = now;
+    UpdateMotion();
   }
 
-  if (state == SystemTaskState::Sleeping && !(settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::RaiseWrist) ||
-                                              settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::Shake))) {
-    return;
+  monitor.Process();
+  uint32_t systick_counter = nrf_rtc_counter_get(portNRF_RTC_REG);
+  dateTimeController.UpdateTime(systick_counter);
+  NoInit_BackUpTime = dateTimeController.CurrentDateTime();
+  if (nrf_gpio_pin_read(PinMap::Button) == 0) {
+    watchdog.Reload();
   }
+}
+
+TickType_t SystemTask::TicksToNextJob() const {
+  static_assert(configTICK_RATE_HZ == 1024, "The RTC ticks and the FreeRTOS ticks must be the same");
+
+  // The watchdog must be reloaded before it expires
+  TickType_t timeout = watchdogReloadPeriod;
 
+  if (IsMotionPollingNeeded()) {
+    TickType_t elapsed = xTaskGetTickCount() - lastMotionUpdate;
+    timeout = std::min(timeout, (elapsed < motionPollingPeriod) ? motionPollingPeriod - elapsed : 0);
+  }
+
+  // The time is refreshed every second while the display is on. While sleeping, the chimes and the new day events
+  // are emitted when the timer of the time events expires (TimeEventTimerExpired).
+  if (state == SystemTaskState::Running) {
+    timeout = std::min(timeout, dateTimeController.TicksToNextSecond(nrf_rtc_counter_get(portNRF_RTC_REG)));
+  }
+
+  return timeout;
+}
+
+bool SystemTask::IsMotionPollingNeeded() const {
+  if (state == SystemTaskState::GoingToSleep || state == SystemTaskState::WakingUp) {
+    return false;
+  }
+
+  // While sleeping, the motion sensor is only polled if it can wake the watch up
+  return state == SystemTaskState::Running ||
+         settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::RaiseWrist) ||
+         settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::Shake);
+}
+
+void SystemTask::UpdateMotion() {
   if (stepCounterMustBeReset) {
     motionSensor.ResetStepCounter();
     stepCounterMustBeReset = false;
   }
 
-  auto motionValues = motionSensor.Process();
-
-  motionController.Update(motionValues.x, motionValues.y, motionValues.z, motionValues.steps);
+  Drivers::Bma421::FifoValues motionValues;
+  if (!motionSensor.ProcessFifo(motionValues)) {
+    // Keep the step count of the last successful read rather than reporting 0 steps
+    return;
+  }
 
-  if (settingsController.GetNotificationStatus() != Controllers::Settings::Notification::Sleep) {
-    if ((settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::RaiseWrist) &&
-         motionController.ShouldRaiseWake(state == SystemTaskState::Sleeping)) ||
-        (settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::Shake) &&
-         motionController.ShouldShakeWake(settingsController.GetShakeThreshold()))) {
-      GoToRunning();
+  // The samples were buffered by the sensor at a steady rate, the last one is the most recent
+  constexpr TickType_t samplePeriod = pdMS_TO_TICKS(Drivers::Bma421::fifoSamplePeriodMs);
+  TickType_t timestamp = xTaskGetTickCount() - motionValues.nbSamples * samplePeriod;
+  bool shouldWakeUp = false;
+  for (size_t i = 0; i < motionValues.nbSamples; i++) {
+    const auto& sample = motionValues.samples[i];
+    timestamp += samplePeriod;
+    motionController.AddSample(sample.x, sample.y, sample.z, timestamp);
+
+    if (settingsController.GetNotificationStatus() != Controllers::Settings::Notification::Sleep) {
+      if ((settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::RaiseWrist) &&
+           motionController.ShouldRaiseWake(state == SystemTaskState::Sleeping)) ||
+          (settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::Shake) &&
+           motionController.ShouldShakeWake(settingsController.GetShakeThreshold()))) {
+        shouldWakeUp = true;
+      }
     }
   }
+  motionController.Update(motionValues.steps);
+
+  if (shouldWakeUp) {
+    GoToRunning();
+  }
 }
 
 void SystemTask::HandleButtonAction(Controllers::ButtonActions action) {
@@ -47,6 +47,7 @@ namespace Pinetime {
     class Battery;
     class TouchHandler;
     class ButtonHandler;
+    class FrameProfiler;
   }
 
   namespace System {
@@ -72,7 +73,8 @@ namespace Pinetime {
                  Pinetime::Applications::HeartRateTask& heartRateApp,
                  Pinetime::Controllers::FS& fs,
                  Pinetime::Controllers::TouchHandler& touchHandler,
-                 Pinetime::Controllers::ButtonHandler& buttonHandler);
+                 Pinetime::Controllers::ButtonHandler& buttonHandler,
+                 Pinetime::Controllers::FrameProfiler& frameProfiler);
 
       void Start();
       void PushMessage(Messages msg);
@@ -124,8 +126,7 @@ namespace Pinetime {
 
       static void Process(void* instance);
       void Work();
-      bool isBleDiscoveryTimerRunning = false;
-      uint8_t bleDiscoveryTimer = 0;
+      TimerHandle_t bleDiscoveryTimer;
       TimerHandle_t measureBatteryTimer;
       bool doNotGoToSleep = false;
       SystemTaskState state = SystemTaskState::Running;
@@ -135,8 +136,17 @@ namespace Pinetime {
 
       void GoToRunning();
       void UpdateMotion();
+      bool IsMotionPollingNeeded() const;
+      TickType_t TicksToNextJob() const;
+      void RunPeriodicJobs();
       bool stepCounterMustBeReset = false;
+      TickType_t lastMotionUpdate = 0;
       static constexpr TickType_t batteryMeasurementPeriod = pdMS_TO_TICKS(10 * 60 * 1000);
+      // The motion sensor buffers its samples in its FIFO, they are drained in a single read once per second
+      static constexpr TickType_t motionPollingPeriod = pdMS_TO_TICKS(1000);
+      // The watchdog is configured with a 7s timeout
+      static constexpr TickType_t watchdogReloadPeriod = pdMS_TO_TICKS(5 * 1000);
+      static constexpr TickType_t bleDiscoveryDelay = pdMS_TO_TICKS(500);
 
       SystemMonitor monitor;
     };